@@ -47,6 +47,7 @@ Graph *CompressGraph(Graph *graph, InstanceList *instanceList,
    ULONG startVertex = 0;
    ULONG startEdge = 0;
    Increment *increment = NULL;
+   GraphMarks *marks;
 
    // parameters used
    LabelList *labelList = parameters->labelList;
@@ -65,6 +66,7 @@ Graph *CompressGraph(Graph *graph, InstanceList *instanceList,
    }
 
    // mark and count unique vertices and edges in graph from instances
+   marks = GetGraphMarks(graph, parameters);
    numInstanceVertices = 0;
    numInstanceEdges = 0;
    instanceNo = 1;
@@ -76,23 +78,23 @@ Graph *CompressGraph(Graph *graph, InstanceList *instanceList,
       instance = instanceListNode->instance;
       for (v = 0; v < instance->numVertices; v++)      // add in unique vertices
       {
-         if ((!graph->vertices[instance->vertices[v]].used) &&
+         if ((! VERTEX_MARKED(marks, instance->vertices[v])) &&
              ((!parameters->incremental) ||
               (instance->vertices[v] >= startVertex)))
          {
             numInstanceVertices++;
-            graph->vertices[instance->vertices[v]].used = TRUE;
+            MARK_VERTEX(marks, instance->vertices[v], TRUE);
             // assign vertex to first instance it occurs in
-            graph->vertices[instance->vertices[v]].map = instanceNo - 1;
+            marks->vertexMap[instance->vertices[v]] = instanceNo - 1;
          }
       }
       for (e = 0; e < instance->numEdges; e++) // add in unique edges
-         if ((!graph->edges[instance->edges[e]].used) &&
+         if ((! EDGE_MARKED(marks, instance->edges[e])) &&
              ((!parameters->incremental) ||
               (instance->edges[e] >= startEdge)))
          {
             numInstanceEdges++;
-            graph->edges[instance->edges[e]].used = TRUE;
+            MARK_EDGE(marks, instance->edges[e], TRUE);
          }
       instanceNo++;
       instanceListNode = instanceListNode->next;
@@ -125,21 +127,22 @@ Graph *CompressGraph(Graph *graph, InstanceList *instanceList,
    }
 
    // insert vertices and edges from non-compressed part of graph
-   CopyUnmarkedGraph(graph, compressedGraph, vertexIndex, parameters);
+   CopyUnmarkedGraph(graph, marks, compressedGraph, vertexIndex, parameters);
 
    // add edges describing overlap, if appropriate (note: this will
    // unmark instance vertices)
    if (allowInstanceOverlap)
-      AddOverlapEdges(compressedGraph, graph, instanceList, overlapLabelIndex,
-                      startVertex, startEdge);
+      AddOverlapEdges(compressedGraph, graph, marks, instanceList,
+                      overlapLabelIndex, startVertex, startEdge);
 
-   // reset used flag of instances' vertices and edges
+   // unmark instances' vertices and edges (not simply reset, since
+   // marks made by the caller, e.g., RecursifySub, must be kept)
    instanceListNode = instanceList->head;
    while (instanceListNode != NULL) 
    {
       instance = instanceListNode->instance;
-      MarkInstanceVertices(instance, graph, FALSE);
-      MarkInstanceEdges(instance, graph, FALSE);
+      MarkInstanceVertices(instance, marks, FALSE);
+      MarkInstanceEdges(instance, marks, FALSE);
       instanceListNode = instanceListNode->next;
    }
 
@@ -152,6 +155,7 @@ Graph *CompressGraph(Graph *graph, InstanceList *instanceList,
 //
 // INPUTS: (Graph *compressedGraph) - compressed graph to add edges to
 //         (Graph *graph) - graph being compressed
+//         (GraphMarks *marks) - marks on graph being compressed
 //         (InstanceList *instanceList) - substructure instances used to
 //                                        compress graph
 //         (ULONG overlapLabelIndex) - index into label list of "OVERLAP"
@@ -176,11 +180,11 @@ Graph *CompressGraph(Graph *graph, InstanceList *instanceList,
 // the instance list's order.  I.e., the ith instance in the instance
 // list corresponds to compressedGraph->vertices[i-1].
 //
-// 2. All vertices and edges in the instances are marked (used=TRUE)
-// in the graph.  Instance vertices will be unmarked as processed.
+// 2. All vertices and edges in the instances are marked in the graph.
+// Instance vertices will be unmarked as processed.
 //
-// 3. The vertices in the given graph are all mapped to their appropriate
-// vertices in the compressedGraph.
+// 3. The vertices in the given graph are all mapped (by marks->vertexMap)
+// to their appropriate vertices in the compressedGraph.
 //
 // 4. For external edges pointing to vertices shared by multiple
 // instances, the compressed graph already contains one such edge
@@ -188,7 +192,7 @@ Graph *CompressGraph(Graph *graph, InstanceList *instanceList,
 // the substructure's instance list that contains the shared vertex.
 //---------------------------------------------------------------------------
 
-void AddOverlapEdges(Graph *compressedGraph, Graph *graph,
+void AddOverlapEdges(Graph *compressedGraph, Graph *graph, GraphMarks *marks,
                      InstanceList *instanceList, ULONG overlapLabelIndex,
 		     ULONG startVertex, ULONG startEdge)
 {
@@ -221,8 +225,8 @@ void AddOverlapEdges(Graph *compressedGraph, Graph *graph,
       for (v1 = 0; v1 < instance1->numVertices; v1++) 
       {
          vertex1 = &graph->vertices[instance1->vertices[v1]];
-         if (vertex1->used) 
-         {  // (used==TRUE) indicates unchecked for sharing
+         if (VERTEX_MARKED(marks, instance1->vertices[v1])) 
+         {  // (marked) indicates unchecked for sharing
             // for each instance2 after instance1
             instanceListNode2 = instanceListNode1->next;
             instanceNo2 = instanceNo1 + 1;
@@ -247,12 +251,12 @@ void AddOverlapEdges(Graph *compressedGraph, Graph *graph,
                      for (e = 0; e < vertex1->numEdges; e++) 
                      {
                         edge1 = &graph->edges[vertex1->edges[e]];
-                        if ((!edge1->used) &&
+                        if ((! EDGE_MARKED(marks, vertex1->edges[e])) &&
                             (vertex1->edges[e] >= startEdge))
                         { // edge external to instance
                            overlapEdges =
                               AddDuplicateEdges(overlapEdges, &numOverlapEdges,
-                                                edge1, graph, instanceNo1 - 1,
+                                                edge1, marks, instanceNo1 - 1,
                                                 instanceNo2 - 1);
                         }
                      }
@@ -261,7 +265,8 @@ void AddOverlapEdges(Graph *compressedGraph, Graph *graph,
                instanceListNode2 = instanceListNode2->next;
                instanceNo2++;
             }
-            vertex1->used = FALSE; // i.e., done processing vertex1 for overlap
+            // i.e., done processing vertex1 for overlap
+            MARK_VERTEX(marks, instance1->vertices[v1], FALSE);
          }
       }
       instanceListNode1 = instanceListNode1->next;
@@ -348,7 +353,7 @@ Edge *AddOverlapEdge(Edge *overlapEdges, ULONG *numOverlapEdgesPtr,
 //         (ULONG *numOverlapEdgesPtr) - pointer to variable holding number
 //           of total overlapping edges; will be incremented by 1, 2 or 3
 //         (Edge *edge) - edge to be duplicated
-//         (Graph *graph) - uncompressed graph containing edge
+//         (GraphMarks *marks) - marks on uncompressed graph containing edge
 //         (ULONG sub1VertexIndex) - "SUB" vertex index for first instance
 //         (ULONG sub2VertexIndex) - "SUB" vertex index for second instance
 //
@@ -371,7 +376,7 @@ Edge *AddOverlapEdge(Edge *overlapEdges, ULONG *numOverlapEdgesPtr,
 //---------------------------------------------------------------------------
 
 Edge *AddDuplicateEdges(Edge *overlapEdges, ULONG *numOverlapEdgesPtr,
-                        Edge *edge, Graph *graph,
+                        Edge *edge, GraphMarks *marks,
                         ULONG sub1VertexIndex, ULONG sub2VertexIndex)
 {
    ULONG numOverlapEdges;
@@ -383,20 +388,20 @@ Edge *AddDuplicateEdges(Edge *overlapEdges, ULONG *numOverlapEdgesPtr,
    if (overlapEdges == NULL)
       OutOfMemoryError("AddDuplicateEdges:overlapEdges1");
 
-   if (graph->vertices[edge->vertex1].map != sub1VertexIndex) 
+   if (marks->vertexMap[edge->vertex1] != sub1VertexIndex) 
    {
       // duplicate edge from external vertex
-      v1 = graph->vertices[edge->vertex1].map;
+      v1 = marks->vertexMap[edge->vertex1];
       v2 = sub2VertexIndex;
       StoreEdge(overlapEdges, numOverlapEdges, v1, v2, edge->label,
                 edge->directed, edge->spansIncrement);
       numOverlapEdges++;
    } 
-   else if (graph->vertices[edge->vertex2].map != sub1VertexIndex) 
+   else if (marks->vertexMap[edge->vertex2] != sub1VertexIndex) 
    {
       // duplicate edge to an external vertex
       v1 = sub2VertexIndex;
-      v2 = graph->vertices[edge->vertex2].map;
+      v2 = marks->vertexMap[edge->vertex2];
       StoreEdge(overlapEdges, numOverlapEdges, v1, v2, edge->label,
                 edge->directed, edge->spansIncrement);
       numOverlapEdges++;
@@ -411,8 +416,8 @@ Edge *AddDuplicateEdges(Edge *overlapEdges, ULONG *numOverlapEdgesPtr,
       numOverlapEdges++;
       // if other vertex unmarked (i.e., overlapping and already processed)
       // then duplicate edge connecting Sub2 to Sub2
-      if ((! graph->vertices[edge->vertex1].used) ||
-          (! graph->vertices[edge->vertex2].used)) 
+      if ((! VERTEX_MARKED(marks, edge->vertex1)) ||
+          (! VERTEX_MARKED(marks, edge->vertex2))) 
       {
          overlapEdges = (Edge *) realloc(overlapEdges,
                                  ((numOverlapEdges + 1) * sizeof(Edge)));
@@ -498,8 +503,10 @@ void WriteCompressedGraphToFile(Substructure *sub, Parameters *parameters,
    label.labelValue.stringLabel = subLabelString;
    StoreLabel(&label, labelList);
    if (allowInstanceOverlap &&
-       ((InstancesOverlap(sub->instances)) ||
-        (InstancesOverlap(sub->negInstances)))) 
+       ((InstancesOverlap(sub->instances, posGraph,
+                          parameters->graphMarks)) ||
+        (InstancesOverlap(sub->negInstances, negGraph,
+                          parameters->graphMarks)))) 
    {
       sprintf(overlapLabelString, "%s_%lu", OVERLAP_LABEL_STRING,
               iteration);
@@ -604,8 +611,10 @@ void CompressFinalGraphs(Substructure *sub, Parameters *parameters,
    label.labelValue.stringLabel = subLabelString;
    StoreLabel(& label, labelList);
    if (allowInstanceOverlap &&
-       ((InstancesOverlap(sub->instances)) ||
-        (InstancesOverlap(sub->negInstances)))) 
+       ((InstancesOverlap(sub->instances, posGraph,
+                          parameters->graphMarks)) ||
+        (InstancesOverlap(sub->negInstances, negGraph,
+                          parameters->graphMarks)))) 
    {
       if (predefinedSub)
          sprintf(overlapLabelString, "%s_%s_%lu", PREDEFINED_PREFIX,
@@ -724,6 +733,7 @@ ULONG SizeOfCompressedGraph(Graph *graph, InstanceList *instanceList,
    InstanceListNode *instanceListNode;
    Instance *instance;
    ULONG v, e;
+   GraphMarks *marks;
    BOOLEAN allowInstanceOverlap = parameters->allowInstanceOverlap;
 
    if (parameters->incremental)
@@ -737,34 +747,35 @@ ULONG SizeOfCompressedGraph(Graph *graph, InstanceList *instanceList,
       if (allowInstanceOverlap) 
       {
          // reduce size by amount of unique structure, which is marked
+         marks = GetGraphMarks(graph, parameters);
          while (instanceListNode != NULL) 
          {
             size++; // new "SUB" vertex of instance
             instance = instanceListNode->instance;
             // subtract unique vertices
             for (v = 0; v < instance->numVertices; v++)
-               if (!graph->vertices[instance->vertices[v]].used) 
+               if (! VERTEX_MARKED(marks, instance->vertices[v])) 
                {
                   size--;
-                  graph->vertices[instance->vertices[v]].used = TRUE;
+                  MARK_VERTEX(marks, instance->vertices[v], TRUE);
                }
             for (e = 0; e < instance->numEdges; e++)   // subtract unique edges
-               if (!graph->edges[instance->edges[e]].used) 
+               if (! EDGE_MARKED(marks, instance->edges[e])) 
                {
                   size--;
-                  graph->edges[instance->edges[e]].used = TRUE;
+                  MARK_EDGE(marks, instance->edges[e], TRUE);
                }
             instanceListNode = instanceListNode->next;
          }
          // increase size by number of overlap edges (assumes marked instances)
-         size += NumOverlapEdges(graph, instanceList);
-         // reset used flag of instances' vertices and edges
+         size += NumOverlapEdges(graph, marks, instanceList);
+         // unmark instances' vertices and edges
          instanceListNode = instanceList->head;
          while (instanceListNode != NULL) 
          {
             instance = instanceListNode->instance;
-            MarkInstanceVertices(instance, graph, FALSE);
-            MarkInstanceEdges(instance, graph, FALSE);
+            MarkInstanceVertices(instance, marks, FALSE);
+            MarkInstanceEdges(instance, marks, FALSE);
             instanceListNode = instanceListNode->next;
          }
       }
@@ -788,6 +799,7 @@ ULONG SizeOfCompressedGraph(Graph *graph, InstanceList *instanceList,
 // NAME: NumOverlapEdges
 //
 // INPUTS: (Graph *graph) - graph being "compressed" by substructure
+//         (GraphMarks *marks) - marks on graph
 //         (InstanceList *instanceList) - substructure instances
 //
 // RETURN: (ULONG) - number of "OVERLAP" and duplicate edges needed
@@ -800,11 +812,11 @@ ULONG SizeOfCompressedGraph(Graph *graph, InstanceList *instanceList,
 // are added to all instances sharing the vertex.
 //
 // This procedure assumes all vertices and edges in the instances are
-// marked (used=TRUE) in the graph.  Instance vertices will be
-// unmarked as processed.
+// marked in the graph.  Instance vertices will be unmarked as processed.
 //---------------------------------------------------------------------------
 
-ULONG NumOverlapEdges(Graph *graph, InstanceList *instanceList)
+ULONG NumOverlapEdges(Graph *graph, GraphMarks *marks,
+                      InstanceList *instanceList)
 {
    InstanceListNode *instanceListNode1;
    InstanceListNode *instanceListNode2;
@@ -835,8 +847,8 @@ ULONG NumOverlapEdges(Graph *graph, InstanceList *instanceList)
       for (v1 = 0; v1 < instance1->numVertices; v1++) 
       {
          vertex1 = & graph->vertices[instance1->vertices[v1]];
-         if (vertex1->used) 
-         { // (used==TRUE) indicates unchecked for sharing
+         if (VERTEX_MARKED(marks, instance1->vertices[v1])) 
+         { // (marked) indicates unchecked for sharing
             // for each instance2 after instance1
             instanceListNode2 = instanceListNode1->next;
             instanceNo2 = instanceNo1 + 1;
@@ -860,11 +872,11 @@ ULONG NumOverlapEdges(Graph *graph, InstanceList *instanceList)
                      for (e = 0; e < vertex1->numEdges; e++) 
                      {
                         edge1 = & graph->edges[vertex1->edges[e]];
-                        if (! edge1->used) 
+                        if (! EDGE_MARKED(marks, vertex1->edges[e])) 
                         { // edge external to instance
                            overlapEdges =
                               AddDuplicateEdges(overlapEdges, & numOverlapEdges,
-                                                edge1, graph,
+                                                edge1, marks,
                                                 instanceNo1 - 1, instanceNo2 - 1);
                         }
                      }
@@ -873,7 +885,8 @@ ULONG NumOverlapEdges(Graph *graph, InstanceList *instanceList)
                instanceListNode2 = instanceListNode2->next;
                instanceNo2++;
             }
-            vertex1->used = FALSE; // i.e., done processing vertex1 for overlap
+            // i.e., done processing vertex1 for overlap
+            MARK_VERTEX(marks, instance1->vertices[v1], FALSE);
          }
       }
       instanceListNode1 = instanceListNode1->next;
@@ -916,6 +929,7 @@ void RemovePosEgsCovered(Substructure *sub, Parameters *parameters)
    ULONG vertexOffset;
    ULONG *newPosEgsVertexIndices;
    LabelList *newLabelList;
+   GraphMarks *marks;
 
    // parameters used
    Graph *posGraph            = parameters->posGraph;
@@ -932,6 +946,7 @@ void RemovePosEgsCovered(Substructure *sub, Parameters *parameters)
    newNumEdges = 0;
    newPosEgsVertexIndices = NULL;
    instanceList = sub->instances;
+   marks = GetGraphMarks(posGraph, parameters);
    // for each example, look for a covering instance
    for (posEg = 0; posEg < numPosEgs; posEg++) 
    {
@@ -961,7 +976,7 @@ void RemovePosEgsCovered(Substructure *sub, Parameters *parameters)
          // mark vertices and edges of example (note: these will not be
          // unmarked, because this posGraph will soon be de-allocated)
          MarkExample(posEgStartVertexIndex, posEgEndVertexIndex,
-                     posGraph, TRUE);
+                     posGraph, marks, TRUE);
       } 
       else 
       {
@@ -974,12 +989,12 @@ void RemovePosEgsCovered(Substructure *sub, Parameters *parameters)
    }
    // count number of edges in examples left uncovered
    for (e = 0; e < posGraph->numEdges; e++)
-      if (! posGraph->edges[e].used)
+      if (! EDGE_MARKED(marks, e))
          newNumEdges++;
 
    // create new positive graph and copy unmarked part of old
    newPosGraph = AllocateGraph(newNumVertices, newNumEdges);
-   CopyUnmarkedGraph(posGraph, newPosGraph, 0, parameters);
+   CopyUnmarkedGraph(posGraph, marks, newPosGraph, 0, parameters);
 
    // compress label list and recompute graphs' labels
    newLabelList = AllocateLabelList();
@@ -1063,7 +1078,7 @@ void MarkPosEgsCovered(Substructure *sub, Parameters *parameters)
          // mark vertices and edges of example (note: these will not be
          // unmarked, because this posGraph will soon be de-allocated)
          MarkExample(posEgStartVertexIndex, posEgEndVertexIndex,
-                     posGraph, TRUE);
+                     posGraph, GetGraphMarks(posGraph, parameters), TRUE);
       } 
    }
 }
@@ -1156,6 +1171,7 @@ void WriteUpdatedIncToFile(Substructure *sub, Parameters *parameters)
    ULONG i;
    ULONG first = 0;
    Increment *increment = GetCurrentIncrement(parameters);
+   GraphMarks *marks;
 
    if (parameters->incremental)
       first = increment->startPosVertexIndex;
@@ -1167,6 +1183,7 @@ void WriteUpdatedIncToFile(Substructure *sub, Parameters *parameters)
    {
       numExamples = parameters->numPosEgs;
       fp = fopen(filename, "w");
+      marks = GetGraphMarks(parameters->posGraph, parameters);
 
       // The indices of each example need to be renumbered to start at 1
       for (example = 0; example < numExamples; example++)
@@ -1179,7 +1196,7 @@ void WriteUpdatedIncToFile(Substructure *sub, Parameters *parameters)
             else 
                finish = parameters->posGraph->numVertices;
             // Only write positive examples not covered by substructure
-            if (!parameters->posGraph->vertices[start].used)
+            if (! VERTEX_MARKED(marks, start))
             {
                fprintf(fp, "XP\n");
                WriteGraphToFile(fp, parameters->posGraph, parameters->labelList,
@@ -1217,8 +1234,9 @@ void WriteUpdatedIncToFile(Substructure *sub, Parameters *parameters)
    }
 
    // Unmark covered vertices
+   marks = GetGraphMarks(parameters->posGraph, parameters);
    for (i=start; i<parameters->posGraph->numVertices; i++)
-      parameters->posGraph->vertices[i].used = FALSE; 
+      MARK_VERTEX(marks, i, FALSE);
 }
 
 
@@ -1228,16 +1246,18 @@ void WriteUpdatedIncToFile(Substructure *sub, Parameters *parameters)
 // INPUTS: (ULONG egStartVertexIndex) - starting vertex of example
 //         (ULONG egEndVertexIndex) - ending vertex of example
 //         (Graph *graph) - graph containing example
-//         (BOOLEAN value) - value for used flag of example vertices/edges
+//         (GraphMarks *marks) - marks on graph
+//         (BOOLEAN value) - TRUE to mark example vertices/edges, FALSE
+//                           to unmark
 //
 // RETURN: (void)
 //
-// PURPOSE: Sets the used flag to value for all vertices and edges
-// comprising the example whose range of vertices is given.
+// PURPOSE: Marks or unmarks all vertices and edges comprising the
+// example whose range of vertices is given.
 //---------------------------------------------------------------------------
 
 void MarkExample(ULONG egStartVertexIndex, ULONG egEndVertexIndex,
-                 Graph *graph, BOOLEAN value)
+                 Graph *graph, GraphMarks *marks, BOOLEAN value)
 {
    ULONG v;
    ULONG e;
@@ -1246,9 +1266,9 @@ void MarkExample(ULONG egStartVertexIndex, ULONG egEndVertexIndex,
    for (v = egStartVertexIndex; v <= egEndVertexIndex; v++) 
    {
       vertex = & graph->vertices[v];
-      vertex->used = value;
+      MARK_VERTEX(marks, v, value);
       for (e = 0; e < vertex->numEdges; e++)
-         graph->edges[vertex->edges[e]].used = value;
+         MARK_EDGE(marks, vertex->edges[e], value);
    }
 }
 
@@ -1256,21 +1276,22 @@ void MarkExample(ULONG egStartVertexIndex, ULONG egEndVertexIndex,
 //---------------------------------------------------------------------------
 // NAME: CopyUnmarkedGraph
 //
-// INPUTS: (Graph *g1) - graph to copy unused structure from
+// INPUTS: (Graph *g1) - graph to copy unmarked structure from
+//         (GraphMarks *marks) - marks on g1
 //         (Graph *g2) - graph to copy to
 //         (ULONG vertexIndex) - index into g2's vertex array where to
-//           start copying unused vertices from g1
+//           start copying unmarked vertices from g1
 //         (Parameters *parameters)
 //
 // RETURN: (void)
 //
-// PURPOSE: Copy unused vertices and edges from g1 to g2, starting at
+// PURPOSE: Copy unmarked vertices and edges from g1 to g2, starting at
 // vertexIndex of g2's vertex array.  Ensures that copied edges map to
-// correct vertices in g2.
+// correct vertices in g2, recording the mapping in marks->vertexMap.
 //---------------------------------------------------------------------------
 
-void CopyUnmarkedGraph(Graph *g1, Graph *g2, ULONG vertexIndex,
-                       Parameters *parameters)
+void CopyUnmarkedGraph(Graph *g1, GraphMarks *marks, Graph *g2,
+                       ULONG vertexIndex, Parameters *parameters)
 {
    ULONG v, e;
    ULONG v1, v2;
@@ -1286,7 +1307,7 @@ void CopyUnmarkedGraph(Graph *g1, Graph *g2, ULONG vertexIndex,
 
       // Copy the newly compressed increment vertices to the new graph
       for (v = 0; v < increment->numPosVertices; v++)
-         if (!g1->vertices[vertexOffset + v].used)
+         if (! VERTEX_MARKED(marks, vertexOffset + v))
          {
             g2->vertices[vertexIndex].label =
                g1->vertices[vertexOffset + v].label;
@@ -1296,7 +1317,7 @@ void CopyUnmarkedGraph(Graph *g1, Graph *g2, ULONG vertexIndex,
             g2->vertices[vertexIndex].edges = NULL;
             g2->vertices[vertexIndex].map = VERTEX_UNMAPPED;
             g2->vertices[vertexIndex].used = FALSE;
-            g1->vertices[vertexOffset + v].map = vertexIndex;
+            marks->vertexMap[vertexOffset + v] = vertexIndex;
             vertexIndex++;
          }
  
@@ -1304,14 +1325,14 @@ void CopyUnmarkedGraph(Graph *g1, Graph *g2, ULONG vertexIndex,
       edgeOffset = increment->startPosEdgeIndex;
       edgeIndex = 0;
       for (e = 0; e < increment->numPosEdges; e++)
-         if (!g1->edges[edgeOffset + e].used)
+         if (! EDGE_MARKED(marks, edgeOffset + e))
          {
             if (g1->edges[edgeOffset + e].spansIncrement)
                g2->numEdges = g2->numEdges - 1;
             else
             {
-               v1 = g1->vertices[g1->edges[edgeOffset + e].vertex1].map;
-               v2 = g1->vertices[g1->edges[edgeOffset + e].vertex2].map;
+               v1 = marks->vertexMap[g1->edges[edgeOffset + e].vertex1];
+               v2 = marks->vertexMap[g1->edges[edgeOffset + e].vertex2];
                StoreEdge(g2->edges, edgeIndex, v1, v2,
 	                 g1->edges[edgeOffset + e].label,
                          g1->edges[edgeOffset + e].directed,
@@ -1323,25 +1344,25 @@ void CopyUnmarkedGraph(Graph *g1, Graph *g2, ULONG vertexIndex,
    }
    else
    {
-      // copy unused vertices from g1 to g2
+      // copy unmarked vertices from g1 to g2
       for (v = 0; v < g1->numVertices; v++)
-         if (! g1->vertices[v].used) 
+         if (! VERTEX_MARKED(marks, v)) 
          {
             g2->vertices[vertexIndex].label = g1->vertices[v].label;
             g2->vertices[vertexIndex].numEdges = 0;
             g2->vertices[vertexIndex].edges = NULL;
             g2->vertices[vertexIndex].map = VERTEX_UNMAPPED;
             g2->vertices[vertexIndex].used = FALSE;
-            g1->vertices[v].map = vertexIndex;
+            marks->vertexMap[v] = vertexIndex;
             vertexIndex++;
          }
-      // copy unused edges from g1 to g2
+      // copy unmarked edges from g1 to g2
       edgeIndex = 0;
       for (e = 0; e < g1->numEdges; e++)
-         if (! g1->edges[e].used) 
+         if (! EDGE_MARKED(marks, e)) 
          {
-            v1 = g1->vertices[g1->edges[e].vertex1].map;
-            v2 = g1->vertices[g1->edges[e].vertex2].map;
+            v1 = marks->vertexMap[g1->edges[e].vertex1];
+            v2 = marks->vertexMap[g1->edges[e].vertex2];
             StoreEdge(g2->edges, edgeIndex, v1, v2, g1->edges[e].label,
                       g1->edges[e].directed, g1->edges[e].spansIncrement);
             AddEdgeToVertices(g2, edgeIndex);
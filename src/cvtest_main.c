@@ -75,6 +75,8 @@ int main(int argc, char **argv)
       OutOfMemoryError("GetParameters:parameters");
    parameters->directed = TRUE;
    parameters->labelList = AllocateLabelList();
+   AllocateParameterMarks(parameters);
+   parameters->matchMethod = MATCH_SEARCH;
 
    // Process arguments
    numFolds = 1;
@@ -168,13 +170,14 @@ int main(int argc, char **argv)
 void NumPosNegExamples(char *fileName, ULONG *numPosEgs, ULONG *numNegEgs)
 {
    FILE *fp;
+   Decompressor *decompressor;
    char token[TOKEN_LEN];
    ULONG lineNo = 1;
    ULONG numPos = 0;
    ULONG numNeg = 0;
 
    // open example graphs file and compute stats
-   fp = fopen(fileName, "r");
+   fp = OpenInputStream(fileName, & decompressor);
    if (fp == NULL) 
    {
       printf("Unable to open graph file %s.\n", fileName);
@@ -202,7 +205,7 @@ void NumPosNegExamples(char *fileName, ULONG *numPosEgs, ULONG *numNegEgs)
       if (strstr(token, NEG_EG_TOKEN) == token)
          numNeg++;
    }
-   fclose(fp);
+   CloseInputStream(fp, decompressor);
    *numPosEgs = numPos;
    *numNegEgs = numNeg;
 }
@@ -234,6 +237,7 @@ void WriteTrainTestFiles(char *inputFileName, char *trainFileName,
                          ULONG numEgs, ULONG numFolds) 
 {
    FILE *inputFile;
+   Decompressor *decompressor;
    FILE *trainFile;
    FILE *testFile;
    FILE *outFile;
@@ -254,7 +258,7 @@ void WriteTrainTestFiles(char *inputFileName, char *trainFileName,
    }
 
    // open input file
-   inputFile = fopen(inputFileName, "r");
+   inputFile = OpenInputStream(inputFileName, & decompressor);
    if (inputFile == NULL) 
    {
       printf("Unable to open input file %s.\n", inputFileName);
@@ -318,7 +322,7 @@ void WriteTrainTestFiles(char *inputFileName, char *trainFileName,
    }
    fclose(testFile);
    fclose(trainFile);
-   fclose(inputFile);
+   CloseInputStream(inputFile, decompressor);
 }
 
 
@@ -20,6 +20,11 @@
 // the given parameters.  Note that we do not allow a single-vertex
 // substructure of the form "SUB_#" on to the discovery list to avoid
 // continually replacing "SUB_<n>" with "SUB_<n+1>".
+//
+// If parameters->numThreads > 1, then the parents to be extended at
+// each level of the search are first extended and evaluated in parallel,
+// and the results are then merged into the child and discovered lists in
+// the same order as the serial search, so the output is identical.
 //---------------------------------------------------------------------------
 
 SubList *DiscoverSubs(Parameters *parameters)
@@ -33,6 +38,10 @@ SubList *DiscoverSubs(Parameters *parameters)
    Substructure *parentSub;
    Substructure *extendedSub;
    Substructure *recursiveSub = NULL;
+   ExtendWorker *workers = NULL;
+   ExtendWorkQueue workQueue;
+   ULONG workLimit;
+   ULONG workIndex = 0;
 
    // parameters used
    ULONG limit          = parameters->limit;
@@ -46,15 +55,46 @@ SubList *DiscoverSubs(Parameters *parameters)
    ULONG outputLevel    = parameters->outputLevel;
    BOOLEAN recursion    = parameters->recursion;
    ULONG evalMethod     = parameters->evalMethod;
+   ULONG numThreads     = parameters->numThreads;
 
    // get initial one-vertex substructures
    parentSubList = GetInitialSubs(parameters);
 
+   if (numThreads > 1)
+   {
+      workers = AllocateExtendWorkers(parameters);
+      workQueue.items = NULL;
+      workQueue.size = 0;
+      pthread_mutex_init(& workQueue.lock, NULL);
+   }
+
    discoveredSubList = AllocateSubList();
+   IndexSubList(discoveredSubList);
    while ((limit > 0) && (parentSubList->head != NULL)) 
    {
+      if (workers != NULL)
+      {
+         // collect the parents that the loop below will extend, in order,
+         // and extend and evaluate them in parallel
+         workQueue.numItems = 0;
+         workLimit = limit;
+         parentSubListNode = parentSubList->head;
+         while ((parentSubListNode != NULL) && (workLimit > 0))
+         {
+            parentSub = parentSubListNode->sub;
+            if (ShouldExtendSub(parentSub, evalMethod))
+            {
+               workLimit--;
+               AddExtendWorkItem(& workQueue, parentSub);
+            }
+            parentSubListNode = parentSubListNode->next;
+         }
+         ExtendSubsInParallel(& workQueue, workers, numThreads);
+         workIndex = 0;
+      }
       parentSubListNode = parentSubList->head;
       childSubList = AllocateSubList();
+      IndexSubList(childSubList);
       // extend each substructure in parent list
       while (parentSubListNode != NULL)
       {
@@ -68,15 +108,17 @@ SubList *DiscoverSubs(Parameters *parameters)
             printf("\n");
             parameters->outputLevel = outputLevel;
          }
-         if ((((parentSub->numInstances > 1) && (evalMethod != EVAL_SETCOVER)) ||
-              (parentSub->numNegInstances > 0)) &&
-             (limit > 0))
+         if (ShouldExtendSub(parentSub, evalMethod) && (limit > 0))
          {
             limit--;
             if (outputLevel > 3)
                printf("%lu substructures left to be considered\n", limit);
             fflush(stdout);
-            extendedSubList = ExtendSub(parentSub, parameters);
+            if (workers != NULL)
+               extendedSubList =
+                  workQueue.items[workIndex++].extendedSubList;
+            else
+               extendedSubList = ExtendAndEvaluateSub(parentSub, parameters);
             extendedSubListNode = extendedSubList->head;
             while (extendedSubListNode != NULL) 
             {
@@ -84,8 +126,7 @@ SubList *DiscoverSubs(Parameters *parameters)
                extendedSubListNode->sub = NULL;
                if (extendedSub->definition->numVertices <= maxVertices) 
                {
-                  // evaluate each extension and add to child list
-                  EvaluateSub(extendedSub, parameters);
+                  // add each evaluated extension to child list
                   if (prune && (extendedSub->value < parentSub->value)) 
                   {
                      FreeSub(extendedSub);
@@ -143,6 +184,13 @@ SubList *DiscoverSubs(Parameters *parameters)
       parentSubList = childSubList;
    }
 
+   if (workers != NULL)
+   {
+      free(workQueue.items);
+      pthread_mutex_destroy(& workQueue.lock);
+      FreeExtendWorkers(workers, parameters);
+   }
+
    if ((limit > 0) && (outputLevel > 2))
       printf ("\nSubstructure queue empty.\n");
 
@@ -169,10 +217,250 @@ SubList *DiscoverSubs(Parameters *parameters)
       parentSubListNode = parentSubListNode->next;
    }
    FreeSubList(parentSubList);
+   UnindexSubList(discoveredSubList); // callers change the list directly
    return discoveredSubList;
 }
 
 
+//---------------------------------------------------------------------------
+// NAME: ShouldExtendSub
+//
+// INPUTS: (Substructure *sub) - parent substructure
+//         (ULONG evalMethod) - evaluation method in use
+//
+// RETURN: (BOOLEAN) - TRUE if sub is worth extending
+//
+// PURPOSE: A parent is extended if it has more than one positive
+// instance (except under set-cover evaluation) or any negative
+// instances; otherwise no extension of it can do better.
+//---------------------------------------------------------------------------
+
+BOOLEAN ShouldExtendSub(Substructure *sub, ULONG evalMethod)
+{
+   return (((sub->numInstances > 1) && (evalMethod != EVAL_SETCOVER)) ||
+           (sub->numNegInstances > 0));
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: AddExtendWorkItem
+//
+// INPUTS: (ExtendWorkQueue *queue) - queue of parents to be extended
+//         (Substructure *parentSub) - parent to add to queue
+//
+// RETURN: (void)
+//
+// PURPOSE: Add the parent to the end of the queue, growing the queue's
+// items array if necessary.  The array is kept from level to level.
+//---------------------------------------------------------------------------
+
+void AddExtendWorkItem(ExtendWorkQueue *queue, Substructure *parentSub)
+{
+   ExtendWorkItem *items;
+   ULONG size;
+
+   if (queue->numItems == queue->size)
+   {
+      size = (queue->size < LIST_SIZE_INC) ? LIST_SIZE_INC : (2 * queue->size);
+      items = (ExtendWorkItem *)
+         realloc(queue->items, sizeof(ExtendWorkItem) * size);
+      if (items == NULL)
+         OutOfMemoryError("AddExtendWorkItem:items");
+      queue->items = items;
+      queue->size = size;
+   }
+   queue->items[queue->numItems].parentSub = parentSub;
+   queue->items[queue->numItems].extendedSubList = NULL;
+   queue->numItems++;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ExtendAndEvaluateSub
+//
+// INPUTS: (Substructure *parentSub) - substructure to be extended
+//         (Parameters *parameters)
+//
+// RETURN: (SubList *) - list of extended substructures
+//
+// PURPOSE: Extend the given substructure and evaluate each extension
+// that does not exceed the maximum substructure size.  Larger
+// extensions are returned unevaluated, to be discarded by the caller.
+//---------------------------------------------------------------------------
+
+SubList *ExtendAndEvaluateSub(Substructure *parentSub, Parameters *parameters)
+{
+   SubList *extendedSubList;
+   SubListNode *extendedSubListNode;
+   Substructure *extendedSub;
+
+   // parameters used
+   ULONG maxVertices = parameters->maxVertices;
+
+   extendedSubList = ExtendSub(parentSub, parameters);
+   extendedSubListNode = extendedSubList->head;
+   while (extendedSubListNode != NULL)
+   {
+      extendedSub = extendedSubListNode->sub;
+      if (extendedSub->definition->numVertices <= maxVertices)
+         EvaluateSub(extendedSub, parameters);
+      extendedSubListNode = extendedSubListNode->next;
+   }
+   return extendedSubList;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: AllocateExtendWorkers
+//
+// INPUTS: (Parameters *parameters)
+//
+// RETURN: (ExtendWorker *) - array of parameters->numThreads workers
+//
+// PURPOSE: Allocate the per-thread state for parallel discovery.  Each
+// worker gets its own graph marks and its own lg(n!) cache, since
+// Log2Factorial may grow it.  The positive and negative graphs are
+// shared, so their cached MDL row statistics are computed here, before
+// any thread can need them.  Everything else in the parameters is only
+// read while extending.
+//---------------------------------------------------------------------------
+
+ExtendWorker *AllocateExtendWorkers(Parameters *parameters)
+{
+   ExtendWorker *workers;
+   Parameters *workerParameters;
+   ULONG i;
+
+   workers = (ExtendWorker *)
+      malloc(sizeof(ExtendWorker) * parameters->numThreads);
+   if (workers == NULL)
+      OutOfMemoryError("AllocateExtendWorkers:workers");
+   if (parameters->evalMethod == EVAL_MDL)
+   {
+      if (parameters->posGraph->rowStats == NULL)
+         ComputeGraphRowStats(parameters->posGraph);
+      if ((parameters->negGraph != NULL) &&
+          (parameters->negGraph->rowStats == NULL))
+         ComputeGraphRowStats(parameters->negGraph);
+   }
+   for (i = 0; i < parameters->numThreads; i++)
+   {
+      workers[i].queue = NULL;
+      workerParameters = & workers[i].parameters;
+      *workerParameters = *parameters;
+      AllocateParameterMarks(workerParameters);
+      workerParameters->log2Factorial = (double *)
+         malloc(sizeof(double) * parameters->log2FactorialSize);
+      if (workerParameters->log2Factorial == NULL)
+         OutOfMemoryError("AllocateExtendWorkers:log2Factorial");
+      memcpy(workerParameters->log2Factorial, parameters->log2Factorial,
+             sizeof(double) * parameters->log2FactorialSize);
+   }
+   return workers;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FreeExtendWorkers
+//
+// INPUTS: (ExtendWorker *workers) - workers to be freed
+//         (Parameters *parameters)
+//
+// RETURN: (void)
+//
+// PURPOSE: Free the per-thread state allocated by AllocateExtendWorkers.
+//---------------------------------------------------------------------------
+
+void FreeExtendWorkers(ExtendWorker *workers, Parameters *parameters)
+{
+   ULONG i;
+
+   for (i = 0; i < parameters->numThreads; i++)
+   {
+      FreeParameterMarks(& workers[i].parameters);
+      free(workers[i].parameters.log2Factorial);
+   }
+   free(workers);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ExtendSubsInParallel
+//
+// INPUTS: (ExtendWorkQueue *queue) - parent substructures to be extended
+//         (ExtendWorker *workers) - per-thread state
+//         (ULONG numWorkers) - number of workers
+//
+// RETURN: (void)
+//
+// PURPOSE: Extend and evaluate every parent substructure in the queue,
+// using up to numWorkers threads.  Each item's extendedSubList is set
+// to the result of ExtendAndEvaluateSub on its parent.  Threads claim
+// items in queue order, but since each result is stored with its item,
+// the order in which the items finish does not matter.
+//---------------------------------------------------------------------------
+
+void ExtendSubsInParallel(ExtendWorkQueue *queue, ExtendWorker *workers,
+                          ULONG numWorkers)
+{
+   ULONG i;
+
+   if (numWorkers > queue->numItems)
+      numWorkers = queue->numItems;
+   queue->nextItem = 0;
+   for (i = 0; i < numWorkers; i++)
+   {
+      workers[i].queue = queue;
+      if (pthread_create(& workers[i].thread, NULL, ExtendWorkerThread,
+                         & workers[i]) != 0)
+      {
+         fprintf(stderr, "ExtendSubsInParallel: unable to create thread\n");
+         exit(1);
+      }
+   }
+   for (i = 0; i < numWorkers; i++)
+      pthread_join(workers[i].thread, NULL);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ExtendWorkerThread
+//
+// INPUTS: (void *arg) - the thread's ExtendWorker
+//
+// RETURN: (void *) - NULL
+//
+// PURPOSE: Thread body for ExtendSubsInParallel.  Repeatedly claims the
+// next unclaimed item in the worker's queue and extends and evaluates
+// its parent using the worker's private parameters.
+//---------------------------------------------------------------------------
+
+void *ExtendWorkerThread(void *arg)
+{
+   ExtendWorker *worker = (ExtendWorker *) arg;
+   ExtendWorkQueue *queue = worker->queue;
+   ExtendWorkItem *item;
+
+   do
+   {
+      item = NULL;
+      pthread_mutex_lock(& queue->lock);
+      if (queue->nextItem < queue->numItems)
+      {
+         item = & queue->items[queue->nextItem];
+         queue->nextItem++;
+      }
+      pthread_mutex_unlock(& queue->lock);
+      if (item != NULL)
+         item->extendedSubList =
+            ExtendAndEvaluateSub(item->parentSub, & worker->parameters);
+   } while (item != NULL);
+   ReleasePoolCaches();
+   ReleaseMatchWorkspace();
+   return NULL;
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: GetInitialSubs
 //
@@ -223,6 +511,7 @@ SubList *GetInitialSubs(Parameters *parameters)
   
    numInitialSubs = 0;
    initialSubs = AllocateSubList();
+   IndexSubList(initialSubs);
    for (i = startVertexIndex; i < posGraph->numVertices; i++)
    {
       vertexLabelIndex = posGraph->vertices[i].label;
@@ -235,6 +524,7 @@ SubList *GetInitialSubs(Parameters *parameters)
          g->vertices[0].label = vertexLabelIndex;
          g->vertices[0].numEdges = 0;
          g->vertices[0].edges = NULL;
+         g->vertices[0].used = FALSE;
          // allocate substructure
          sub = AllocateSub();
          sub->definition = g;
@@ -102,6 +102,7 @@ void WriteGraphWithInstancesToDotFile(char *dotFileName, Graph *graph,
    ULONG v;
    ULONG e;
    ULONG vertexOffset;
+   GraphMarks *marks;
 
    // parameters used
    LabelList *labelList = parameters->labelList;
@@ -120,6 +121,7 @@ void WriteGraphWithInstancesToDotFile(char *dotFileName, Graph *graph,
 
    vertexOffset = 0; // always zero for writing just one graph
    // first write instances of graph to dot file
+   marks = GetGraphMarks(graph, parameters);
    i = 0;
    instanceListNode = instanceList->head;
    while (instanceListNode != NULL) 
@@ -131,19 +133,19 @@ void WriteGraphWithInstancesToDotFile(char *dotFileName, Graph *graph,
       for (e = 0; e < instance->numEdges; e++)
          WriteEdgeToDotFile(dotFile, instance->edges[e], vertexOffset,
                             graph, labelList, "blue");
-      MarkInstanceVertices(instance, graph, TRUE);
-      MarkInstanceEdges(instance, graph, TRUE);
+      MarkInstanceVertices(instance, marks, TRUE);
+      MarkInstanceEdges(instance, marks, TRUE);
       instanceListNode = instanceListNode->next;
       i++;
    }
 
    // write rest of graph to dot file
    for (v = 0; v < graph->numVertices; v++)
-      if (! graph->vertices[v].used)
+      if (! VERTEX_MARKED(marks, v))
          WriteVertexToDotFile(dotFile, v, vertexOffset, graph, labelList,
                               "black");
    for (e = 0; e < graph->numEdges; e++)
-      if (! graph->edges[e].used)
+      if (! EDGE_MARKED(marks, e))
          WriteEdgeToDotFile(dotFile, e, vertexOffset, graph, labelList,
                             "black");
 
@@ -156,8 +158,8 @@ void WriteGraphWithInstancesToDotFile(char *dotFileName, Graph *graph,
    while (instanceListNode != NULL) 
    {
       instance = instanceListNode->instance;
-      MarkInstanceVertices(instance, graph, FALSE);
-      MarkInstanceEdges(instance, graph, FALSE);
+      MarkInstanceVertices(instance, marks, FALSE);
+      MarkInstanceEdges(instance, marks, FALSE);
       instanceListNode = instanceListNode->next;
    }
 }
@@ -99,34 +99,57 @@ void EvaluateSub(Substructure *sub, Parameters *parameters)
          numLabels = labelList->numLabels;
          sizeOfSub = MDL(sub->definition, numLabels, parameters);
          sizeOfPosGraph = posGraphDL; // cached at beginning
-         compressedGraph = CompressGraph(posGraph, sub->instances, parameters);
          numLabels++; // add one for new "SUB" vertex label
          if ((allowInstanceOverlap) &&
-             ((InstancesOverlap(sub->instances)) ||
-              (InstancesOverlap(sub->negInstances))))
+             ((InstancesOverlap(sub->instances, posGraph,
+                                parameters->graphMarks)) ||
+              (InstancesOverlap(sub->negInstances, negGraph,
+                                parameters->graphMarks))))
             numLabels++; // add one for new "OVERLAP" edge label
-         sizeOfCompressedPosGraph = MDL(compressedGraph, numLabels, parameters);
-         // add extra bits to describe where external edges connect to instances
-         sizeOfCompressedPosGraph +=
-            ExternalEdgeBits(compressedGraph,sub->definition,sub->numInstances);
-         subValue = sizeOfPosGraph / (sizeOfSub + sizeOfCompressedPosGraph);
-         FreeGraph(compressedGraph);
-         if (negGraph != NULL) 
+         // compute size of compressed graph directly if possible, else
+         // actually compress the graph (recursive subs are evaluated while
+         // their instances' edges are marked, which only CompressGraph
+         // accounts for)
+         if ((sub->recursive) ||
+             (! CompressedGraphDL(posGraph, sub->instances, sub->definition,
+                                 sub->numInstances, numLabels, parameters,
+                                 & sizeOfCompressedPosGraph)))
          {
-            sizeOfNegGraph = negGraphDL; // cached at beginning
-            compressedGraph = CompressGraph(negGraph, sub->negInstances,
+            compressedGraph = CompressGraph(posGraph, sub->instances,
                                             parameters);
-            sizeOfCompressedNegGraph = MDL(compressedGraph,numLabels,
+            sizeOfCompressedPosGraph = MDL(compressedGraph, numLabels,
                                            parameters);
-            // add extra bits to describe where external edges connect to 
+            // add extra bits to describe where external edges connect to
             // instances
-            sizeOfCompressedNegGraph +=
+            sizeOfCompressedPosGraph +=
                ExternalEdgeBits(compressedGraph, sub->definition,
-                                sub->numNegInstances);
+                                sub->numInstances);
+            FreeGraph(compressedGraph);
+         }
+         subValue = sizeOfPosGraph / (sizeOfSub + sizeOfCompressedPosGraph);
+         if (negGraph != NULL) 
+         {
+            sizeOfNegGraph = negGraphDL; // cached at beginning
+            if ((sub->recursive) ||
+                (! CompressedGraphDL(negGraph, sub->negInstances,
+                                     sub->definition, sub->numNegInstances,
+                                     numLabels, parameters,
+                                     & sizeOfCompressedNegGraph)))
+            {
+               compressedGraph = CompressGraph(negGraph, sub->negInstances,
+                                               parameters);
+               sizeOfCompressedNegGraph = MDL(compressedGraph,numLabels,
+                                              parameters);
+               // add extra bits to describe where external edges connect to 
+               // instances
+               sizeOfCompressedNegGraph +=
+                  ExternalEdgeBits(compressedGraph, sub->definition,
+                                   sub->numNegInstances);
+               FreeGraph(compressedGraph);
+            }
             subValue = (sizeOfPosGraph + sizeOfNegGraph) /
                        (sizeOfSub + sizeOfCompressedPosGraph + sizeOfNegGraph -
                         sizeOfCompressedNegGraph);
-            FreeGraph(compressedGraph);
          }
       break;
 
@@ -250,6 +273,8 @@ ULONG GraphSize(Graph *graph)
 // vertex i and j, then k_i is the number of 1s in the ith row of A,
 // then B = max(k_i) and K = sum(i=0,V) k_i.  Finally, M is the
 // maximum number of edges between any two vertices in the graph.
+// The rows are summed by number of 1s, as by RowCountsBits, so that
+// CompressedGraphDL can compute the same value from row counts.
 // 
 // While the encoding is not provably minimal, a lot of work has been
 // done to make it minimal.  See the Subdue papers for details on the
@@ -267,37 +292,34 @@ double MDL(Graph *graph, ULONG numLabels, Parameters *parameters)
    ULONG E;  // number of edges
    ULONG L;  // number of unique labels
    ULONG ki; // number of 1s in row i of adjacency matrix
-   ULONG B;  // maximum number of 1s in a row of the adjacency matrix
    ULONG K;  // number of 1s in adjacency matrix
    ULONG M;  // maximum number of edges between any two vertices
    ULONG tmpM;
+   RowEdge *rowBuffer = NULL;
+   ULONG rowBufferSize = 0;
+   ULONG *rowCounts = NULL; // number of rows with each number of 1s
+   ULONG rowCountsSize = 0;
 
    V = graph->numVertices;
    E = graph->numEdges;
    L = numLabels;
    vertexBits = Log2(V) + (V * Log2(L));
-   rowBits = V * Log2Factorial(V, parameters);
    edgeBits = E * (1 + Log2(L));
-   B = 0;
-   K = 0;
    M = 0;
    for (v1 = 0; v1 < V; v1++) 
    {
-      ki = NumUniqueEdges(graph, v1);
-      rowBits -= (Log2Factorial(ki, parameters) +
-                  Log2Factorial((V - ki), parameters));
-      if (ki > B) 
-      {
-         B = ki;
-      }
-      K += ki;
-      tmpM = MaxEdgesToSingleVertex(graph, v1);
+      CompressedRowStats(graph, NULL, graph->vertices[v1].numEdges,
+                         graph->vertices[v1].edges, v1, 0,
+                         & rowBuffer, & rowBufferSize, & ki, & tmpM);
+      CountRow(& rowCounts, & rowCountsSize, ki);
       if (tmpM > M) 
       {
          M = tmpM;
       }
    }
-   rowBits += ((V + 1) * Log2(B + 1));
+   free(rowBuffer);
+   rowBits = RowCountsBits(V, rowCounts, rowCountsSize, parameters, & K);
+   free(rowCounts);
    edgeBits += ((K + 1) * Log2(M));
    totalBits = vertexBits + rowBits + edgeBits;
 
@@ -306,115 +328,566 @@ double MDL(Graph *graph, ULONG numLabels, Parameters *parameters)
 
 
 //---------------------------------------------------------------------------
-// NAME: NumUniqueEdges
+// NAME: CompressedGraphDL
+//
+// INPUTS: (Graph *graph) - graph to be compressed
+//         (InstanceList *instanceList) - substructure instances used to
+//                                        compress graph
+//         (Graph *subGraph) - substructure's graph definition
+//         (ULONG numInstances) - number of substructure instances
+//         (ULONG numLabels) - number of labels in compressed graph
+//         (Parameters *parameters)
+//         (double *compressedDL) - set to description length of compressed
+//                                  graph plus external edge bits
+//
+// RETURN: (BOOLEAN) - TRUE if compressedDL computed, else FALSE
 //
-// INPUTS: (Graph *graph) - graph containing vertex
-//         (ULONG v1) - vertex to find number of unique edges
+// PURPOSE: Computes the same value as
 //
-// RETURN: (ULONG) - number of unique edges of vertex v1
+//   MDL(CompressGraph(graph)) + ExternalEdgeBits(CompressGraph(graph))
 //
-// PURPOSE: Compute the number of different vertices that vertex v1 has an
-// edge to.  If edge is undirected, then it is included only if connected
-// to a larger-numbered vertex (or itself).  This prevents double counting
-// undirected edges.
+// without building the compressed graph.  Compression only changes the
+// rows of the adjacency matrix belonging to the new "SUB" vertices and
+// to vertices adjacent to an instance, so only those rows are
+// recomputed.  The counts of the other rows come from the graph's
+// cached counts, less the rows of instance vertices and their
+// neighbors, so the work depends on the size of the instances and
+// their neighborhoods rather than of the graph.  MDL() sums rows by
+// their counts too, so the result is bit-for-bit identical.  Returns
+// FALSE, and the caller must compress the graph, if the instances
+// overlap (requiring "OVERLAP" edges) or if in incremental mode.
 //---------------------------------------------------------------------------
 
-ULONG NumUniqueEdges(Graph *graph, ULONG v1)
+BOOLEAN CompressedGraphDL(Graph *graph, InstanceList *instanceList,
+                          Graph *subGraph, ULONG numInstances,
+                          ULONG numLabels, Parameters *parameters,
+                          double *compressedDL)
 {
-   ULONG e;
-   ULONG v2;
+   InstanceListNode *instanceListNode;
+   Instance *instance;
+   GraphRowStats *rowStats;
+   GraphMarks *marks;
+   Vertex *vertex;
    Edge *edge;
-   ULONG numUniqueEdges;
+   ULONG numInstanceVertices;
+   ULONG numInstanceEdges;
+   INDEX *rowEdges;
+   ULONG rowSize;
+   ULONG rowListSize;
+   ULONG numExternalEdges;
+   ULONG v, e, i, w;
+   ULONG edgeIndex;
+   BOOLEAN overlap;
+   double vertexBits;
+   double rowBits;
+   double edgeBits;
+   double externalEdgeBits;
+   double log2SubVertices;
+   ULONG V;  // number of vertices in compressed graph
+   ULONG E;  // number of edges in compressed graph
+   ULONG L;  // number of unique labels
+   ULONG ki; // number of 1s in row i of adjacency matrix
+   ULONG K;  // number of 1s in adjacency matrix
+   ULONG M;  // maximum number of edges between any two vertices
+   ULONG tmpM;
+   RowEdge *rowBuffer = NULL;
+   ULONG rowBufferSize = 0;
+   ULONG *rowCounts;       // number of rows with each number of 1s
+   ULONG rowCountsSize;
+   ULONG *maxEdgesCounts;  // number of unchanged rows with each tmpM
+   ULONG *touchedVertices; // vertices adjacent to an instance
+   ULONG numTouched;
+   ULONG touchedListSize;
+
+   if ((parameters->incremental) || (instanceList == NULL))
+      return FALSE;
+
+   // compute row statistics of uncompressed graph before marking it
+   if (graph->rowStats == NULL)
+      ComputeGraphRowStats(graph);
+   rowStats = graph->rowStats;
+
+   // mark instance vertices and edges in the scratch marks, mapping
+   // vertices to their "SUB" vertex, and check for overlap
+   marks = parameters->graphMarks;
+   ResetGraphMarks(marks, graph);
+   numInstanceVertices = 0;
+   numInstanceEdges = 0;
+   overlap = FALSE;
+   i = 0;
+   instanceListNode = instanceList->head;
+   while ((instanceListNode != NULL) && (! overlap))
+   {
+      instance = instanceListNode->instance;
+      for (v = 0; v < instance->numVertices; v++)
+      {
+         w = instance->vertices[v];
+         if (VERTEX_MARKED(marks, w))
+            overlap = TRUE;
+         MARK_VERTEX(marks, w, TRUE);
+         marks->vertexMap[w] = i;
+         numInstanceVertices++;
+      }
+      for (e = 0; e < instance->numEdges; e++)
+      {
+         MARK_EDGE(marks, instance->edges[e], TRUE);
+         numInstanceEdges++;
+      }
+      i++;
+      instanceListNode = instanceListNode->next;
+   }
+   if ((overlap) || (i != numInstances))
+      return FALSE;
 
-   numUniqueEdges = 0;
-   // look through all edges of vertex v1
-   for (e = 0; e < graph->vertices[v1].numEdges; e++) 
+   V = graph->numVertices - numInstanceVertices + numInstances;
+   E = graph->numEdges - numInstanceEdges;
+   L = numLabels;
+   vertexBits = Log2(V) + (V * Log2(L));
+   edgeBits = E * (1 + Log2(L));
+   M = 0;
+   numExternalEdges = 0;
+   rowCountsSize = rowStats->maxUniqueEdges + 1;
+   rowCounts = (ULONG *) malloc(sizeof(ULONG) * rowCountsSize);
+   maxEdgesCounts =
+      (ULONG *) malloc(sizeof(ULONG) * (rowStats->maxMaxEdges + 1));
+   if ((rowCounts == NULL) || (maxEdgesCounts == NULL))
+      OutOfMemoryError("CompressedGraphDL:rowCounts");
+   memcpy(rowCounts, rowStats->uniqueEdgesCounts,
+          sizeof(ULONG) * rowCountsSize);
+   memcpy(maxEdgesCounts, rowStats->maxEdgesCounts,
+          sizeof(ULONG) * (rowStats->maxMaxEdges + 1));
+   touchedVertices = NULL;
+   numTouched = 0;
+   touchedListSize = 0;
+
+   // rows of "SUB" vertices, whose edges are the unmarked edges incident
+   // on the instance, in increasing edge order
+   rowEdges = NULL;
+   rowListSize = 0;
+   i = 0;
+   instanceListNode = instanceList->head;
+   while (instanceListNode != NULL)
    {
-      edge = & graph->edges[graph->vertices[v1].edges[e]];
-      if (edge->vertex1 == v1)
-         v2 = edge->vertex2;
-      else 
-         v2 = edge->vertex1;
-      // check if edge connected to unique vertex
-      if (((edge->directed) && (edge->vertex1 == v1)) || // out-going edge
-          ((! edge->directed) && (v2 >= v1))) 
+      instance = instanceListNode->instance;
+      rowSize = 0;
+      for (v = 0; v < instance->numVertices; v++)
+      {
+         w = instance->vertices[v];
+         rowCounts[rowStats->uniqueEdges[w]]--;
+         maxEdgesCounts[rowStats->maxEdges[w]]--;
+         vertex = & graph->vertices[w];
+         for (e = 0; e < vertex->numEdges; e++)
+         {
+            edgeIndex = vertex->edges[e];
+            if (! EDGE_MARKED(marks, edgeIndex))
+            {
+               // insert edge index in order, unless already there
+               w = rowSize;
+               while ((w > 0) && (rowEdges[w - 1] > edgeIndex))
+                  w--;
+               if ((w == 0) || (rowEdges[w - 1] != edgeIndex))
+               {
+                  if (rowSize == rowListSize)
+                  {
+                     rowListSize += LIST_SIZE_INC;
+                     rowEdges = (INDEX *) realloc(rowEdges,
+                                                  sizeof(INDEX) * rowListSize);
+                     if (rowEdges == NULL)
+                        OutOfMemoryError("CompressedGraphDL:rowEdges");
+                  }
+                  memmove(& rowEdges[w + 1], & rowEdges[w],
+                          sizeof(INDEX) * (rowSize - w));
+                  rowEdges[w] = edgeIndex;
+                  rowSize++;
+               }
+            }
+         }
+      }
+      CompressedRowStats(graph, marks, rowSize, rowEdges, i, numInstances,
+                         & rowBuffer, & rowBufferSize, & ki, & tmpM);
+      CountRow(& rowCounts, & rowCountsSize, ki);
+      if (tmpM > M)
+         M = tmpM;
+      // count external edge entries and flag neighbors whose rows change
+      for (e = 0; e < rowSize; e++)
       {
-         if (! graph->vertices[v2].used) 
+         edge = & graph->edges[rowEdges[e]];
+         numExternalEdges++;
+         if (CompressedVertexOrder(marks, edge->vertex1, numInstances) ==
+             CompressedVertexOrder(marks, edge->vertex2, numInstances))
+            numExternalEdges++; // self-edge
+         for (w = 0; w < 2; w++)
          {
-            numUniqueEdges++;
-            graph->vertices[v2].used = TRUE;
+            v = (w == 0) ? edge->vertex1 : edge->vertex2;
+            if ((! VERTEX_MARKED(marks, v)) && (! VERTEX_TOUCHED(marks, v)))
+            {
+               TOUCH_VERTEX(marks, v);
+               if (numTouched == touchedListSize)
+               {
+                  touchedListSize += LIST_SIZE_INC;
+                  touchedVertices = (ULONG *) realloc(touchedVertices,
+                                       sizeof(ULONG) * touchedListSize);
+                  if (touchedVertices == NULL)
+                     OutOfMemoryError("CompressedGraphDL:touchedVertices");
+               }
+               touchedVertices[numTouched] = v;
+               numTouched++;
+            }
          }
       }
+      i++;
+      instanceListNode = instanceListNode->next;
    }
-   // reset vertex used flags
-   for (e = 0; e < graph->vertices[v1].numEdges; e++) 
+   free(rowEdges);
+
+   // rows of vertices adjacent to an instance replace their old rows
+   for (i = 0; i < numTouched; i++)
    {
-      edge = & graph->edges[graph->vertices[v1].edges[e]];
-      graph->vertices[edge->vertex1].used = FALSE;
-      graph->vertices[edge->vertex2].used = FALSE;
+      v = touchedVertices[i];
+      vertex = & graph->vertices[v];
+      rowCounts[rowStats->uniqueEdges[v]]--;
+      maxEdgesCounts[rowStats->maxEdges[v]]--;
+      CompressedRowStats(graph, marks, vertex->numEdges, vertex->edges,
+                         (numInstances + v), numInstances,
+                         & rowBuffer, & rowBufferSize, & ki, & tmpM);
+      CountRow(& rowCounts, & rowCountsSize, ki);
+      if (tmpM > M)
+         M = tmpM;
    }
-   return numUniqueEdges;
+   free(touchedVertices);
+   free(rowBuffer);
+
+   // remaining rows are unchanged
+   tmpM = rowStats->maxMaxEdges;
+   while ((tmpM > M) && (maxEdgesCounts[tmpM] == 0))
+      tmpM--;
+   if (tmpM > M)
+      M = tmpM;
+   free(maxEdgesCounts);
+   rowBits = RowCountsBits(V, rowCounts, rowCountsSize, parameters, & K);
+   free(rowCounts);
+   edgeBits += ((K + 1) * Log2(M));
+
+   // add same bits as ExternalEdgeBits(), in the same order
+   log2SubVertices = Log2(subGraph->numVertices);
+   externalEdgeBits = 0.0;
+   for (e = 0; e < numExternalEdges; e++)
+      externalEdgeBits += log2SubVertices;
+
+   *compressedDL = (vertexBits + rowBits + edgeBits);
+   *compressedDL += externalEdgeBits;
+   return TRUE;
 }
 
 
 //---------------------------------------------------------------------------
-// NAME: MaxEdgesToSingleVertex
+// NAME: CountRow
 //
-// INPUTS: (Graph *graph) - graph containing vertex
-//         (ULONG v1) - vertex to look for maximum edges
+// INPUTS: (ULONG **rowCounts) - number of rows with each number of 1s,
+//                               grown as needed
+//         (ULONG *rowCountsSize) - allocated size of *rowCounts
+//         (ULONG ki) - number of 1s in row being counted
 //
-// RETURN: (ULONG) - maximum number of edges from v1 to another vertex
+// RETURN: (void)
 //
-// PURPOSE: Computes the maximum number of edges between v1 and
-// another vertex (including v1 itself).
+// PURPOSE: Adds a row with ki 1s to the counts of rows.
 //---------------------------------------------------------------------------
 
-ULONG MaxEdgesToSingleVertex(Graph *graph, ULONG v1)
+void CountRow(ULONG **rowCounts, ULONG *rowCountsSize, ULONG ki)
 {
-   ULONG maxEdges;
-   ULONG numEdges;
-   ULONG i, j;
-   ULONG v2, v2j;
-   Edge *edge1, *edge2;
+   ULONG i;
+
+   if (ki >= *rowCountsSize)
+   {
+      *rowCounts = (ULONG *) realloc(*rowCounts, sizeof(ULONG) * (ki + 1));
+      if (*rowCounts == NULL)
+         OutOfMemoryError("CountRow:rowCounts");
+      for (i = *rowCountsSize; i <= ki; i++)
+         (*rowCounts)[i] = 0;
+      *rowCountsSize = ki + 1;
+   }
+   (*rowCounts)[ki]++;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: RowCountsBits
+//
+// INPUTS: (ULONG V) - number of vertices in graph
+//         (ULONG *rowCounts) - number of rows with each number of 1s
+//         (ULONG rowCountsSize) - size of rowCounts
+//         (Parameters *parameters)
+//         (ULONG *K) - set to number of 1s in adjacency matrix
+//
+// RETURN: (double) - rowBits of MDL encoding
+//
+// PURPOSE: Computes the rowBits of MDL() from the number of rows with
+// each number of 1s, taking the rows with the same number together
+// and in increasing order of that number.
+//---------------------------------------------------------------------------
+
+double RowCountsBits(ULONG V, ULONG *rowCounts, ULONG rowCountsSize,
+                     Parameters *parameters, ULONG *K)
+{
+   double rowBits;
+   ULONG ki;
+   ULONG B = 0; // maximum number of 1s in a row of the adjacency matrix
+
+   rowBits = V * Log2Factorial(V, parameters);
+   *K = 0;
+   for (ki = 0; ki < rowCountsSize; ki++)
+   {
+      if (rowCounts[ki] > 0)
+      {
+         rowBits -= rowCounts[ki] * (Log2Factorial(ki, parameters) +
+                                     Log2Factorial((V - ki), parameters));
+         B = ki;
+         *K += rowCounts[ki] * ki;
+      }
+   }
+   rowBits += ((V + 1) * Log2(B + 1));
+   return rowBits;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: CompressedRowStats
+//
+// INPUTS: (Graph *graph) - graph containing row
+//         (GraphMarks *marks) - marks with instance vertices marked and
+//                               mapped, or NULL for a row of the graph
+//                               itself
+//         (ULONG numEdges) - number of edges in row
+//         (INDEX *edges) - indices of row's edges, in compressed order
+//         (ULONG row) - compressed vertex order of row's vertex
+//         (ULONG numInstances) - number of "SUB" vertices
+//         (RowEdge **rowBuffer) - scratch array, grown as needed
+//         (ULONG *rowBufferSize) - allocated size of *rowBuffer
+//         (ULONG *numUniqueEdges) - set to number of unique edges of row
+//         (ULONG *maxEdges) - set to maximum number of edges of row to
+//                             a single vertex
+//
+// RETURN: (void)
+//
+// PURPOSE: Computes the adjacency matrix statistics of a row of the
+// compressed graph used by MDL, identifying vertices by their
+// CompressedVertexOrder in place of their compressed graph index.  An
+// edge belongs to the row if it is directed out of the row's vertex,
+// or is undirected and its other vertex is not before the row's (so
+// undirected edges are not counted twice).  The number of unique edges
+// is the number of different vertices the row's edges go to.
+//
+// The row's edges are sorted by other vertex, keeping their order in
+// the row, and each run of edges to the same vertex is scanned once.
+// The maximum number of edges is counted as in the original nested
+// loop: from the first outgoing directed edge to a vertex, the later
+// outgoing directed edges to it; from the first undirected row edge to
+// a vertex, all later edges to it.
+//---------------------------------------------------------------------------
+
+void CompressedRowStats(Graph *graph, GraphMarks *marks, ULONG numEdges,
+                        INDEX *edges, ULONG row, ULONG numInstances,
+                        RowEdge **rowBuffer, ULONG *rowBufferSize,
+                        ULONG *numUniqueEdges, ULONG *maxEdges)
+{
+   RowEdge *rowEdges;
+   Edge *edge;
+   ULONG i, start;
+   ULONG v1;
+   ULONG numOutEdges;
    ULONG numEdgesToVertex2;
+   BOOLEAN undirectedFound;
+
+   *numUniqueEdges = 0;
+   *maxEdges = 0;
+   if (numEdges > *rowBufferSize)
+   {
+      *rowBufferSize = numEdges;
+      *rowBuffer = (RowEdge *) realloc(*rowBuffer,
+                                       sizeof(RowEdge) * numEdges);
+      if (*rowBuffer == NULL)
+         OutOfMemoryError("CompressedRowStats:rowBuffer");
+   }
+   rowEdges = *rowBuffer;
 
-   maxEdges = 0;
-   numEdges = graph->vertices[v1].numEdges;
-   for (i = 0; i < numEdges; i++) 
+   // other vertex of each edge, and whether it is an outgoing edge
+   for (i = 0; i < numEdges; i++)
    {
-      edge1 = & graph->edges[graph->vertices[v1].edges[i]];
-      // get other vertex
-      if (edge1->vertex1 == v1)
-         v2 = edge1->vertex2;
-      else 
-         v2 = edge1->vertex1;
-      if (((edge1->directed) && (edge1->vertex1 == v1)) || // outgoing edge
-          ((! edge1->directed) && (v2 >= v1))) 
+      edge = & graph->edges[edges[i]];
+      v1 = CompressedVertexOrder(marks, edge->vertex1, numInstances);
+      if (v1 == row)
+         rowEdges[i].vertex =
+            CompressedVertexOrder(marks, edge->vertex2, numInstances);
+      else
+         rowEdges[i].vertex = v1;
+      rowEdges[i].position = i;
+      rowEdges[i].outgoing = ((edge->directed) && (v1 == row));
+      rowEdges[i].undirected = (! edge->directed);
+   }
+   qsort(rowEdges, numEdges, sizeof(RowEdge), CompareRowEdges);
+
+   // scan each run of edges to the same vertex
+   start = 0;
+   while (start < numEdges)
+   {
+      numOutEdges = 0;
+      numEdgesToVertex2 = 0;
+      undirectedFound = FALSE;
+      for (i = start; ((i < numEdges) &&
+                       (rowEdges[i].vertex == rowEdges[start].vertex)); i++)
       {
-         // count how many edges to v2
-         numEdgesToVertex2 = 1;
-         for (j = i + 1; j < numEdges; j++) 
-         { //start at i+1 since only want max
-            edge2 = & graph->edges[graph->vertices[v1].edges[j]];
-            if (edge2->vertex1 == v1)
-               v2j = edge2->vertex2;
-            else 
-               v2j = edge2->vertex1;
-            if (v2j == v2) 
-            {
-               // outgoing edge
-               if (((edge2->directed) && (edge2->vertex1 == v1)) ||
-                   ((! edge1->directed) && (v2j >= v1))) 
-               {
-                  numEdgesToVertex2++;
-               }
-            }
+         if (rowEdges[i].outgoing)
+            numOutEdges++;
+         if (undirectedFound)
+            numEdgesToVertex2++;
+         else if ((rowEdges[i].undirected) && (rowEdges[i].vertex >= row))
+         {
+            undirectedFound = TRUE;
+            numEdgesToVertex2 = 1;
          }
-         if (numEdgesToVertex2 > maxEdges)
-            maxEdges = numEdgesToVertex2;
       }
+      if ((numOutEdges > 0) || undirectedFound)
+         (*numUniqueEdges)++;
+      if (numOutEdges > *maxEdges)
+         *maxEdges = numOutEdges;
+      if (numEdgesToVertex2 > *maxEdges)
+         *maxEdges = numEdgesToVertex2;
+      start = i;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: CompareRowEdges
+//
+// INPUTS: (const void *a)
+//         (const void *b) - pointers to RowEdges
+//
+// RETURN: (int) - negative, zero or positive as *a sorts before, with or
+//                 after *b
+//
+// PURPOSE: Comparison function for sorting the edges of a row by other
+// vertex, and then by position in the row.
+//---------------------------------------------------------------------------
+
+int CompareRowEdges(const void *a, const void *b)
+{
+   const RowEdge *x = (const RowEdge *) a;
+   const RowEdge *y = (const RowEdge *) b;
+
+   if (x->vertex != y->vertex)
+      return (x->vertex < y->vertex) ? -1 : 1;
+   if (x->position != y->position)
+      return (x->position < y->position) ? -1 : 1;
+   return 0;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: CompressedVertexOrder
+//
+// INPUTS: (GraphMarks *marks) - marks with instance vertices marked and
+//                               mapped
+//         (ULONG v) - vertex index in graph
+//         (ULONG numInstances) - number of "SUB" vertices
+//
+// RETURN: (ULONG) - value ordered as v's vertex in compressed graph
+//
+// PURPOSE: Returns the index of the "SUB" vertex for an instance
+// vertex, else numInstances+v, which compares with other such values
+// the same way as the vertices' indices in the compressed graph.  With
+// no marks, the graph is not compressed.
+//---------------------------------------------------------------------------
+
+ULONG CompressedVertexOrder(GraphMarks *marks, ULONG v, ULONG numInstances)
+{
+   if ((marks != NULL) && VERTEX_MARKED(marks, v))
+      return marks->vertexMap[v];
+   return numInstances + v;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ComputeGraphRowStats
+//
+// INPUTS: (Graph *graph)
+//
+// RETURN: (void)
+//
+// PURPOSE: Computes and caches the MDL row statistics of every vertex
+// in the graph, and the number of vertices with each statistic, for use
+// by CompressedGraphDL.
+//---------------------------------------------------------------------------
+
+void ComputeGraphRowStats(Graph *graph)
+{
+   GraphRowStats *rowStats;
+   RowEdge *rowBuffer = NULL;
+   ULONG rowBufferSize = 0;
+   ULONG v;
+
+   rowStats = (GraphRowStats *) malloc(sizeof(GraphRowStats));
+   if (rowStats == NULL)
+      OutOfMemoryError("ComputeGraphRowStats:rowStats");
+   rowStats->uniqueEdges =
+      (ULONG *) malloc(sizeof(ULONG) * (graph->numVertices + 1));
+   rowStats->maxEdges =
+      (ULONG *) malloc(sizeof(ULONG) * (graph->numVertices + 1));
+   if ((rowStats->uniqueEdges == NULL) || (rowStats->maxEdges == NULL))
+      OutOfMemoryError("ComputeGraphRowStats:arrays");
+   for (v = 0; v < graph->numVertices; v++)
+      CompressedRowStats(graph, NULL, graph->vertices[v].numEdges,
+                         graph->vertices[v].edges, v, 0,
+                         & rowBuffer, & rowBufferSize,
+                         & rowStats->uniqueEdges[v], & rowStats->maxEdges[v]);
+   free(rowBuffer);
+   rowStats->maxUniqueEdges = 0;
+   rowStats->maxMaxEdges = 0;
+   for (v = 0; v < graph->numVertices; v++)
+   {
+      if (rowStats->uniqueEdges[v] > rowStats->maxUniqueEdges)
+         rowStats->maxUniqueEdges = rowStats->uniqueEdges[v];
+      if (rowStats->maxEdges[v] > rowStats->maxMaxEdges)
+         rowStats->maxMaxEdges = rowStats->maxEdges[v];
+   }
+   rowStats->uniqueEdgesCounts = (ULONG *)
+      calloc(rowStats->maxUniqueEdges + 1, sizeof(ULONG));
+   rowStats->maxEdgesCounts = (ULONG *)
+      calloc(rowStats->maxMaxEdges + 1, sizeof(ULONG));
+   if ((rowStats->uniqueEdgesCounts == NULL) ||
+       (rowStats->maxEdgesCounts == NULL))
+      OutOfMemoryError("ComputeGraphRowStats:counts");
+   for (v = 0; v < graph->numVertices; v++)
+   {
+      rowStats->uniqueEdgesCounts[rowStats->uniqueEdges[v]]++;
+      rowStats->maxEdgesCounts[rowStats->maxEdges[v]]++;
+   }
+   graph->rowStats = rowStats;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FreeGraphRowStats
+//
+// INPUTS: (Graph *graph)
+//
+// RETURN: (void)
+//
+// PURPOSE: Free the graph's cached row statistics, if any.  Must be
+// called whenever the graph's structure changes.
+//---------------------------------------------------------------------------
+
+void FreeGraphRowStats(Graph *graph)
+{
+   if (graph->rowStats != NULL)
+   {
+      free(graph->rowStats->uniqueEdges);
+      free(graph->rowStats->maxEdges);
+      free(graph->rowStats->uniqueEdgesCounts);
+      free(graph->rowStats->maxEdgesCounts);
+      free(graph->rowStats);
+      graph->rowStats = NULL;
    }
-   return maxEdges;
 }
 
 
@@ -601,52 +1074,83 @@ ULONG NegExamplesCovered(Substructure *sub, Parameters *parameters)
 // PURPOSE: Return the number of examples, whose starting vertices are
 // stored in egsVertexIndices, are covered by an instance in
 // instanceList.  Note that one example may contain more than one
-// instance.
+// instance.  Each instance is mapped to its example by a binary search
+// on its first vertex, and the covered examples are kept in a bitset so
+// each is counted once.
 //---------------------------------------------------------------------------
 
 ULONG ExamplesCovered(InstanceList *instanceList, Graph *graph,
                       ULONG numEgs, ULONG *egsVertexIndices, ULONG start)
 {
-   ULONG i;
-   ULONG egStartVertexIndex;
-   ULONG egEndVertexIndex;
-   ULONG instanceVertexIndex;
    InstanceListNode *instanceListNode;
-   BOOLEAN found;
+   ULONG eg;
+   ULONG instanceVertexIndex;
+   ULONG *egsCovered;
+   ULONG bitsPerWord;
    ULONG numEgsCovered;
 
    numEgsCovered = 0;
-   if (instanceList != NULL) 
+   if ((instanceList == NULL) || (numEgs == 0))
+      return numEgsCovered;
+
+   bitsPerWord = sizeof(ULONG) * 8;
+   egsCovered = (ULONG *) calloc(((numEgs + bitsPerWord - 1) / bitsPerWord),
+                                 sizeof(ULONG));
+   if (egsCovered == NULL)
+      OutOfMemoryError("ExamplesCovered:egsCovered");
+   instanceListNode = instanceList->head;
+   while (instanceListNode != NULL)
    {
-      // for each example, look for a covering instance
-      for (i = 0; i < numEgs; i++)
+      // can check any instance vertex, so use the first
+      instanceVertexIndex = instanceListNode->instance->vertices[0];
+      eg = ExampleContainingVertex(instanceVertexIndex, numEgs,
+                                   egsVertexIndices);
+      if ((eg < numEgs) && (egsVertexIndices[eg] >= start) &&
+          (! (egsCovered[eg / bitsPerWord] & (1UL << (eg % bitsPerWord)))))
       {
-         // find example's starting and ending vertex indices
-         egStartVertexIndex = egsVertexIndices[i];
-         if (egStartVertexIndex >= start)
-         {
-            if (i < (numEgs - 1))
-               egEndVertexIndex = egsVertexIndices[i + 1] - 1;
-            else
-               egEndVertexIndex = graph->numVertices - 1;
-            // look for an instance whose vertices are in range
-            instanceListNode = instanceList->head;
-            found = FALSE;
-            while ((instanceListNode != NULL) && (! found))
-            {
-               // can check any instance vertex, so use the first
-               instanceVertexIndex = instanceListNode->instance->vertices[0];
-               if ((instanceVertexIndex >= egStartVertexIndex) &&
-                   (instanceVertexIndex <= egEndVertexIndex))
-               {
-                  // found an instance covering this example
-                  numEgsCovered++;
-                  found = TRUE;
-               }
-               instanceListNode = instanceListNode->next;
-            }
-         }
+         // first instance found covering this example
+         egsCovered[eg / bitsPerWord] |= (1UL << (eg % bitsPerWord));
+         numEgsCovered++;
       }
+      instanceListNode = instanceListNode->next;
    }
+   free(egsCovered);
    return numEgsCovered;
 }
+
+
+//---------------------------------------------------------------------------
+// NAME: ExampleContainingVertex
+//
+// INPUTS: (ULONG v) - vertex index
+//         (ULONG numEgs) - number of examples
+//         (ULONG *egsVertexIndices) - vertex indices of each examples
+//           starting vertex, in increasing order
+//
+// RETURN: (ULONG) - index of example containing v, or numEgs if v is
+//                   before the first example
+//
+// PURPOSE: Binary search for the last example starting at or before
+// vertex v.  Each example runs up to the vertex before the next
+// example's starting vertex, and the last up to the end of the graph.
+//---------------------------------------------------------------------------
+
+ULONG ExampleContainingVertex(ULONG v, ULONG numEgs, ULONG *egsVertexIndices)
+{
+   ULONG low = 0;
+   ULONG high = numEgs;
+   ULONG mid;
+
+   // find first example starting after v
+   while (low < high)
+   {
+      mid = low + ((high - low) / 2);
+      if (egsVertexIndices[mid] <= v)
+         low = mid + 1;
+      else
+         high = mid;
+   }
+   if (low == 0)
+      return numEgs;
+   return (low - 1);
+}
@@ -32,22 +32,38 @@ SubList *ExtendSub(Substructure *sub, Parameters *parameters)
    InstanceList *negInstanceList;
    InstanceList *newInstanceList;
    InstanceListNode *newInstanceListNode;
+   InstanceList *candidates;
    Instance *newInstance;
    Substructure *newSub;
    SubList *extendedSubs;
    SubListNode *newSubListNode = NULL;
    ULONG newInstanceListIndex = 0;
+   InstanceBuckets *posBuckets = NULL;
+   InstanceBuckets *negBuckets = NULL;
+   ULONG signature;
+   ULONG code;
 
    // parameters used
    Graph *posGraph = parameters->posGraph;
    Graph *negGraph = parameters->negGraph;
    LabelList *labelList = parameters->labelList;
+   double threshold = parameters->threshold;
 
    extendedSubs = AllocateSubList();
-   newInstanceList = ExtendInstances(sub->instances, posGraph);
+   IndexSubList(extendedSubs);
+   newInstanceList = ExtendInstances(sub->instances, posGraph, parameters);
    negInstanceList = NULL;
    if (negGraph != NULL)
-      negInstanceList = ExtendInstances(sub->negInstances, negGraph);
+      negInstanceList = ExtendInstances(sub->negInstances, negGraph,
+                                        parameters);
+   // for exact matching, group the instances so that each new sub only
+   // considers instances that can match it
+   if (threshold == 0.0)
+   {
+      posBuckets = BucketInstances(newInstanceList, posGraph);
+      if (negInstanceList != NULL)
+         negBuckets = BucketInstances(negInstanceList, negGraph);
+   }
    newInstanceListNode = newInstanceList->head;
    while (newInstanceListNode != NULL) 
    {
@@ -58,24 +74,52 @@ SubList *ExtendSub(Substructure *sub, Parameters *parameters)
          // previously-generated sub, so a sub created from this instance
          // would be a duplicate of one already on the extendedSubs list
          newSub = CreateSubFromInstance(newInstance, posGraph);
+         if (posBuckets != NULL)
+            newSub->definitionCode = posBuckets->codes[newInstanceListIndex];
          if (! MemberOfSubList(newSub, extendedSubs, labelList)) 
          {
-            AddPosInstancesToSub(newSub, newInstance, newInstanceList, 
-                                  parameters,newInstanceListIndex);
-            if (negInstanceList != NULL)
-               AddNegInstancesToSub(newSub, newInstance, negInstanceList, 
-                                     parameters);
+            if (posBuckets != NULL)
+            {
+               signature = posBuckets->signatures[newInstanceListIndex];
+               code = posBuckets->codes[newInstanceListIndex];
+               // candidates start with newInstance itself, i.e., index 0
+               candidates = CandidateInstances(posBuckets, signature, code,
+                                               newInstanceListIndex);
+               AddPosInstancesToSub(newSub, newInstance, candidates,
+                                    parameters, 0);
+               FreeInstanceList(candidates);
+               if (negBuckets != NULL)
+               {
+                  candidates = CandidateInstances(negBuckets, signature, code,
+                                                  0);
+                  AddNegInstancesToSub(newSub, newInstance, candidates,
+                                       parameters);
+                  FreeInstanceList(candidates);
+               }
+            }
+            else
+            {
+               AddPosInstancesToSub(newSub, newInstance, newInstanceList, 
+                                     parameters,newInstanceListIndex);
+               if (negInstanceList != NULL)
+                  AddNegInstancesToSub(newSub, newInstance, negInstanceList, 
+                                        parameters);
+            }
             // add newSub to head of extendedSubs list
             newSubListNode = AllocateSubListNode(newSub);
             newSubListNode->next = extendedSubs->head;
             extendedSubs->head = newSubListNode;
+            AddSubToIndex(newSubListNode, extendedSubs);
          } else FreeSub(newSub);
       }
       newInstanceListNode = newInstanceListNode->next;
       newInstanceListIndex++;
    }
+   FreeInstanceBuckets(posBuckets);
+   FreeInstanceBuckets(negBuckets);
    FreeInstanceList(negInstanceList);
    FreeInstanceList(newInstanceList);
+   UnindexSubList(extendedSubs);
    return extendedSubs;
 }
 
@@ -85,15 +129,19 @@ SubList *ExtendSub(Substructure *sub, Parameters *parameters)
 //
 // INPUTS: (InstanceList *instanceList) - instances to be extended
 //         (Graph *graph) - graph containing substructure instances
+//         (Parameters *parameters)
 //
 // RETURN: (InstanceList *) - list of extended instances
 //
 // PURPOSE: Create and return a list of new instances by extending the
 // given substructure's instances by one edge (or edge and new vertex)
-// in all possible ways based on given graph.
+// in all possible ways based on given graph.  Each instance's edges are
+// marked in the scratch marks, which are simply cleared for the next
+// instance.
 //---------------------------------------------------------------------------
 
-InstanceList *ExtendInstances(InstanceList *instanceList, Graph *graph)
+InstanceList *ExtendInstances(InstanceList *instanceList, Graph *graph,
+                              Parameters *parameters)
 {
    InstanceList *newInstanceList;
    InstanceListNode *instanceListNode;
@@ -102,33 +150,41 @@ InstanceList *ExtendInstances(InstanceList *instanceList, Graph *graph)
    ULONG v;
    ULONG e;
    Vertex *vertex;
-   Edge *edge;
+   InstanceSet *instanceSet;
+
+   // parameters used
+   GraphMarks *marks = parameters->graphMarks;
 
    newInstanceList = AllocateInstanceList();
+   instanceSet = AllocateInstanceSet(LIST_SIZE_INC);
    instanceListNode = instanceList->head;
    while (instanceListNode != NULL) 
    {
       instance = instanceListNode->instance;
-      MarkInstanceEdges(instance, graph, TRUE);
+      ResetGraphMarks(marks, graph);
+      MarkInstanceEdges(instance, marks, TRUE);
       for (v = 0; v < instance->numVertices; v++) 
       {
          vertex = & graph->vertices[instance->vertices[v]];
          for (e = 0; e < vertex->numEdges; e++) 
          {
-            edge = & graph->edges[vertex->edges[e]];
-            if (! edge->used) 
+            if (! EDGE_MARKED(marks, vertex->edges[e])) 
             {
                // add new instance to list
                newInstance =
                   CreateExtendedInstance(instance, instance->vertices[v],
                                          vertex->edges[e], graph);
-               InstanceListInsert(newInstance, newInstanceList, TRUE);
+               // instance set rejects duplicates without scanning the list
+               if (InstanceSetInsert(newInstance, instanceSet))
+                  InstanceListInsert(newInstance, newInstanceList, FALSE);
+               else
+                  FreeInstance(newInstance);
             }
          }
       }
-      MarkInstanceEdges(instance, graph, FALSE);
       instanceListNode = instanceListNode->next;
    }
+   FreeInstanceSet(instanceSet);
    return newInstanceList;
 }
 
@@ -278,7 +334,9 @@ Substructure *CreateSubFromInstance(Instance *instance, Graph *graph)
 // PURPOSE: Add instance from instanceList to sub's positive
 // instances if the instance matches sub's definition.  If
 // allowInstanceOverlap=FALSE, then instances added only if they do
-// not overlap with existing instances.
+// not overlap with existing instances.  The vertices of the added
+// instances are kept marked in the scratch graph marks, so each
+// overlap test costs only the size of the candidate instance.
 //---------------------------------------------------------------------------
 void AddPosInstancesToSub(Substructure *sub, Instance *subInstance,
                            InstanceList *instanceList, Parameters *parameters,
@@ -296,6 +354,8 @@ void AddPosInstancesToSub(Substructure *sub, Instance *subInstance,
    LabelList *labelList         = parameters->labelList;
    BOOLEAN allowInstanceOverlap = parameters->allowInstanceOverlap;
    double threshold             = parameters->threshold;
+   ULONG matchMethod            = parameters->matchMethod;
+   GraphMarks *marks            = parameters->graphMarks;
 
    // collect positive instances of substructure
    if (instanceList != NULL) 
@@ -308,6 +368,11 @@ void AddPosInstancesToSub(Substructure *sub, Instance *subInstance,
       subInstance->used = TRUE;
       InstanceListInsert(subInstance, sub->instances, FALSE);
       sub->numInstances++;
+      if (! allowInstanceOverlap)
+      {
+         ResetGraphMarks(marks, posGraph);
+         MarkInstanceVertices(subInstance, marks, TRUE);
+      }
       instanceListNode = instanceList->head;
       while (instanceListNode != NULL) 
       {
@@ -315,7 +380,7 @@ void AddPosInstancesToSub(Substructure *sub, Instance *subInstance,
          {
             instance = instanceListNode->instance;
             if (allowInstanceOverlap ||
-               (! InstanceListOverlap(instance, sub->instances))) 
+               (! MarkedInstanceOverlap(instance, marks))) 
             {
                thresholdLimit = threshold *
                                 (instance->numVertices + instance->numEdges);
@@ -346,18 +411,23 @@ void AddPosInstancesToSub(Substructure *sub, Instance *subInstance,
                         instance->used = TRUE;
                         InstanceListInsert(instance, sub->instances, FALSE);
                         sub->numInstances++;
+                        if (! allowInstanceOverlap)
+                           MarkInstanceVertices(instance, marks, TRUE);
                      }
                   }
                }
                else
                {
                   if (GraphMatch(sub->definition, instanceGraph, labelList,
-                                 thresholdLimit, & matchCost, NULL))
+                                 thresholdLimit, matchMethod, & matchCost,
+                                 NULL))
                   {
                      if (matchCost < instance->minMatchCost)
                         instance->minMatchCost = matchCost;
                      InstanceListInsert(instance, sub->instances, FALSE);
                      sub->numInstances++;
+                     if (! allowInstanceOverlap)
+                        MarkInstanceVertices(instance, marks, TRUE);
                   }
                }
                FreeGraph(instanceGraph);
@@ -385,7 +455,7 @@ void AddPosInstancesToSub(Substructure *sub, Instance *subInstance,
 // PURPOSE: Add instance from instanceList to sub's negative
 // instances if the instance matches sub's definition.  If
 // allowInstanceOverlap=FALSE, then instances added only if they do
-// not overlap with existing instances.
+// not overlap with existing instances, as in AddPosInstancesToSub.
 //---------------------------------------------------------------------------
 void AddNegInstancesToSub(Substructure *sub, Instance *subInstance,
                            InstanceList *instanceList, Parameters *parameters)
@@ -401,11 +471,15 @@ void AddNegInstancesToSub(Substructure *sub, Instance *subInstance,
    LabelList *labelList         = parameters->labelList;
    BOOLEAN allowInstanceOverlap = parameters->allowInstanceOverlap;
    double threshold             = parameters->threshold;
+   ULONG matchMethod            = parameters->matchMethod;
+   GraphMarks *marks            = parameters->graphMarks;
 
    // collect negative instances of substructure
    if (instanceList != NULL) 
    {
       sub->negInstances = AllocateInstanceList();
+      if (! allowInstanceOverlap)
+         ResetGraphMarks(marks, negGraph);
       instanceListNode = instanceList->head;
       while (instanceListNode != NULL) 
       {
@@ -413,7 +487,7 @@ void AddNegInstancesToSub(Substructure *sub, Instance *subInstance,
          {
             instance = instanceListNode->instance;
             if (allowInstanceOverlap ||
-                (! InstanceListOverlap(instance, sub->negInstances))) 
+                (! MarkedInstanceOverlap(instance, marks))) 
             {
                thresholdLimit = threshold *
                                 (instance->numVertices + instance->numEdges);
@@ -437,18 +511,23 @@ void AddNegInstancesToSub(Substructure *sub, Instance *subInstance,
                         instance->used = TRUE;
                         InstanceListInsert(instance, sub->negInstances, FALSE);
                         sub->numNegInstances++;
+                        if (! allowInstanceOverlap)
+                           MarkInstanceVertices(instance, marks, TRUE);
                      }
                   }
                } 
                else 
                {
                   if (GraphMatch(sub->definition, instanceGraph, labelList,
-                                 thresholdLimit, & matchCost, NULL))
+                                 thresholdLimit, matchMethod, & matchCost,
+                                 NULL))
                   {
                      if (matchCost < instance->minMatchCost)
                         instance->minMatchCost = matchCost;
                      InstanceListInsert(instance, sub->negInstances, FALSE);
                      sub->numNegInstances++;
+                     if (! allowInstanceOverlap)
+                        MarkInstanceVertices(instance, marks, TRUE);
                   }
                }
                FreeGraph(instanceGraph);
@@ -460,6 +539,292 @@ void AddNegInstancesToSub(Substructure *sub, Instance *subInstance,
 }
 
 
+//---------------------------------------------------------------------------
+// NAME: ExtensionSignature
+//
+// INPUTS: (Instance *instance) - extended instance
+//         (Graph *graph) - graph containing instance
+//
+// RETURN: (ULONG) - signature of instance's extension
+//
+// PURPOSE: Returns a value combining the label and directedness of the
+// instance's new edge and the label of its new vertex, if any.  These
+// are the properties compared by the simple test in NewEdgeMatch, so
+// two instances can pass that test only if their signatures are equal.
+//---------------------------------------------------------------------------
+
+ULONG ExtensionSignature(Instance *instance, Graph *graph)
+{
+   Edge *edge;
+   ULONG signature;
+
+   edge = & graph->edges[instance->edges[instance->newEdge]];
+   signature = MixCode((edge->label * 2) + (edge->directed ? 1 : 0));
+   if (instance->newVertex != VERTEX_UNMAPPED)
+      signature = MixCode(signature +
+         MixCode(graph->vertices[instance->vertices[instance->newVertex]].label
+                 + 1));
+   return signature;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: BucketInstances
+//
+// INPUTS: (InstanceList *instanceList) - extended instances
+//         (Graph *graph) - graph containing instances
+//
+// RETURN: (InstanceBuckets *) - instances grouped by signature and code
+//
+// PURPOSE: Groups the instances by their ExtensionSignature and by the
+// GraphCode of their graph.  At threshold 0.0, NewEdgeMatch accepts an
+// instance either by its simple test, which requires equal signatures,
+// or by an exact GraphMatch, which requires equal codes.  So the only
+// instances that can match a substructure created from an instance are
+// those sharing its signature or its code.
+//---------------------------------------------------------------------------
+
+InstanceBuckets *BucketInstances(InstanceList *instanceList, Graph *graph)
+{
+   InstanceBuckets *buckets;
+   InstanceListNode *instanceListNode;
+   Graph *instanceGraph;
+   ULONG numInstances;
+   ULONG i;
+
+   numInstances = 0;
+   instanceListNode = instanceList->head;
+   while (instanceListNode != NULL)
+   {
+      numInstances++;
+      instanceListNode = instanceListNode->next;
+   }
+
+   buckets = (InstanceBuckets *) malloc(sizeof(InstanceBuckets));
+   if (buckets == NULL)
+      OutOfMemoryError("BucketInstances:buckets");
+   buckets->numInstances = numInstances;
+   buckets->tableSize = numInstances + 1;
+   buckets->instances =
+      (Instance **) malloc(sizeof(Instance *) * (numInstances + 1));
+   buckets->signatures = (ULONG *) malloc(sizeof(ULONG) * (numInstances + 1));
+   buckets->codes = (ULONG *) malloc(sizeof(ULONG) * (numInstances + 1));
+   buckets->signatureTable = (InstanceBucket **)
+      malloc(sizeof(InstanceBucket *) * buckets->tableSize);
+   buckets->codeTable = (InstanceBucket **)
+      malloc(sizeof(InstanceBucket *) * buckets->tableSize);
+   if ((buckets->instances == NULL) || (buckets->signatures == NULL) ||
+       (buckets->codes == NULL) || (buckets->signatureTable == NULL) ||
+       (buckets->codeTable == NULL))
+      OutOfMemoryError("BucketInstances:arrays");
+   for (i = 0; i < buckets->tableSize; i++)
+   {
+      buckets->signatureTable[i] = NULL;
+      buckets->codeTable[i] = NULL;
+   }
+
+   i = 0;
+   instanceListNode = instanceList->head;
+   while (instanceListNode != NULL)
+   {
+      buckets->instances[i] = instanceListNode->instance;
+      buckets->signatures[i] =
+         ExtensionSignature(instanceListNode->instance, graph);
+      instanceGraph = InstanceToGraph(instanceListNode->instance, graph);
+      buckets->codes[i] = GraphCode(instanceGraph);
+      FreeGraph(instanceGraph);
+      AddToInstanceBucket(buckets->signatureTable, buckets->tableSize,
+                          buckets->signatures[i], i);
+      AddToInstanceBucket(buckets->codeTable, buckets->tableSize,
+                          buckets->codes[i], i);
+      i++;
+      instanceListNode = instanceListNode->next;
+   }
+   return buckets;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: AddToInstanceBucket
+//
+// INPUTS: (InstanceBucket **table) - hash table of buckets
+//         (ULONG tableSize) - number of chains in table
+//         (ULONG key) - key of bucket to add to
+//         (ULONG position) - position of instance in instance list
+//
+// RETURN: (void)
+//
+// PURPOSE: Appends the position to the bucket with the given key,
+// creating the bucket if necessary.  Positions must be added in
+// increasing order.
+//---------------------------------------------------------------------------
+
+void AddToInstanceBucket(InstanceBucket **table, ULONG tableSize,
+                         ULONG key, ULONG position)
+{
+   InstanceBucket *bucket;
+
+   bucket = GetInstanceBucket(table, tableSize, key);
+   if (bucket == NULL)
+   {
+      bucket = (InstanceBucket *) malloc(sizeof(InstanceBucket));
+      if (bucket == NULL)
+         OutOfMemoryError("AddToInstanceBucket:bucket");
+      bucket->key = key;
+      bucket->numInstances = 0;
+      bucket->size = 0;
+      bucket->positions = NULL;
+      bucket->next = table[key % tableSize];
+      table[key % tableSize] = bucket;
+   }
+   if (bucket->numInstances == bucket->size)
+   {
+      bucket->size += LIST_SIZE_INC;
+      bucket->positions = (ULONG *) realloc(bucket->positions,
+                                            sizeof(ULONG) * bucket->size);
+      if (bucket->positions == NULL)
+         OutOfMemoryError("AddToInstanceBucket:positions");
+   }
+   bucket->positions[bucket->numInstances] = position;
+   bucket->numInstances++;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: GetInstanceBucket
+//
+// INPUTS: (InstanceBucket **table) - hash table of buckets
+//         (ULONG tableSize) - number of chains in table
+//         (ULONG key) - key of bucket
+//
+// RETURN: (InstanceBucket *) - bucket with given key, or NULL
+//
+// PURPOSE: Look up the bucket with the given key.
+//---------------------------------------------------------------------------
+
+InstanceBucket *GetInstanceBucket(InstanceBucket **table, ULONG tableSize,
+                                  ULONG key)
+{
+   InstanceBucket *bucket;
+
+   bucket = table[key % tableSize];
+   while ((bucket != NULL) && (bucket->key != key))
+      bucket = bucket->next;
+   return bucket;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: CandidateInstances
+//
+// INPUTS: (InstanceBuckets *buckets) - grouped instances
+//         (ULONG signature) - extension signature of substructure instance
+//         (ULONG code) - GraphCode of substructure definition
+//         (ULONG start) - first position in instance list to consider
+//
+// RETURN: (InstanceList *) - instances that may match the substructure
+//
+// PURPOSE: Returns a new list of the instances, at or after the given
+// position, whose signature or code equals the given ones.  The
+// instances are in the same order as in the original instance list.
+//---------------------------------------------------------------------------
+
+InstanceList *CandidateInstances(InstanceBuckets *buckets, ULONG signature,
+                                 ULONG code, ULONG start)
+{
+   InstanceList *candidates;
+   InstanceListNode *instanceListNode;
+   InstanceListNode *tail = NULL;
+   InstanceBucket *signatureBucket;
+   InstanceBucket *codeBucket;
+   ULONG i, j;
+   ULONG nextSignature, nextCode;
+   ULONG position;
+
+   candidates = AllocateInstanceList();
+   signatureBucket =
+      GetInstanceBucket(buckets->signatureTable, buckets->tableSize, signature);
+   codeBucket = GetInstanceBucket(buckets->codeTable, buckets->tableSize, code);
+   // merge the two buckets' increasing positions
+   i = 0;
+   j = 0;
+   do
+   {
+      nextSignature = MAX_UNSIGNED_LONG;
+      if ((signatureBucket != NULL) && (i < signatureBucket->numInstances))
+         nextSignature = signatureBucket->positions[i];
+      nextCode = MAX_UNSIGNED_LONG;
+      if ((codeBucket != NULL) && (j < codeBucket->numInstances))
+         nextCode = codeBucket->positions[j];
+      position = nextSignature;
+      if (nextCode < position)
+         position = nextCode;
+      if (nextSignature == position)
+         i++;
+      if (nextCode == position)
+         j++;
+      if ((position != MAX_UNSIGNED_LONG) && (position >= start))
+      {
+         instanceListNode =
+            AllocateInstanceListNode(buckets->instances[position]);
+         if (tail == NULL)
+            candidates->head = instanceListNode;
+         else
+            tail->next = instanceListNode;
+         tail = instanceListNode;
+      }
+   } while (position != MAX_UNSIGNED_LONG);
+   return candidates;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FreeInstanceBuckets
+//
+// INPUTS: (InstanceBuckets *buckets)
+//
+// RETURN: (void)
+//
+// PURPOSE: Free memory of grouped instances, but not the instances.
+//---------------------------------------------------------------------------
+
+void FreeInstanceBuckets(InstanceBuckets *buckets)
+{
+   InstanceBucket *bucket;
+   InstanceBucket *nextBucket;
+   ULONG i;
+
+   if (buckets != NULL)
+   {
+      for (i = 0; i < buckets->tableSize; i++)
+      {
+         bucket = buckets->signatureTable[i];
+         while (bucket != NULL)
+         {
+            nextBucket = bucket->next;
+            free(bucket->positions);
+            free(bucket);
+            bucket = nextBucket;
+         }
+         bucket = buckets->codeTable[i];
+         while (bucket != NULL)
+         {
+            nextBucket = bucket->next;
+            free(bucket->positions);
+            free(bucket);
+            bucket = nextBucket;
+         }
+      }
+      free(buckets->signatureTable);
+      free(buckets->codeTable);
+      free(buckets->instances);
+      free(buckets->signatures);
+      free(buckets->codes);
+      free(buckets);
+   }
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: RecursifySub
 //
@@ -492,6 +857,7 @@ Substructure *RecursifySub(Substructure *sub, Parameters *parameters)
    ULONG e;
    Edge *edge;
    BOOLEAN foundPair;
+   GraphMarks *marks;
 
    // parameters used
    Graph *graph = parameters->posGraph;
@@ -501,12 +867,13 @@ Substructure *RecursifySub(Substructure *sub, Parameters *parameters)
    for (i = 0; i < labelList->numLabels; i++)
       labelList->labels[i].used = FALSE;
 
-   // mark all instance edges
+   // mark all instance edges (MakeRecursiveSub relies on these marks)
+   marks = GetGraphMarks(graph, parameters);
    instanceListNode1 = sub->instances->head;
    while (instanceListNode1 != NULL) 
    {
       instance1 = instanceListNode1->instance;
-      MarkInstanceEdges(instance1, graph, TRUE);
+      MarkInstanceEdges(instance1, marks, TRUE);
       instanceListNode1 = instanceListNode1->next;
    }
 
@@ -521,7 +888,8 @@ Substructure *RecursifySub(Substructure *sub, Parameters *parameters)
          for (e = 0; e < vertex1->numEdges; e++) 
          {
             edge = & graph->edges[vertex1->edges[e]];
-            if ((! edge->used) && (! labelList->labels[edge->label].used)) 
+            if ((! EDGE_MARKED(marks, vertex1->edges[e])) &&
+                (! labelList->labels[edge->label].used)) 
             {
                // search instance list for another instance involving edge
                v2Index = edge->vertex2;
@@ -562,7 +930,7 @@ Substructure *RecursifySub(Substructure *sub, Parameters *parameters)
    while (instanceListNode1 != NULL) 
    {
       instance1 = instanceListNode1->instance;
-      MarkInstanceEdges(instance1, graph, FALSE);
+      MarkInstanceEdges(instance1, marks, FALSE);
       instanceListNode1 = instanceListNode1->next;
    }
 
@@ -601,14 +969,15 @@ Substructure *MakeRecursiveSub(Substructure *sub, ULONG edgeLabel,
    recursiveSub->recursive = TRUE;
    recursiveSub->recursiveEdgeLabel = edgeLabel;
    recursiveSub->instances =
-       GetRecursiveInstances(posGraph, sub->instances, sub->numInstances,
-                             edgeLabel);
+       GetRecursiveInstances(posGraph, GetGraphMarks(posGraph, parameters),
+                             sub->instances, sub->numInstances, edgeLabel);
    recursiveSub->numInstances = CountInstances(recursiveSub->instances);
    if (negGraph != NULL) 
    {
       recursiveSub->negInstances =
-         GetRecursiveInstances(negGraph, sub->negInstances,
-                               sub->numNegInstances, edgeLabel);
+         GetRecursiveInstances(negGraph, GetGraphMarks(negGraph, parameters),
+                               sub->negInstances, sub->numNegInstances,
+                               edgeLabel);
       recursiveSub->numNegInstances =
          CountInstances(recursiveSub->negInstances);
    }
@@ -621,6 +990,7 @@ Substructure *MakeRecursiveSub(Substructure *sub, ULONG edgeLabel,
 // NAME: GetRecursiveInstances
 //
 // INPUTS: (Graph *graph) - graph in which to look for instances
+//         (GraphMarks *marks) - marks on graph
 //         (InstanceList *instances) - instances in which to look for pairs
 //                connected by an edge of the given label
 //         (ULONG numInstances) - number of instances given
@@ -632,13 +1002,14 @@ Substructure *MakeRecursiveSub(Substructure *sub, ULONG edgeLabel,
 // PURPOSE: Builds and returns a new instance list, where each new instance
 // may contain one or more of the original instances connected by edges
 // with the given edge label.  NOTE: assumes instances' edges have already
-// been marked as used.
+// been marked.
 //
 // ***** TODO: Ensure that connecting edge starts at the same vertex in
 // each pair of instances.
 //---------------------------------------------------------------------------
 
-InstanceList *GetRecursiveInstances(Graph *graph, InstanceList *instances,
+InstanceList *GetRecursiveInstances(Graph *graph, GraphMarks *marks,
+                                    InstanceList *instances,
                                     ULONG numInstances, ULONG recEdgeLabel)
 {
    Instance **instanceMap;
@@ -680,7 +1051,8 @@ InstanceList *GetRecursiveInstances(Graph *graph, InstanceList *instances,
          for (e = 0; e < vertex1->numEdges; e++) 
          {
             edge = & graph->edges[vertex1->edges[e]];
-            if ((! edge->used) && (edge->label == recEdgeLabel)) 
+            if ((! EDGE_MARKED(marks, vertex1->edges[e])) &&
+                (edge->label == recEdgeLabel)) 
             {
                // search instance list for another instance involving edge
                v2Index = edge->vertex2;
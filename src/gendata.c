@@ -164,6 +164,7 @@ BOOLEAN ReadIncrement(char *filename, Parameters *parameters,
    Graph *negGraph;
    Graph *graph;
    FILE *graphFile;
+   Decompressor *decompressor;
    LabelList *labelList;
    char token[TOKEN_LEN];
    ULONG lineNo;             // Line number counter for graph file
@@ -184,7 +185,7 @@ BOOLEAN ReadIncrement(char *filename, Parameters *parameters,
    startVertex = startPosVertex;
  
    // Open graph file
-   graphFile = fopen(filename,"r");
+   graphFile = OpenInputStream(filename, & decompressor);
    if (graphFile == NULL)
    {
       printf("End of Input.\n");
@@ -241,7 +242,7 @@ BOOLEAN ReadIncrement(char *filename, Parameters *parameters,
          ReadIncrementEdge(graph, graphFile, labelList, &lineNo, TRUE, startVertex, vertexOffset);
       else
       {
-         fclose(graphFile);
+         CloseInputStream(graphFile, decompressor);
          FreeGraph(posGraph);
          FreeGraph(negGraph);
          fprintf(stderr, "Unknown token %s in line %lu of graph file %s.\n",
@@ -249,7 +250,7 @@ BOOLEAN ReadIncrement(char *filename, Parameters *parameters,
          exit(1);
       }
    }
-   fclose(graphFile);
+   CloseInputStream(graphFile, decompressor);
    parameters->numPosEgs = numPosExamples;
    parameters->numNegEgs = numNegExamples;
    parameters->posEgsVertexIndices = posVertexIndices;
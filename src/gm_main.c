@@ -3,13 +3,14 @@
 //
 // Main function for standalone graph matcher.
 //
-// Usage: gm g1 g2
+// Usage: gm [-match #] g1 g2
 //
 // The inexact graph match program computes the cost of transforming
 // the larger of the input graphs into the smaller according to the
 // transformation costs defined in subdue.h.  The program returns this
 // cost and the mapping of vertices in the larger graph to vertices in
-// the smaller graph.
+// the smaller graph.  With -match 2, the mapping is found by the faster
+// approximate bipartite matcher instead of the default search (1).
 //
 // Subdue 5
 //---------------------------------------------------------------------------
@@ -30,7 +31,7 @@ void PrintMapping(VertexMap *, ULONG);
 //
 // PURPOSE: Main function for standalone graph matcher.  Takes two
 // command-line arguments, which are the graph file names containing
-// the graphs to be matched.
+// the graphs to be matched, optionally preceded by the -match option.
 //---------------------------------------------------------------------------
 
 int main(int argc, char **argv)
@@ -41,27 +42,48 @@ int main(int argc, char **argv)
    ULONG maxVertices;
    VertexMap *mapping;
    double matchCost;
+   ULONG matchMethod = MATCH_SEARCH;
 
-   if (argc != 3) 
+   if ((argc == 5) && (strcmp(argv[1], "-match") == 0))
    {
-      fprintf(stderr, "usage: %s <graph file> <graph file>\n", argv[0]);
+      sscanf(argv[2], "%lu", &matchMethod);
+      if ((matchMethod < 1) || (matchMethod > 2))
+      {
+         fprintf(stderr, "%s: match must be 1-2\n", argv[0]);
+         exit(1);
+      }
+   }
+   else if (argc != 3) 
+   {
+      fprintf(stderr, "usage: %s [-match #] <graph file> <graph file>\n",
+              argv[0]);
       exit(1);
    }
    labelList = AllocateLabelList();
-   g1 = ReadGraph(argv[1], labelList, directed);
-   g2 = ReadGraph(argv[2], labelList, directed);
+   g1 = ReadGraph(argv[argc - 2], labelList, directed);
+   g2 = ReadGraph(argv[argc - 1], labelList, directed);
 
    if (g1->numVertices < g2->numVertices) 
    {
       maxVertices = g2->numVertices;
       mapping = (VertexMap *) malloc(sizeof(VertexMap) * maxVertices);
-      matchCost = InexactGraphMatch(g2, g1, labelList, MAX_DOUBLE, mapping);
+      if (matchMethod == MATCH_BIPARTITE)
+         matchCost = BipartiteGraphMatch(g2, g1, labelList, mapping,
+                                         GetMatchWorkspace());
+      else
+         matchCost = InexactGraphMatch(g2, g1, labelList, MAX_DOUBLE,
+                                       mapping, GetMatchWorkspace());
    } 
    else 
    {
       maxVertices = g1->numVertices;
       mapping = (VertexMap *) malloc(sizeof(VertexMap) * maxVertices);
-      matchCost = InexactGraphMatch(g1, g2, labelList, MAX_DOUBLE, mapping);
+      if (matchMethod == MATCH_BIPARTITE)
+         matchCost = BipartiteGraphMatch(g1, g2, labelList, mapping,
+                                         GetMatchWorkspace());
+      else
+         matchCost = InexactGraphMatch(g1, g2, labelList, MAX_DOUBLE,
+                                       mapping, GetMatchWorkspace());
    }
 
    printf("Match Cost = %f\n", matchCost);
@@ -219,7 +219,7 @@ void WritePrunedGraph(Graph *g, FILE *outFile, LabelList *labelList)
    for (v = 0; v < g->numVertices; v++)
       if (g->vertices[v].used == TRUE) 
       {
-         fprintf(outFile, "v %lu ", (g->vertices[v].map + 1));
+         fprintf(outFile, "v %lu ", ((ULONG) g->vertices[v].map + 1));
          WriteLabelToFile(outFile, g->vertices[v].label, labelList, FALSE);
          fprintf(outFile, "\n");
       }
@@ -233,8 +233,8 @@ void WritePrunedGraph(Graph *g, FILE *outFile, LabelList *labelList)
          else 
             fprintf(outFile, "u");
          fprintf(outFile, " %lu %lu ",
-                 (g->vertices[edge->vertex1].map + 1),
-                 (g->vertices[edge->vertex2].map + 1));
+                 ((ULONG) g->vertices[edge->vertex1].map + 1),
+                 ((ULONG) g->vertices[edge->vertex2].map + 1));
          WriteLabelToFile(outFile, edge->label, labelList, FALSE);
          fprintf(outFile, "\n");
       }
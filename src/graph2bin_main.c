@@ -0,0 +1,117 @@
+//---------------------------------------------------------------------------
+// graph2bin_main.c
+//
+// Main functions for program to convert a Subdue graph file into a
+// binary graph file.
+//
+// Usage: graph2bin [-undirected] <graphfilename> <binaryfilename>
+//
+// Writes the graphs, examples and labels defined in <graphfilename> to
+// <binaryfilename>, which can be given to SUBDUE and the other programs
+// in place of <graphfilename> and is read without parsing.  With
+// -undirected, 'e' edges are undirected, and the binary file must be
+// used with -undirected.
+//
+// Subdue 5
+//---------------------------------------------------------------------------
+
+#include "subdue.h"
+
+
+// Function prototypes
+
+int main(int, char **);
+Parameters *GetParameters(int, char **);
+void FreeParameters(Parameters *);
+
+
+//---------------------------------------------------------------------------
+// NAME:    main
+//
+// INPUTS:  (int argc) - number of arguments to program
+//          (char **argv) - array of strings of arguments to program
+//
+// RETURN:  (int) - 0 if all is well
+//
+// PURPOSE: Main function for graph to binary graph conversion program.
+// Takes two command-line arguments, which are the input graph file and
+// the output binary graph file, optionally preceded by -undirected.
+//---------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+   Parameters *parameters;
+
+   if ((argc != 3) &&
+       ((argc != 4) || (strcmp(argv[1], "-undirected") != 0)))
+   {
+      printf("USAGE: %s [-undirected] <graphfilename> <binaryfilename>\n",
+             argv[0]);
+      exit(1);
+   }
+
+   parameters = GetParameters(argc, argv);
+   ReadInputFile(parameters);
+   WriteBinaryGraphFile(argv[argc - 1], parameters);
+
+   FreeParameters(parameters);
+
+   return 0;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: GetParameters
+//
+// INPUTS: (int argc) - number of command-line arguments
+//         (char *argv[]) - array of command-line argument strings
+//
+// RETURN: (Parameters *)
+//
+// PURPOSE: Initialize parameters structure and process command-line
+// options.
+//---------------------------------------------------------------------------
+
+Parameters *GetParameters(int argc, char *argv[])
+{
+   Parameters *parameters;
+
+   parameters = (Parameters *) malloc(sizeof(Parameters));
+   if (parameters == NULL)
+      OutOfMemoryError("GetParameters:parameters");
+
+   // initialize parameter settings
+   strcpy(parameters->inputFileName, argv[argc - 2]);
+   parameters->labelList = AllocateLabelList();
+   parameters->directed = (argc == 3);
+   parameters->numThreads = 1;
+   parameters->posGraph = NULL;
+   parameters->negGraph = NULL;
+   parameters->numPosEgs = 0;
+   parameters->numNegEgs = 0;
+   parameters->posEgsVertexIndices = NULL;
+   parameters->negEgsVertexIndices = NULL;
+
+   return parameters;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FreeParameters
+//
+// INPUTS: (Parameters *parameters)
+//
+// RETURN: (void)
+//
+// PURPOSE: Free memory allocated for parameters.
+//---------------------------------------------------------------------------
+
+void FreeParameters(Parameters *parameters)
+{
+   FreeGraph(parameters->posGraph);
+   FreeGraph(parameters->negGraph);
+   FreeLabelList(parameters->labelList);
+   free(parameters->posEgsVertexIndices);
+   free(parameters->negEgsVertexIndices);
+   free(parameters);
+}
@@ -78,7 +78,10 @@ Parameters *GetParameters(int argc, char *argv[])
    // initialize parameter settings
    strcpy(parameters->inputFileName, argv[1]);
    parameters->labelList = AllocateLabelList();
+   AllocateParameterMarks(parameters);
+   parameters->matchMethod = MATCH_SEARCH;
    parameters->directed = TRUE;
+   parameters->numThreads = 1;
    parameters->posGraph = NULL;
    parameters->negGraph = NULL;
    parameters->numPosEgs = 0;
@@ -107,5 +110,6 @@ void FreeParameters(Parameters *parameters)
    FreeLabelList(parameters->labelList);
    free(parameters->posEgsVertexIndices);
    free(parameters->negEgsVertexIndices);
+   FreeParameterMarks(parameters);
    free(parameters);
 }
@@ -0,0 +1,2024 @@
+//---------------------------------------------------------------------------
+// graphfile.c
+//
+// Fast input of graph files.  A regular file is memory-mapped and
+// tokenized in place, instead of one fgetc call per character; a pipe
+// or compressed file is read into a buffer a window at a time as it is
+// tokenized.  Tokens, comments, line numbers and error messages follow
+// ReadToken and the other FILE-based readers in graphops.c exactly, so
+// a file builds the same graph and label list with either.  Files
+// compressed by gzip or zstd are decompressed by a separate thread while
+// they are tokenized.  Large files can be split at example tokens and
+// read by several threads, then merged into the graphs a single reader
+// builds.
+//
+// SUBDUE 5
+//---------------------------------------------------------------------------
+
+#include "subdue.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <zlib.h>
+
+
+//---------------------------------------------------------------------------
+// NAME: OpenGraphFile
+//
+// INPUTS: (char *fileName) - graph file to open
+//
+// RETURN: (GraphFile *) - opened graph file, or NULL if the file cannot
+//                         be opened
+//
+// PURPOSE: Open a graph file for scanning.  Regular files are
+// memory-mapped copy-on-write, so that binary graph files can be used
+// and modified in place.  Anything else (e.g., a pipe, or a compressed
+// file, see OpenInputFile) is read as it is scanned (see ScanToken);
+// enough is read at first to recognize a binary graph file.
+//---------------------------------------------------------------------------
+
+GraphFile *OpenGraphFile(char *fileName)
+{
+   GraphFile *graphFile;
+   Decompressor *decompressor;
+   struct stat fileStat;
+   int fd;
+   void *data;
+
+   fd = OpenInputFile(fileName, & decompressor);
+   if (fd < 0)
+      return NULL;
+   graphFile = (GraphFile *) malloc(sizeof(GraphFile));
+   if (graphFile == NULL)
+      OutOfMemoryError("OpenGraphFile:graphFile");
+   graphFile->data = NULL;
+   graphFile->size = 0;
+   graphFile->pos = 0;
+   graphFile->lineNo = 1;
+   graphFile->mapped = FALSE;
+   graphFile->bufferSize = 0;
+   graphFile->fd = -1;
+   graphFile->decompressor = NULL;
+   graphFile->token = NULL;
+   graphFile->tokenLength = 0;
+   graphFile->tokenBuffer = NULL;
+   graphFile->tokenBufferSize = 0;
+   graphFile->exitOnError = TRUE;
+   graphFile->failed = FALSE;
+
+   if ((decompressor == NULL) && (fstat(fd, & fileStat) == 0) &&
+       (S_ISREG(fileStat.st_mode)) && (fileStat.st_size > 0))
+   {
+      data = mmap(NULL, (size_t) fileStat.st_size, (PROT_READ | PROT_WRITE),
+                  MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+         madvise(data, (size_t) fileStat.st_size, MADV_SEQUENTIAL);
+         graphFile->data = (char *) data;
+         graphFile->size = (size_t) fileStat.st_size;
+         graphFile->mapped = TRUE;
+      }
+   }
+   if (graphFile->mapped)
+      close(fd);
+   else
+   {
+      graphFile->fd = fd;
+      graphFile->decompressor = decompressor;
+      while ((graphFile->size < strlen(BINARY_GRAPH_MAGIC)) &&
+             RefillGraphFile(graphFile))
+         ;
+   }
+   return graphFile;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReadGraphFileData
+//
+// INPUTS: (GraphFile *graphFile) - graph file being read as a stream
+//
+// RETURN: (void)
+//
+// PURPOSE: Read the rest of the file into its buffer, for callers that
+// need all of the contents at once (i.e., binary graph files).  Must be
+// called before anything is scanned.
+//---------------------------------------------------------------------------
+
+void ReadGraphFileData(GraphFile *graphFile)
+{
+   while (RefillGraphFile(graphFile))
+      ;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: RefillGraphFile
+//
+// INPUTS: (GraphFile *graphFile) - graph file being read as a stream
+//
+// RETURN: (BOOLEAN) - FALSE if the whole file has already been read
+//
+// PURPOSE: Read more of the file into its buffer.  The contents before
+// the scan position are no longer needed, so the rest is first moved to
+// the start of the buffer; the buffer only grows when the rest fills
+// it, e.g., for a very long token.  At the end of the file, the file
+// is closed and any decompressor is finished, which exits if the file
+// could not be decompressed.
+//---------------------------------------------------------------------------
+
+BOOLEAN RefillGraphFile(GraphFile *graphFile)
+{
+   ssize_t numRead;
+
+   if (graphFile->fd < 0)
+      return FALSE;
+
+   // keep unscanned contents, and make room for more
+   if (graphFile->pos > 0)
+   {
+      memmove(graphFile->data, (graphFile->data + graphFile->pos),
+              (graphFile->size - graphFile->pos));
+      graphFile->size -= graphFile->pos;
+      graphFile->pos = 0;
+   }
+   if (graphFile->size == graphFile->bufferSize)
+   {
+      graphFile->bufferSize = (graphFile->bufferSize == 0) ?
+                              STREAM_WINDOW_SIZE : (2 * graphFile->bufferSize);
+      graphFile->data = (char *) realloc(graphFile->data,
+                                         graphFile->bufferSize);
+      if (graphFile->data == NULL)
+         OutOfMemoryError("RefillGraphFile:data");
+   }
+
+   // read what is available, waiting if nothing is
+   do
+      numRead = read(graphFile->fd, (graphFile->data + graphFile->size),
+                     (graphFile->bufferSize - graphFile->size));
+   while ((numRead < 0) && (errno == EINTR));
+   if (numRead > 0)
+      graphFile->size += (size_t) numRead;
+   else
+   {
+      close(graphFile->fd);
+      graphFile->fd = -1;
+      if (graphFile->decompressor != NULL)
+         FinishDecompressor(graphFile->decompressor);
+      graphFile->decompressor = NULL;
+   }
+   return TRUE;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: CloseGraphFile
+//
+// INPUTS: (GraphFile *graphFile) - graph file to close
+//
+// RETURN: (void)
+//
+// PURPOSE: Unmap or free the file's contents and free the graph file.
+// A file closed before its end stops its decompressor, if any.
+//---------------------------------------------------------------------------
+
+void CloseGraphFile(GraphFile *graphFile)
+{
+   if (graphFile->fd >= 0)
+   {
+      close(graphFile->fd);
+      if (graphFile->decompressor != NULL)
+         FinishDecompressor(graphFile->decompressor);
+   }
+   if (graphFile->mapped)
+      munmap(graphFile->data, graphFile->size);
+   else
+      free(graphFile->data);
+   free(graphFile->tokenBuffer);
+   free(graphFile);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReleaseGraphFileMemory
+//
+// INPUTS: (GraphFileMemory *fileMemory) - memory no longer used by a graph
+//
+// RETURN: (void)
+//
+// PURPOSE: Drop one graph's use of a binary graph file's memory, and
+// unmap or free the memory when no graph uses it any longer.
+//---------------------------------------------------------------------------
+
+void ReleaseGraphFileMemory(GraphFileMemory *fileMemory)
+{
+   fileMemory->refCount--;
+   if (fileMemory->refCount == 0)
+   {
+      if (fileMemory->mapped)
+         munmap(fileMemory->data, fileMemory->size);
+      else
+         free(fileMemory->data);
+      free(fileMemory);
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: OpenInputFile
+//
+// INPUTS: (char *fileName) - graph file to open
+//         (Decompressor **decompressor) - set to the file's
+//                                         decompressor, or NULL
+//
+// RETURN: (int) - descriptor reading the file's contents, or -1 if the
+//                 file cannot be opened
+//
+// PURPOSE: Open a graph file for reading.  A file compressed by gzip or
+// zstd, recognized by its first bytes, is decompressed as it is read:
+// the descriptor returned is then the read end of a pipe, filled by a
+// decompressor thread while the caller reads.  Once the pipe is read to
+// its end or closed, the caller must call FinishDecompressor.  Other
+// files are read as they are.
+//---------------------------------------------------------------------------
+
+int OpenInputFile(char *fileName, Decompressor **decompressor)
+{
+   char magic[4];
+   ssize_t magicLength;
+   int fd;
+
+   *decompressor = NULL;
+   fd = open(fileName, O_RDONLY);
+   if (fd < 0)
+      return -1;
+   fcntl(fd, F_SETFD, FD_CLOEXEC);
+   magicLength = pread(fd, magic, sizeof(magic), 0);
+   if ((magicLength >= (ssize_t) (sizeof(GZIP_MAGIC) - 1)) &&
+       (memcmp(magic, GZIP_MAGIC, (sizeof(GZIP_MAGIC) - 1)) == 0))
+      fd = StartDecompressor(fd, fileName, GzipDecompressorThread,
+                             decompressor);
+   else if ((magicLength >= (ssize_t) (sizeof(ZSTD_MAGIC) - 1)) &&
+            (memcmp(magic, ZSTD_MAGIC, (sizeof(ZSTD_MAGIC) - 1)) == 0))
+      fd = StartDecompressor(fd, fileName, ZstdDecompressorThread,
+                             decompressor);
+   return fd;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: OpenInputStream
+//
+// INPUTS: (char *fileName) - graph file to open
+//         (Decompressor **decompressor) - set to the file's
+//                                         decompressor, or NULL
+//
+// RETURN: (FILE *) - stream reading the file's contents, or NULL if the
+//                    file cannot be opened
+//
+// PURPOSE: Open a graph file for reading by ReadToken and the other
+// FILE-based readers, decompressing it if needed (see OpenInputFile).
+// The stream must be closed by CloseInputStream.
+//---------------------------------------------------------------------------
+
+FILE *OpenInputStream(char *fileName, Decompressor **decompressor)
+{
+   FILE *stream;
+   int fd;
+
+   fd = OpenInputFile(fileName, decompressor);
+   if (fd < 0)
+      return NULL;
+   stream = fdopen(fd, "r");
+   if (stream == NULL)
+   {
+      fprintf(stderr, "Unable to open input file %s.\n", fileName);
+      exit(1);
+   }
+   return stream;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: CloseInputStream
+//
+// INPUTS: (FILE *stream) - stream opened by OpenInputStream
+//         (Decompressor *decompressor) - its decompressor, or NULL
+//
+// RETURN: (void)
+//
+// PURPOSE: Close the stream and finish its decompressor, which exits if
+// the file could not be decompressed.
+//---------------------------------------------------------------------------
+
+void CloseInputStream(FILE *stream, Decompressor *decompressor)
+{
+   fclose(stream);
+   if (decompressor != NULL)
+      FinishDecompressor(decompressor);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: StartDecompressor
+//
+// INPUTS: (int fd) - descriptor of compressed file
+//         (char *fileName) - name of compressed file
+//         (void *(*threadBody)(void *)) - decompressor thread body
+//         (Decompressor **decompressor) - set to the new decompressor
+//
+// RETURN: (int) - read end of pipe the decompressed contents are
+//                 written to
+//
+// PURPOSE: Start a thread decompressing the file into a pipe, so that
+// decompression overlaps the reader's scanning.  Where possible, the
+// pipe holds DECOMPRESS_BUFFER_SIZE bytes, so the thread can keep
+// working while the reader is busy.  The thread closes the pipe when it
+// is done, and leaves any error for FinishDecompressor to report.
+//---------------------------------------------------------------------------
+
+int StartDecompressor(int fd, char *fileName, void *(*threadBody)(void *),
+                      Decompressor **decompressor)
+{
+   Decompressor *newDecompressor;
+   int pipeFds[2];
+
+   newDecompressor = (Decompressor *) malloc(sizeof(Decompressor));
+   if (newDecompressor == NULL)
+      OutOfMemoryError("StartDecompressor:decompressor");
+   if (pipe(pipeFds) != 0)
+   {
+      fprintf(stderr, "Unable to decompress input file %s.\n", fileName);
+      exit(1);
+   }
+   fcntl(pipeFds[0], F_SETFD, FD_CLOEXEC);
+   fcntl(pipeFds[1], F_SETFD, FD_CLOEXEC);
+#ifdef F_SETPIPE_SZ
+   fcntl(pipeFds[1], F_SETPIPE_SZ, DECOMPRESS_BUFFER_SIZE);
+#endif
+   newDecompressor->inputFd = fd;
+   newDecompressor->outputFd = pipeFds[1];
+   strncpy(newDecompressor->fileName, fileName, (FILE_NAME_LEN - 1));
+   newDecompressor->fileName[FILE_NAME_LEN - 1] = '\0';
+   newDecompressor->error[0] = '\0';
+   if (pthread_create(& newDecompressor->thread, NULL, threadBody,
+                      newDecompressor) != 0)
+   {
+      fprintf(stderr, "StartDecompressor: unable to create thread\n");
+      exit(1);
+   }
+   *decompressor = newDecompressor;
+   return pipeFds[0];
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FinishDecompressor
+//
+// INPUTS: (Decompressor *decompressor)
+//
+// RETURN: (void)
+//
+// PURPOSE: Wait for the decompressor thread, after the reader has read
+// its pipe to the end or closed it, and free it.  If the file could not
+// be decompressed, report the error and exit, so a reader never uses
+// the contents of a partly decompressed file.
+//---------------------------------------------------------------------------
+
+void FinishDecompressor(Decompressor *decompressor)
+{
+   pthread_join(decompressor->thread, NULL);
+   if (decompressor->error[0] != '\0')
+   {
+      fprintf(stderr, "Unable to decompress input file %s: %s.\n",
+              decompressor->fileName, decompressor->error);
+      exit(1);
+   }
+   free(decompressor);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: GzipDecompressorThread
+//
+// INPUTS: (void *arg) - the thread's Decompressor
+//
+// RETURN: (void *) - NULL
+//
+// PURPOSE: Thread body decompressing a gzip file, including one of
+// several concatenated gzip streams, into the decompressor's pipe.
+// Stops early, without error, if the reader closes the pipe.
+//---------------------------------------------------------------------------
+
+void *GzipDecompressorThread(void *arg)
+{
+   Decompressor *decompressor = (Decompressor *) arg;
+   gzFile gzipFile;
+   sigset_t signals;
+   char *buffer;
+   const char *message;
+   int length;
+   int error;
+
+   // a reader closing the pipe makes writes fail instead of killing us
+   sigemptyset(& signals);
+   sigaddset(& signals, SIGPIPE);
+   pthread_sigmask(SIG_BLOCK, & signals, NULL);
+
+   buffer = (char *) malloc(DECOMPRESS_BUFFER_SIZE);
+   if (buffer == NULL)
+      OutOfMemoryError("GzipDecompressorThread:buffer");
+   gzipFile = gzdopen(decompressor->inputFd, "rb");
+   if (gzipFile == NULL)
+      OutOfMemoryError("GzipDecompressorThread:gzipFile");
+   gzbuffer(gzipFile, DECOMPRESS_BUFFER_SIZE);
+
+   do
+   {
+      length = gzread(gzipFile, buffer, DECOMPRESS_BUFFER_SIZE);
+      if ((length > 0) &&
+          (! WriteDecompressedData(decompressor->outputFd, buffer,
+                                   (ULONG) length)))
+         length = 0; // reader is done
+   } while (length > 0);
+
+   // a truncated file leaves an error, even though gzread returns 0
+   message = gzerror(gzipFile, & error);
+   if (error != Z_OK)
+   {
+      if (strstr(message, ": ") != NULL) // skip zlib's "<fd:n>: " prefix
+         message = strstr(message, ": ") + 2;
+      DecompressionError(decompressor, (char *) message);
+   }
+   gzclose_r(gzipFile);
+   close(decompressor->outputFd);
+   free(buffer);
+   return NULL;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ZstdDecompressorThread
+//
+// INPUTS: (void *arg) - the thread's Decompressor
+//
+// RETURN: (void *) - NULL
+//
+// PURPOSE: Thread body decompressing a zstd file into the decompressor's
+// pipe by running ZSTD_COMMAND, since the zstd library is not always
+// installed for building.  The thread waits for the command, so its
+// exit status is known before the pipe is closed.
+//---------------------------------------------------------------------------
+
+void *ZstdDecompressorThread(void *arg)
+{
+   Decompressor *decompressor = (Decompressor *) arg;
+   pid_t pid;
+   int status;
+
+   pid = fork();
+   if (pid == 0)
+   { // in child: decompress standard input to standard output
+      dup2(decompressor->inputFd, 0);
+      dup2(decompressor->outputFd, 1);
+      execlp(ZSTD_COMMAND, ZSTD_COMMAND, "-dcq", (char *) NULL);
+      _exit(127);
+   }
+   close(decompressor->inputFd);
+   if (pid < 0)
+      DecompressionError(decompressor, "unable to run " ZSTD_COMMAND);
+   else
+   {
+      while ((waitpid(pid, & status, 0) < 0) && (errno == EINTR))
+         ;
+      if (WIFEXITED(status) && (WEXITSTATUS(status) == 127))
+         DecompressionError(decompressor, "unable to run " ZSTD_COMMAND);
+      // killed by SIGPIPE if the reader closed the pipe early
+      else if (! ((WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ||
+                  (WIFSIGNALED(status) && (WTERMSIG(status) == SIGPIPE))))
+         DecompressionError(decompressor, ZSTD_COMMAND " failed");
+   }
+   close(decompressor->outputFd);
+   return NULL;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: WriteDecompressedData
+//
+// INPUTS: (int fd) - write end of decompressor's pipe
+//         (char *data) - decompressed data
+//         (ULONG length) - length of data
+//
+// RETURN: (BOOLEAN) - FALSE if the reader has closed the pipe
+//
+// PURPOSE: Write all of the data to the pipe.
+//---------------------------------------------------------------------------
+
+BOOLEAN WriteDecompressedData(int fd, char *data, ULONG length)
+{
+   ssize_t numWritten;
+
+   while (length > 0)
+   {
+      numWritten = write(fd, data, length);
+      if ((numWritten < 0) && (errno == EINTR))
+         continue;
+      if (numWritten <= 0)
+         return FALSE;
+      data += numWritten;
+      length -= (ULONG) numWritten;
+   }
+   return TRUE;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: DecompressionError
+//
+// INPUTS: (Decompressor *decompressor)
+//         (char *message) - description of error
+//
+// RETURN: (void)
+//
+// PURPOSE: Record why a compressed file cannot be decompressed, for
+// FinishDecompressor to report.
+//---------------------------------------------------------------------------
+
+void DecompressionError(Decompressor *decompressor, char *message)
+{
+   strncpy(decompressor->error, message, (TOKEN_LEN - 1));
+   decompressor->error[TOKEN_LEN - 1] = '\0';
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: SkipToNewline
+//
+// INPUTS: (GraphFile *graphFile)
+//
+// RETURN: (void)
+//
+// PURPOSE: Skip the rest of a comment, up to and including the end of
+// the line, or to the end of the contents in data if there is no end of
+// line.
+//---------------------------------------------------------------------------
+
+void SkipToNewline(GraphFile *graphFile)
+{
+   char *newline;
+
+   newline = memchr((graphFile->data + graphFile->pos), NEWLINE,
+                    (graphFile->size - graphFile->pos));
+   if (newline == NULL)
+      graphFile->pos = graphFile->size;
+   else
+   {
+      graphFile->pos = (newline - graphFile->data) + 1;
+      graphFile->lineNo++;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ScanToken
+//
+// INPUTS: (GraphFile *graphFile)
+//
+// RETURN: (ULONG) - length of token scanned
+//
+// PURPOSE: Scan the next token of the file, leaving it in
+// graphFile->token, which points into the file's contents and is not
+// NUL-terminated until the next call.  As with ReadToken, a token is a
+// string of non-whitespace characters or a double-quoted string,
+// whitespace includes comments, and the character ending a token is
+// consumed.  If the file is still being read, the token is scanned
+// again with more of the file whenever it reaches the end of what has
+// been read.
+//---------------------------------------------------------------------------
+
+ULONG ScanToken(GraphFile *graphFile)
+{
+   while (! ScanBufferedToken(graphFile))
+      RefillGraphFile(graphFile);
+   return graphFile->tokenLength;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ScanBufferedToken
+//
+// INPUTS: (GraphFile *graphFile)
+//
+// RETURN: (BOOLEAN) - FALSE if more of the file must be read first
+//
+// PURPOSE: Scan the next token of the file from the contents in data,
+// as ScanToken.  If the file is still being read and the token, or the
+// whitespace or comment around it, reaches the end of data, it may
+// continue in the rest of the file; the position and line number are
+// then left unchanged and FALSE is returned.
+//---------------------------------------------------------------------------
+
+BOOLEAN ScanBufferedToken(GraphFile *graphFile)
+{
+   char *data = graphFile->data;
+   size_t size = graphFile->size;
+   size_t pos = graphFile->pos;
+   size_t startPos = graphFile->pos;
+   ULONG lineNo = graphFile->lineNo;
+   BOOLEAN streaming = (graphFile->fd >= 0);
+   char *quote;
+   char ch;
+
+   // skip whitespace and comments
+   while (pos < size)
+   {
+      ch = data[pos];
+      if ((ch == SPACE) || (ch == TAB) || (ch == CARRIAGERETURN))
+         pos++;
+      else if (ch == NEWLINE)
+      {
+         graphFile->lineNo++;
+         pos++;
+      }
+      else if (ch == COMMENT)
+      {
+         graphFile->pos = pos;
+         SkipToNewline(graphFile);
+         pos = graphFile->pos;
+      }
+      else
+         break;
+   }
+
+   // scan token
+   graphFile->token = data + pos;
+   if ((pos < size) && (data[pos] == DOUBLEQUOTE))
+   { // scan through next double quote
+      quote = memchr((data + pos + 1), DOUBLEQUOTE, (size - pos - 1));
+      if (quote == NULL)
+      {
+         pos = size;
+         // a chunk cannot tell if the quote ends in a later chunk
+         if (! graphFile->exitOnError)
+            graphFile->failed = TRUE;
+      }
+      else
+         pos = (quote - data) + 1;
+   }
+   else
+   { // scan until reaching whitespace
+      while ((pos < size) && (data[pos] != SPACE) && (data[pos] != TAB) &&
+             (data[pos] != CARRIAGERETURN) && (data[pos] != NEWLINE) &&
+             (data[pos] != COMMENT))
+         pos++;
+   }
+   graphFile->tokenLength = (data + pos) - graphFile->token;
+
+   // consume character ending token, skipping rest of line if a comment
+   if (pos < size)
+   {
+      ch = data[pos++];
+      graphFile->pos = pos;
+      if (ch == NEWLINE)
+         graphFile->lineNo++;
+      else if (ch == COMMENT)
+         SkipToNewline(graphFile);
+   }
+   else
+      graphFile->pos = pos;
+
+   if (streaming && (graphFile->pos == size))
+   {
+      graphFile->pos = startPos;
+      graphFile->lineNo = lineNo;
+      return FALSE;
+   }
+   return TRUE;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: TokenEquals
+//
+// INPUTS: (GraphFile *graphFile)
+//         (char *string) - string to compare
+//
+// RETURN: (BOOLEAN) - TRUE if last token scanned equals string
+//
+// PURPOSE: Compare the last token with a string, as strcmp on the token
+// read by ReadToken.
+//---------------------------------------------------------------------------
+
+BOOLEAN TokenEquals(GraphFile *graphFile, char *string)
+{
+   return ((strlen(string) == graphFile->tokenLength) &&
+           (memcmp(graphFile->token, string, graphFile->tokenLength) == 0));
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: TokenString
+//
+// INPUTS: (GraphFile *graphFile)
+//
+// RETURN: (char *) - NUL-terminated copy of last token scanned
+//
+// PURPOSE: Copy the last token into the file's token buffer, which is
+// overwritten by the next call.
+//---------------------------------------------------------------------------
+
+char *TokenString(GraphFile *graphFile)
+{
+   if (graphFile->tokenLength >= graphFile->tokenBufferSize)
+   {
+      graphFile->tokenBufferSize = graphFile->tokenLength + TOKEN_LEN;
+      graphFile->tokenBuffer = (char *) realloc(graphFile->tokenBuffer,
+                                                graphFile->tokenBufferSize);
+      if (graphFile->tokenBuffer == NULL)
+         OutOfMemoryError("TokenString:tokenBuffer");
+   }
+   memcpy(graphFile->tokenBuffer, graphFile->token, graphFile->tokenLength);
+   graphFile->tokenBuffer[graphFile->tokenLength] = '\0';
+   return graphFile->tokenBuffer;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: TokenDigits
+//
+// INPUTS: (GraphFile *graphFile)
+//         (ULONG maxDigits) - most digits to accept
+//         (ULONG *value) - set to value of token
+//
+// RETURN: (BOOLEAN) - TRUE if token is 1 to maxDigits decimal digits
+//
+// PURPOSE: Convert the common case of a short unsigned integer token
+// without calling strtoul or strtod.
+//---------------------------------------------------------------------------
+
+BOOLEAN TokenDigits(GraphFile *graphFile, ULONG maxDigits, ULONG *value)
+{
+   ULONG i;
+   ULONG n = 0;
+
+   if ((graphFile->tokenLength == 0) || (graphFile->tokenLength > maxDigits))
+      return FALSE;
+   for (i = 0; i < graphFile->tokenLength; i++)
+   {
+      if ((graphFile->token[i] < '0') || (graphFile->token[i] > '9'))
+         return FALSE;
+      n = (n * 10) + (graphFile->token[i] - '0');
+   }
+   *value = n;
+   return TRUE;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ScanInteger
+//
+// INPUTS: (GraphFile *graphFile)
+//
+// RETURN: (ULONG) - integer scanned
+//
+// PURPOSE: Scan an unsigned long integer token, as ReadInteger.
+//---------------------------------------------------------------------------
+
+ULONG ScanInteger(GraphFile *graphFile)
+{
+   ULONG i;
+   char *endptr;
+
+   ScanToken(graphFile);
+   if (TokenDigits(graphFile, 18, & i))
+      return i;
+   i = strtoul(TokenString(graphFile), &endptr, 10);
+   if (*endptr != '\0')
+      GraphFileError(graphFile, "Error: expecting integer in line %lu.\n");
+   return i;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ScanLabel
+//
+// INPUTS: (GraphFile *graphFile)
+//         (LabelList *labelList) - list of vertex and edge labels
+//
+// RETURN: (ULONG) - index of scanned label in label list
+//
+// PURPOSE: Scan a label (string or numeric) and store it in the label
+// list if not already there, as ReadLabel.  Integers of up to 15 digits
+// are exactly representable, so are converted without strtod.
+//---------------------------------------------------------------------------
+
+ULONG ScanLabel(GraphFile *graphFile, LabelList *labelList)
+{
+   char *token;
+   char *endptr;
+   ULONG n;
+   Label label;
+
+   ScanToken(graphFile);
+   label.labelType = NUMERIC_LABEL;
+   if (TokenDigits(graphFile, 15, & n))
+      label.labelValue.numericLabel = (double) n;
+   else
+   {
+      token = TokenString(graphFile);
+      label.labelValue.numericLabel = strtod(token, &endptr);
+      if (*endptr != '\0')
+      {
+         label.labelType = STRING_LABEL;
+         label.labelValue.stringLabel = token;
+      }
+   }
+   return StoreLabel(&label, labelList);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ScanVertex
+//
+// INPUTS: (GraphFile *graphFile)
+//         (Graph *graph) - graph being constructed
+//         (LabelList *labelList) - list of vertex and edge labels
+//         (ULONG vertexOffset) - offset to add to vertex numbers
+//
+// RETURN: (void)
+//
+// PURPOSE: Scan and check the vertex number and label, and add the
+// vertex to the graph, as ReadVertex.
+//---------------------------------------------------------------------------
+
+void ScanVertex(GraphFile *graphFile, Graph *graph, LabelList *labelList,
+                ULONG vertexOffset)
+{
+   ULONG vertexID;
+   ULONG labelIndex;
+
+   // scan and check vertex number
+   vertexID = ScanInteger(graphFile) + vertexOffset;
+   if (vertexID != (graph->numVertices + 1))
+   {
+      GraphFileError(graphFile, "Error: invalid vertex number at line %lu.\n");
+      return;
+   }
+   labelIndex = ScanLabel(graphFile, labelList);
+
+   AddVertex(graph, labelIndex);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ScanEdge
+//
+// INPUTS: (GraphFile *graphFile)
+//         (Graph *graph) - graph being constructed
+//         (LabelList *labelList) - list of vertex and edge labels
+//         (BOOLEAN directed) - TRUE if edge is directed
+//         (ULONG vertexOffset) - offset to add to vertex numbers
+//
+// RETURN: (void)
+//
+// PURPOSE: Scan and check the vertex numbers and label, and add the edge
+// to the graph, as ReadEdge.  The edge is only appended to the graph's
+// edge array; the caller must call BuildVertexEdges once the graph has
+// been read.
+//---------------------------------------------------------------------------
+
+void ScanEdge(GraphFile *graphFile, Graph *graph, LabelList *labelList,
+              BOOLEAN directed, ULONG vertexOffset)
+{
+   ULONG sourceVertexID;
+   ULONG targetVertexID;
+   ULONG labelIndex;
+
+   // scan and check vertex numbers
+   sourceVertexID = ScanInteger(graphFile) + vertexOffset;
+   if ((sourceVertexID < 1) || (sourceVertexID > graph->numVertices))
+   {
+      GraphFileError(graphFile,
+         "Error: reference to undefined vertex number at line %lu.\n");
+      return;
+   }
+   targetVertexID = ScanInteger(graphFile) + vertexOffset;
+   if ((targetVertexID < 1) || (targetVertexID > graph->numVertices))
+   {
+      GraphFileError(graphFile,
+         "Error: reference to undefined vertex number at line %lu.\n");
+      return;
+   }
+   labelIndex = ScanLabel(graphFile, labelList);
+
+   AppendEdge(graph, (sourceVertexID - 1), (targetVertexID - 1), directed,
+              labelIndex, FALSE);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: GraphFileError
+//
+// INPUTS: (GraphFile *graphFile)
+//         (char *format) - error message, with a %lu for the line number
+//
+// RETURN: (void)
+//
+// PURPOSE: Report an error in the graph file and exit.  If the file is
+// a chunk being read in parallel, just mark it failed instead, so that
+// the whole file can be read again by a single reader, which reports
+// the first error in the file.
+//---------------------------------------------------------------------------
+
+void GraphFileError(GraphFile *graphFile, char *format)
+{
+   if (! graphFile->exitOnError)
+   {
+      graphFile->failed = TRUE;
+      return;
+   }
+   fprintf(stderr, format, graphFile->lineNo);
+   exit(1);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReadGraphFileInParallel
+//
+// INPUTS: (GraphFile *graphFile) - opened graph file
+//         (Parameters *parameters)
+//
+// RETURN: (BOOLEAN) - TRUE if the file was read; FALSE if it must be
+//                     read by a single reader
+//
+// PURPOSE: Read the examples of a large graph file using up to
+// parameters->numThreads threads.  The file is split into chunks
+// starting at example tokens, and each chunk is read into its own
+// graphs and label list.  The chunks are then merged in file order,
+// storing their labels in the parameters' label list in order of first
+// appearance and offsetting their vertices, so the graphs, examples and
+// labels are the same as ReadInputFile builds by itself.  Returns FALSE
+// without changing the parameters if the file is too small to split,
+// is being read as it is scanned (e.g., a compressed file), or if any
+// chunk finds an error or cannot be read on its own.
+//---------------------------------------------------------------------------
+
+BOOLEAN ReadGraphFileInParallel(GraphFile *graphFile, Parameters *parameters)
+{
+   GraphFileChunk *chunks;
+   GraphFileChunk *chunk;
+   LabelList *chunkLabels;
+   ULONG maxChunks;
+   ULONG numChunks;
+   ULONG i, l;
+   size_t start, end;
+   BOOLEAN failed;
+
+   if (graphFile->fd >= 0)
+      return FALSE;
+   maxChunks = graphFile->size / PARALLEL_READ_SIZE;
+   if (maxChunks > parameters->numThreads)
+      maxChunks = parameters->numThreads;
+   if (maxChunks < 2)
+      return FALSE;
+   chunks = (GraphFileChunk *) malloc(sizeof(GraphFileChunk) * maxChunks);
+   if (chunks == NULL)
+      OutOfMemoryError("ReadGraphFileInParallel:chunks");
+
+   // split file at the first example token after each equal part
+   numChunks = 0;
+   start = 0;
+   while ((numChunks < maxChunks) && (start < graphFile->size))
+   {
+      end = graphFile->size;
+      if ((numChunks + 1) < maxChunks)
+      {
+         end = (graphFile->size / maxChunks) * (numChunks + 1);
+         if (end < start)
+            end = start;
+         end = FindExampleBoundary(graphFile, end);
+      }
+      InitGraphFileChunk(& chunks[numChunks], graphFile, start, end,
+                         parameters->directed);
+      numChunks++;
+      start = end;
+   }
+
+   // read chunks
+   if (numChunks > 1)
+   {
+      for (i = 0; i < numChunks; i++)
+      {
+         if (pthread_create(& chunks[i].thread, NULL, ReadGraphFileChunk,
+                            & chunks[i]) != 0)
+         {
+            fprintf(stderr,
+                    "ReadGraphFileInParallel: unable to create thread\n");
+            exit(1);
+         }
+      }
+      for (i = 0; i < numChunks; i++)
+         pthread_join(chunks[i].thread, NULL);
+   }
+   failed = (numChunks < 2);
+   for (i = 0; i < numChunks; i++)
+      if (chunks[i].graphFile.failed)
+         failed = TRUE;
+
+   // merge chunks in file order
+   if (! failed)
+   {
+      for (i = 0; i < numChunks; i++)
+      {
+         chunk = & chunks[i];
+         chunkLabels = chunk->labelList;
+         if (chunkLabels->numLabels > 0)
+         {
+            chunk->labelMap =
+               (ULONG *) malloc(sizeof(ULONG) * chunkLabels->numLabels);
+            if (chunk->labelMap == NULL)
+               OutOfMemoryError("ReadGraphFileInParallel:labelMap");
+         }
+         for (l = 0; l < chunkLabels->numLabels; l++)
+            chunk->labelMap[l] = StoreLabel(& chunkLabels->labels[l],
+                                            parameters->labelList);
+      }
+      MergeExampleGraphs(chunks, numChunks, POS, & parameters->posGraph,
+                         & parameters->numPosEgs,
+                         & parameters->posEgsVertexIndices);
+      MergeExampleGraphs(chunks, numChunks, NEG, & parameters->negGraph,
+                         & parameters->numNegEgs,
+                         & parameters->negEgsVertexIndices);
+   }
+
+   for (i = 0; i < numChunks; i++)
+      FreeGraphFileChunk(& chunks[i]);
+   free(chunks);
+   return (! failed);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FindExampleBoundary
+//
+// INPUTS: (GraphFile *graphFile)
+//         (size_t pos) - position in file's contents
+//
+// RETURN: (size_t) - position of first example token starting a line
+//                    after pos, or the size of the contents if none
+//
+// PURPOSE: Find a place after pos to split the file for reading in
+// parallel.  An example token at the start of a line can only be
+// inside a quoted label spanning lines; the chunk before would then end
+// inside the quote, which ScanToken reports.
+//---------------------------------------------------------------------------
+
+size_t FindExampleBoundary(GraphFile *graphFile, size_t pos)
+{
+   char *data = graphFile->data;
+   size_t size = graphFile->size;
+   size_t tokenLength = strlen(POS_EG_TOKEN);
+   char *newline;
+   char ch;
+
+   while (pos < size)
+   {
+      // move to start of next line, skipping indentation
+      newline = memchr((data + pos), NEWLINE, (size - pos));
+      if (newline == NULL)
+         return size;
+      pos = (newline - data) + 1;
+      while ((pos < size) && ((data[pos] == SPACE) || (data[pos] == TAB)))
+         pos++;
+
+      // check for a whole example token
+      if (((pos + tokenLength) <= size) &&
+          ((memcmp((data + pos), POS_EG_TOKEN, tokenLength) == 0) ||
+           (memcmp((data + pos), NEG_EG_TOKEN, tokenLength) == 0)))
+      {
+         if ((pos + tokenLength) == size)
+            return pos;
+         ch = data[pos + tokenLength];
+         if ((ch == SPACE) || (ch == TAB) || (ch == CARRIAGERETURN) ||
+             (ch == NEWLINE) || (ch == COMMENT))
+            return pos;
+      }
+   }
+   return size;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: InitGraphFileChunk
+//
+// INPUTS: (GraphFileChunk *chunk) - chunk to initialize
+//         (GraphFile *graphFile) - file containing chunk
+//         (size_t start) - position of chunk in file's contents
+//         (size_t end) - position after chunk
+//         (BOOLEAN directed) - TRUE if 'e' edges are directed
+//
+// RETURN: (void)
+//
+// PURPOSE: Set up a chunk to scan its part of the file's contents, which
+// it shares with the file, with no examples or labels read yet.
+//---------------------------------------------------------------------------
+
+void InitGraphFileChunk(GraphFileChunk *chunk, GraphFile *graphFile,
+                        size_t start, size_t end, BOOLEAN directed)
+{
+   ULONG eg;
+
+   chunk->graphFile.data = graphFile->data;
+   chunk->graphFile.size = end;
+   chunk->graphFile.pos = start;
+   chunk->graphFile.lineNo = 1;
+   chunk->graphFile.mapped = FALSE;
+   chunk->graphFile.bufferSize = 0;
+   chunk->graphFile.fd = -1;
+   chunk->graphFile.decompressor = NULL;
+   chunk->graphFile.token = NULL;
+   chunk->graphFile.tokenLength = 0;
+   chunk->graphFile.tokenBuffer = NULL;
+   chunk->graphFile.tokenBufferSize = 0;
+   chunk->graphFile.exitOnError = FALSE;
+   chunk->graphFile.failed = FALSE;
+   chunk->directed = directed;
+   chunk->labelList = AllocateLabelList();
+   chunk->labelMap = NULL;
+   for (eg = NEG; eg <= POS; eg++)
+   {
+      chunk->examples[eg].graph = NULL;
+      chunk->examples[eg].numEgs = 0;
+      chunk->examples[eg].egsVertexIndices = NULL;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReadGraphFileChunk
+//
+// INPUTS: (void *arg) - the thread's GraphFileChunk
+//
+// RETURN: (void *) - NULL
+//
+// PURPOSE: Thread body for ReadGraphFileInParallel.  Reads the examples
+// of the chunk as ReadInputFile does, with vertex numbers relative to
+// the chunk and labels stored in the chunk's label list.  Stops and
+// marks the chunk failed at anything ReadInputFile would report, or at
+// an edge before any vertex, leaving them to the single reader.
+//---------------------------------------------------------------------------
+
+void *ReadGraphFileChunk(void *arg)
+{
+   GraphFileChunk *chunk = (GraphFileChunk *) arg;
+   GraphFile *graphFile = & chunk->graphFile;
+   ExampleGraph *example = NULL;
+   ULONG vertexOffset = 0;
+
+   while ((! graphFile->failed) && (ScanToken(graphFile) != 0))
+   {
+      if (TokenEquals(graphFile, POS_EG_TOKEN))
+      { // reading positive eg
+         example = & chunk->examples[POS];
+         vertexOffset = AddExample(example);
+      }
+      else if (TokenEquals(graphFile, NEG_EG_TOKEN))
+      { // reading negative eg
+         example = & chunk->examples[NEG];
+         vertexOffset = AddExample(example);
+      }
+      else if (TokenEquals(graphFile, "v"))
+      {  // read vertex
+         if (example == NULL)
+         {
+            // first graph starts without positive token, so assumed positive
+            example = & chunk->examples[POS];
+            vertexOffset = AddExample(example);
+         }
+         ScanVertex(graphFile, example->graph, chunk->labelList,
+                    vertexOffset);
+      }
+      else if ((example != NULL) && TokenEquals(graphFile, "e"))
+         ScanEdge(graphFile, example->graph, chunk->labelList,
+                  chunk->directed, vertexOffset);
+
+      else if ((example != NULL) && TokenEquals(graphFile, "u"))
+         ScanEdge(graphFile, example->graph, chunk->labelList, FALSE,
+                  vertexOffset);
+
+      else if ((example != NULL) && TokenEquals(graphFile, "d"))
+         ScanEdge(graphFile, example->graph, chunk->labelList, TRUE,
+                  vertexOffset);
+
+      else
+         graphFile->failed = TRUE;
+   }
+   return NULL;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: AddExample
+//
+// INPUTS: (ExampleGraph *example) - positive or negative examples
+//
+// RETURN: (ULONG) - vertex offset of new example
+//
+// PURPOSE: Start a new example at the end of the examples' graph,
+// allocating the graph if this is the first example.
+//---------------------------------------------------------------------------
+
+ULONG AddExample(ExampleGraph *example)
+{
+   if (example->graph == NULL)
+      example->graph = AllocateGraph(0, 0);
+   example->numEgs++;
+   example->egsVertexIndices =
+      AddVertexIndex(example->egsVertexIndices, example->numEgs,
+                     example->graph->numVertices);
+   return example->graph->numVertices;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: MergeExampleGraphs
+//
+// INPUTS: (GraphFileChunk *chunks) - chunks read, in file order
+//         (ULONG numChunks) - number of chunks
+//         (ULONG eg) - POS or NEG, the examples to merge
+//         (Graph **graph) - set to merged graph, or NULL if no examples
+//         (ULONG *numEgs) - set to number of examples
+//         (ULONG **egsVertexIndices) - set to first vertex of each example
+//
+// RETURN: (void)
+//
+// PURPOSE: Concatenate the positive or negative examples of the chunks
+// into one graph, offsetting each chunk's vertices by the vertices of
+// the chunks before it and mapping its labels through its labelMap,
+// then build the graph's vertex edge arrays.
+//---------------------------------------------------------------------------
+
+void MergeExampleGraphs(GraphFileChunk *chunks, ULONG numChunks, ULONG eg,
+                        Graph **graph, ULONG *numEgs,
+                        ULONG **egsVertexIndices)
+{
+   Graph *mergedGraph;
+   Graph *chunkGraph;
+   ExampleGraph *example;
+   ULONG *labelMap;
+   ULONG *vertexIndices;
+   Vertex *vertex;
+   Edge *edge;
+   BOOLEAN found = FALSE;
+   ULONG vertexOffset = 0;
+   ULONG edgeOffset = 0;
+   ULONG egOffset = 0;
+   ULONG i, j;
+
+   // count vertices, edges and examples of chunks
+   for (i = 0; i < numChunks; i++)
+   {
+      example = & chunks[i].examples[eg];
+      if (example->graph != NULL)
+      {
+         found = TRUE;
+         vertexOffset += example->graph->numVertices;
+         edgeOffset += example->graph->numEdges;
+         egOffset += example->numEgs;
+      }
+   }
+   *graph = NULL;
+   *numEgs = 0;
+   *egsVertexIndices = NULL;
+   if (! found)
+      return;
+   mergedGraph = AllocateGraph(vertexOffset, edgeOffset);
+   vertexIndices = (ULONG *) malloc(sizeof(ULONG) * egOffset);
+   if (vertexIndices == NULL)
+      OutOfMemoryError("MergeExampleGraphs:vertexIndices");
+   *graph = mergedGraph;
+   *numEgs = egOffset;
+   *egsVertexIndices = vertexIndices;
+
+   // copy each chunk's examples after those of the chunks before it
+   vertexOffset = 0;
+   edgeOffset = 0;
+   egOffset = 0;
+   for (i = 0; i < numChunks; i++)
+   {
+      example = & chunks[i].examples[eg];
+      chunkGraph = example->graph;
+      if (chunkGraph == NULL)
+         continue;
+      labelMap = chunks[i].labelMap;
+      for (j = 0; j < example->numEgs; j++)
+         vertexIndices[egOffset + j] =
+            example->egsVertexIndices[j] + vertexOffset;
+      for (j = 0; j < chunkGraph->numVertices; j++)
+      {
+         vertex = & mergedGraph->vertices[vertexOffset + j];
+         vertex->label = labelMap[chunkGraph->vertices[j].label];
+         vertex->numEdges = 0;
+         vertex->edges = NULL;
+         vertex->map = VERTEX_UNMAPPED;
+         vertex->used = FALSE;
+      }
+      for (j = 0; j < chunkGraph->numEdges; j++)
+      {
+         edge = & mergedGraph->edges[edgeOffset + j];
+         *edge = chunkGraph->edges[j];
+         edge->vertex1 += vertexOffset;
+         edge->vertex2 += vertexOffset;
+         edge->label = labelMap[edge->label];
+      }
+      vertexOffset += chunkGraph->numVertices;
+      edgeOffset += chunkGraph->numEdges;
+      egOffset += example->numEgs;
+   }
+   BuildVertexEdges(mergedGraph);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FreeGraphFileChunk
+//
+// INPUTS: (GraphFileChunk *chunk)
+//
+// RETURN: (void)
+//
+// PURPOSE: Free the graphs, labels and buffers of a chunk, but not the
+// file contents it shares.
+//---------------------------------------------------------------------------
+
+void FreeGraphFileChunk(GraphFileChunk *chunk)
+{
+   ULONG eg;
+   ULONG l;
+
+   for (eg = NEG; eg <= POS; eg++)
+   {
+      FreeGraph(chunk->examples[eg].graph);
+      free(chunk->examples[eg].egsVertexIndices);
+   }
+   for (l = 0; l < chunk->labelList->numLabels; l++)
+      if (chunk->labelList->labels[l].labelType == STRING_LABEL)
+         free(chunk->labelList->labels[l].labelValue.stringLabel);
+   FreeLabelList(chunk->labelList);
+   free(chunk->labelMap);
+   free(chunk->graphFile.tokenBuffer);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: IsBinaryGraphFile
+//
+// INPUTS: (GraphFile *graphFile) - newly opened graph file
+//
+// RETURN: (BOOLEAN) - TRUE if file is a binary graph file
+//
+// PURPOSE: Binary graph files, as written by WriteBinaryGraphFile, are
+// recognized by their first bytes, so they can be given wherever a
+// graph file is read.
+//---------------------------------------------------------------------------
+
+BOOLEAN IsBinaryGraphFile(GraphFile *graphFile)
+{
+   return ((graphFile->size >= strlen(BINARY_GRAPH_MAGIC)) &&
+           (memcmp(graphFile->data, BINARY_GRAPH_MAGIC,
+                   strlen(BINARY_GRAPH_MAGIC)) == 0));
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReadBinaryInputFile
+//
+// INPUTS: (GraphFile *graphFile) - opened binary graph file
+//         (Parameters *parameters)
+//
+// RETURN: (void)
+//
+// PURPOSE: Read the positive and negative graphs and examples of a
+// binary graph file into the parameters, as ReadInputFile.
+//---------------------------------------------------------------------------
+
+void ReadBinaryInputFile(GraphFile *graphFile, Parameters *parameters)
+{
+   Graph *graphs[2];
+   ULONG numEgs[2];
+   ULONG *egsVertexIndices[2];
+
+   ReadBinaryGraphFile(graphFile, parameters->inputFileName,
+                       parameters->labelList, parameters->directed,
+                       graphs, numEgs, egsVertexIndices);
+   parameters->posGraph = graphs[0];
+   parameters->negGraph = graphs[1];
+   parameters->numPosEgs = numEgs[0];
+   parameters->numNegEgs = numEgs[1];
+   parameters->posEgsVertexIndices = egsVertexIndices[0];
+   parameters->negEgsVertexIndices = egsVertexIndices[1];
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReadBinaryGraph
+//
+// INPUTS: (GraphFile *graphFile) - opened binary graph file
+//         (char *fileName) - name of file, for error messages
+//         (LabelList *labelList) - list of labels to be added to
+//         (BOOLEAN directed) - TRUE if 'e' edges should be directed
+//
+// RETURN: (Graph *) - graph read from file
+//
+// PURPOSE: Read the single graph of a binary graph file, as ReadGraph.
+// As ReadGraph does not accept example tokens, the file must have a
+// single positive example.
+//---------------------------------------------------------------------------
+
+Graph *ReadBinaryGraph(GraphFile *graphFile, char *fileName,
+                       LabelList *labelList, BOOLEAN directed)
+{
+   Graph *graphs[2];
+   ULONG numEgs[2];
+   ULONG *egsVertexIndices[2];
+
+   ReadBinaryGraphFile(graphFile, fileName, labelList, directed,
+                       graphs, numEgs, egsVertexIndices);
+   if ((numEgs[0] > 1) || (numEgs[1] > 0))
+   {
+      fprintf(stderr, "Graph file %s has more than one example.\n",
+              fileName);
+      exit(1);
+   }
+   free(egsVertexIndices[0]);
+   if (graphs[0] == NULL)
+      graphs[0] = AllocateGraph(0, 0);
+   return graphs[0];
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReadBinaryGraphFile
+//
+// INPUTS: (GraphFile *graphFile) - opened binary graph file
+//         (char *fileName) - name of file, for error messages
+//         (LabelList *labelList) - list of labels to be added to
+//         (BOOLEAN directed) - TRUE if 'e' edges should be directed
+//         (Graph **graphs) - set to positive and negative graphs, or
+//                            NULL if none
+//         (ULONG *numEgs) - set to number of positive and negative
+//                           examples
+//         (ULONG **egsVertexIndices) - set to arrays of first vertex of
+//                                      each positive and negative example
+//
+// RETURN: (void)
+//
+// PURPOSE: Read a binary graph file written by WriteBinaryGraphFile.
+// The file's labels are stored in the label list.  The graphs' edge
+// arrays and vertex edge arrays are used in place in the file's memory,
+// which is mapped copy-on-write, so they are not copied (unless the
+// file's label indices differ from the label list's, when edge labels
+// are rewritten).  The graphs share the file's memory, which is unmapped
+// when the last of them is freed (see ReleaseGraphFileMemory).  A binary
+// file that is not mapped (e.g., a compressed one) is read into memory
+// in full first.
+//---------------------------------------------------------------------------
+
+void ReadBinaryGraphFile(GraphFile *graphFile, char *fileName,
+                         LabelList *labelList, BOOLEAN directed,
+                         Graph **graphs, ULONG *numEgs,
+                         ULONG **egsVertexIndices)
+{
+   BinaryGraphHeader *header;
+   BinaryGraphSection *section;
+   GraphFileMemory *fileMemory;
+   Graph *graph;
+   Vertex *vertex;
+   Label label;
+   char *labelData;
+   ULONG *labelMap;
+   INDEX *vertexLabels;
+   ULONG *edgeStart;
+   INDEX *vertexEdges;
+   Edge *edges;
+   ULONG labelType;
+   ULONG length;
+   ULONG pos;
+   ULONG i, g, v, e;
+   BOOLEAN sameLabels;
+
+   ReadGraphFileData(graphFile);
+   if (graphFile->size < sizeof(BinaryGraphHeader))
+      BinaryGraphCorrupt(fileName);
+   header = (BinaryGraphHeader *) graphFile->data;
+   if ((header->version != BINARY_GRAPH_VERSION) ||
+       (header->byteOrder != BINARY_GRAPH_BYTE_ORDER) ||
+       (header->ulongSize != sizeof(ULONG)) ||
+       (header->indexSize != sizeof(INDEX)) ||
+       (header->edgeSize != sizeof(Edge)))
+   {
+      fprintf(stderr, "Binary graph file %s was written by another version ",
+              fileName);
+      fprintf(stderr, "or platform; convert it again.\n");
+      exit(1);
+   }
+   if (header->directed != directed)
+   {
+      fprintf(stderr, "Binary graph file %s was converted with 'e' edges ",
+              fileName);
+      fprintf(stderr, "%sdirected; convert it again%s -undirected.\n",
+              (header->directed ? "" : "un"),
+              (header->directed ? " with" : " without"));
+      exit(1);
+   }
+
+   // store labels, mapping file's label indices to label list's
+   labelData = (char *)
+      BinaryGraphSectionData(graphFile, header->labelsOffset,
+                             header->labelsSize, fileName);
+   labelMap = (ULONG *) malloc(sizeof(ULONG) * (header->numLabels + 1));
+   if (labelMap == NULL)
+      OutOfMemoryError("ReadBinaryGraphFile:labelMap");
+   sameLabels = TRUE;
+   pos = 0;
+   for (i = 0; i < header->numLabels; i++)
+   {
+      // each label is its type, then its value or its length and string
+      if ((pos > header->labelsSize) ||
+          ((header->labelsSize - pos) < (2 * BINARY_GRAPH_ALIGN)))
+         BinaryGraphCorrupt(fileName);
+      memcpy(& labelType, (labelData + pos), sizeof(ULONG));
+      pos += BINARY_GRAPH_ALIGN;
+      label.labelType = (UCHAR) labelType;
+      if (labelType == NUMERIC_LABEL)
+      {
+         memcpy(& label.labelValue.numericLabel, (labelData + pos),
+                sizeof(double));
+         pos += BINARY_GRAPH_ALIGN;
+      }
+      else if (labelType == STRING_LABEL)
+      {
+         memcpy(& length, (labelData + pos), sizeof(ULONG));
+         pos += BINARY_GRAPH_ALIGN;
+         if ((length >= (header->labelsSize - pos)) ||
+             (labelData[pos + length] != '\0'))
+            BinaryGraphCorrupt(fileName);
+         label.labelValue.stringLabel = labelData + pos;
+         pos += BinaryGraphAlign(length + 1);
+      }
+      else
+         BinaryGraphCorrupt(fileName);
+      labelMap[i] = StoreLabel(& label, labelList);
+      if (labelMap[i] != i)
+         sameLabels = FALSE;
+   }
+
+   fileMemory = (GraphFileMemory *) malloc(sizeof(GraphFileMemory));
+   if (fileMemory == NULL)
+      OutOfMemoryError("ReadBinaryGraphFile:fileMemory");
+   fileMemory->data = graphFile->data;
+   fileMemory->size = graphFile->size;
+   fileMemory->mapped = graphFile->mapped;
+   fileMemory->refCount = 0;
+   for (g = 0; g < 2; g++)
+   {
+      section = & header->graphs[g];
+      graphs[g] = NULL;
+      numEgs[g] = section->numEgs;
+      egsVertexIndices[g] = NULL;
+      if (section->numEgs == 0)
+         continue;
+      // counts larger than the file would overflow the section sizes
+      if ((section->numEgs > graphFile->size) ||
+          (section->numVertices > graphFile->size) ||
+          (section->numEdges > graphFile->size))
+         BinaryGraphCorrupt(fileName);
+
+      // examples are copied, as they are freed with the parameters
+      egsVertexIndices[g] = (ULONG *) malloc(sizeof(ULONG) * section->numEgs);
+      if (egsVertexIndices[g] == NULL)
+         OutOfMemoryError("ReadBinaryGraphFile:egsVertexIndices");
+      memcpy(egsVertexIndices[g],
+             BinaryGraphSectionData(graphFile, section->egsOffset,
+                                    sizeof(ULONG) * section->numEgs,
+                                    fileName),
+             sizeof(ULONG) * section->numEgs);
+
+      vertexLabels = (INDEX *)
+         BinaryGraphSectionData(graphFile, section->vertexLabelsOffset,
+                                sizeof(INDEX) * section->numVertices,
+                                fileName);
+      edgeStart = (ULONG *)
+         BinaryGraphSectionData(graphFile, section->edgeStartOffset,
+                                sizeof(ULONG) * (section->numVertices + 1),
+                                fileName);
+      if (edgeStart[section->numVertices] > graphFile->size)
+         BinaryGraphCorrupt(fileName);
+      vertexEdges = (INDEX *)
+         BinaryGraphSectionData(graphFile, section->vertexEdgesOffset,
+                                sizeof(INDEX) *
+                                edgeStart[section->numVertices],
+                                fileName);
+      edges = (Edge *)
+         BinaryGraphSectionData(graphFile, section->edgesOffset,
+                                sizeof(Edge) * section->numEdges, fileName);
+      CheckBinaryGraphSection(section, egsVertexIndices[g], vertexLabels,
+                              edgeStart, vertexEdges, edges,
+                              header->numLabels, fileName);
+
+      graph = AllocateGraph(section->numVertices, 0);
+      graph->edges = edges;
+      graph->numEdges = section->numEdges;
+      graph->edgeListSize = section->numEdges;
+      graph->vertexEdges = vertexEdges;
+      graph->fileMemory = fileMemory;
+      fileMemory->refCount++;
+      for (v = 0; v < graph->numVertices; v++)
+      {
+         vertex = & graph->vertices[v];
+         vertex->label = labelMap[vertexLabels[v]];
+         vertex->numEdges = edgeStart[v + 1] - edgeStart[v];
+         vertex->edges = (vertex->numEdges > 0) ?
+                         (vertexEdges + edgeStart[v]) : NULL;
+         vertex->map = VERTEX_UNMAPPED;
+         vertex->used = FALSE;
+      }
+      if (! sameLabels)
+         for (e = 0; e < graph->numEdges; e++)
+            graph->edges[e].label = labelMap[graph->edges[e].label];
+      graphs[g] = graph;
+   }
+   free(labelMap);
+
+   // file's memory now belongs to graphs, if any
+   if (fileMemory->refCount == 0)
+      free(fileMemory);
+   else
+   {
+      graphFile->data = NULL;
+      graphFile->size = 0;
+      graphFile->mapped = FALSE;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: CheckBinaryGraphSection
+//
+// INPUTS: (BinaryGraphSection *section) - graph section of file
+//         (ULONG *egsVertexIndices) - first vertex of each example
+//         (INDEX *vertexLabels) - label of each vertex
+//         (ULONG *edgeStart) - start of each vertex's edges in
+//                              vertexEdges
+//         (INDEX *vertexEdges) - edges of each vertex in turn
+//         (Edge *edges) - graph's edges
+//         (ULONG numLabels) - number of labels in file
+//         (char *fileName) - name of file, for error messages
+//
+// RETURN: (void)
+//
+// PURPOSE: Check that every index in a graph section of a binary graph
+// file is in range, so a corrupt file is reported instead of crashing a
+// later search.  The examples must start at vertex 0 and be in order,
+// every label and vertex index must exist, and each vertex's edges must
+// be existing edges that use the vertex.
+//---------------------------------------------------------------------------
+
+void CheckBinaryGraphSection(BinaryGraphSection *section,
+                             ULONG *egsVertexIndices, INDEX *vertexLabels,
+                             ULONG *edgeStart, INDEX *vertexEdges,
+                             Edge *edges, ULONG numLabels, char *fileName)
+{
+   Edge *edge;
+   ULONG i, v, e;
+
+   if (egsVertexIndices[0] != 0)
+      BinaryGraphCorrupt(fileName);
+   for (i = 1; i < section->numEgs; i++)
+      if ((egsVertexIndices[i] < egsVertexIndices[i - 1]) ||
+          (egsVertexIndices[i] > section->numVertices))
+         BinaryGraphCorrupt(fileName);
+
+   for (e = 0; e < section->numEdges; e++)
+   {
+      edge = & edges[e];
+      if ((edge->vertex1 >= section->numVertices) ||
+          (edge->vertex2 >= section->numVertices) ||
+          (edge->label >= numLabels))
+         BinaryGraphCorrupt(fileName);
+   }
+
+   if (edgeStart[0] != 0)
+      BinaryGraphCorrupt(fileName);
+   for (v = 0; v < section->numVertices; v++)
+   {
+      if ((vertexLabels[v] >= numLabels) ||
+          (edgeStart[v] > edgeStart[v + 1]))
+         BinaryGraphCorrupt(fileName);
+      for (i = edgeStart[v]; i < edgeStart[v + 1]; i++)
+      {
+         if (vertexEdges[i] >= section->numEdges)
+            BinaryGraphCorrupt(fileName);
+         edge = & edges[vertexEdges[i]];
+         if ((edge->vertex1 != v) && (edge->vertex2 != v))
+            BinaryGraphCorrupt(fileName);
+      }
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: BinaryGraphSectionData
+//
+// INPUTS: (GraphFile *graphFile) - binary graph file
+//         (ULONG offset) - offset of section in file
+//         (ULONG size) - size of section
+//         (char *fileName) - name of file, for error messages
+//
+// RETURN: (void *) - start of section in file's memory
+//
+// PURPOSE: Check that a section lies within the file and is aligned,
+// and return its address.
+//---------------------------------------------------------------------------
+
+void *BinaryGraphSectionData(GraphFile *graphFile, ULONG offset,
+                             ULONG size, char *fileName)
+{
+   if ((offset > graphFile->size) || (size > (graphFile->size - offset)) ||
+       ((offset % BINARY_GRAPH_ALIGN) != 0))
+      BinaryGraphCorrupt(fileName);
+   return (void *) (graphFile->data + offset);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: BinaryGraphCorrupt
+//
+// INPUTS: (char *fileName) - name of binary graph file
+//
+// RETURN: (void)
+//
+// PURPOSE: Report a binary graph file whose layout is not as written by
+// WriteBinaryGraphFile, and exit.
+//---------------------------------------------------------------------------
+
+void BinaryGraphCorrupt(char *fileName)
+{
+   fprintf(stderr, "Binary graph file %s is truncated or corrupt.\n",
+           fileName);
+   exit(1);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: BinaryGraphAlign
+//
+// INPUTS: (ULONG size) - size of data in binary graph file
+//
+// RETURN: (ULONG) - size rounded up to a multiple of BINARY_GRAPH_ALIGN
+//
+// PURPOSE: Every array and label in a binary graph file starts at a
+// multiple of BINARY_GRAPH_ALIGN, so it can be used in place.
+//---------------------------------------------------------------------------
+
+ULONG BinaryGraphAlign(ULONG size)
+{
+   return (((size + BINARY_GRAPH_ALIGN - 1) / BINARY_GRAPH_ALIGN) *
+           BINARY_GRAPH_ALIGN);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: WriteBinaryGraphFile
+//
+// INPUTS: (char *fileName) - binary graph file to write
+//         (Parameters *parameters) - holds graphs, examples and labels
+//                                    read from a graph file
+//
+// RETURN: (void)
+//
+// PURPOSE: Write the positive and negative graphs, their examples and
+// the label list to a binary graph file, which ReadInputFile and
+// ReadGraph can then read without parsing.  The file is written in the
+// byte order and type sizes of this platform.
+//---------------------------------------------------------------------------
+
+void WriteBinaryGraphFile(char *fileName, Parameters *parameters)
+{
+   FILE *binaryFile;
+   BinaryGraphHeader header;
+   LabelList *labelList = parameters->labelList;
+   Label *label;
+   ULONG offset;
+   ULONG length;
+   ULONG labelType;
+
+   binaryFile = fopen(fileName, "w");
+   if (binaryFile == NULL)
+   {
+      fprintf(stderr, "Unable to write binary graph file %s.\n", fileName);
+      exit(1);
+   }
+
+   memset(& header, 0, sizeof(BinaryGraphHeader));
+   memcpy(header.magic, BINARY_GRAPH_MAGIC, strlen(BINARY_GRAPH_MAGIC));
+   header.version = BINARY_GRAPH_VERSION;
+   header.byteOrder = BINARY_GRAPH_BYTE_ORDER;
+   header.ulongSize = sizeof(ULONG);
+   header.indexSize = sizeof(INDEX);
+   header.edgeSize = sizeof(Edge);
+   header.directed = parameters->directed;
+   header.numLabels = labelList->numLabels;
+   header.labelsOffset = BinaryGraphAlign(sizeof(BinaryGraphHeader));
+   header.labelsSize = BinaryGraphLabelsSize(labelList);
+
+   // sections follow label table; first pass computes their offsets
+   offset = header.labelsOffset + header.labelsSize;
+   WriteBinaryGraphSection(NULL, parameters->posGraph, parameters->numPosEgs,
+                           parameters->posEgsVertexIndices,
+                           & header.graphs[0], & offset);
+   WriteBinaryGraphSection(NULL, parameters->negGraph, parameters->numNegEgs,
+                           parameters->negEgsVertexIndices,
+                           & header.graphs[1], & offset);
+
+   WriteBinaryGraphData(binaryFile, & header, sizeof(BinaryGraphHeader));
+   for (label = labelList->labels;
+        label < (labelList->labels + labelList->numLabels); label++)
+   {
+      labelType = label->labelType;
+      WriteBinaryGraphData(binaryFile, & labelType, sizeof(ULONG));
+      if (label->labelType == NUMERIC_LABEL)
+         WriteBinaryGraphData(binaryFile, & label->labelValue.numericLabel,
+                              sizeof(double));
+      else
+      {
+         length = strlen(label->labelValue.stringLabel);
+         WriteBinaryGraphData(binaryFile, & length, sizeof(ULONG));
+         WriteBinaryGraphData(binaryFile, label->labelValue.stringLabel,
+                              length + 1);
+      }
+   }
+   offset = header.labelsOffset + header.labelsSize;
+   WriteBinaryGraphSection(binaryFile, parameters->posGraph,
+                           parameters->numPosEgs,
+                           parameters->posEgsVertexIndices,
+                           & header.graphs[0], & offset);
+   WriteBinaryGraphSection(binaryFile, parameters->negGraph,
+                           parameters->numNegEgs,
+                           parameters->negEgsVertexIndices,
+                           & header.graphs[1], & offset);
+   if (fclose(binaryFile) != 0)
+   {
+      fprintf(stderr, "Unable to write binary graph file %s.\n", fileName);
+      exit(1);
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: BinaryGraphLabelsSize
+//
+// INPUTS: (LabelList *labelList)
+//
+// RETURN: (ULONG) - size of label table in binary graph file
+//
+// PURPOSE: Each label takes its type, then its numeric value or its
+// length and NUL-terminated string, each padded to BINARY_GRAPH_ALIGN.
+//---------------------------------------------------------------------------
+
+ULONG BinaryGraphLabelsSize(LabelList *labelList)
+{
+   ULONG size = 0;
+   ULONG i;
+
+   for (i = 0; i < labelList->numLabels; i++)
+   {
+      size += BINARY_GRAPH_ALIGN;
+      if (labelList->labels[i].labelType == NUMERIC_LABEL)
+         size += BINARY_GRAPH_ALIGN;
+      else
+         size += BINARY_GRAPH_ALIGN +
+                 BinaryGraphAlign(
+                    strlen(labelList->labels[i].labelValue.stringLabel) + 1);
+   }
+   return size;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: WriteBinaryGraphSection
+//
+// INPUTS: (FILE *binaryFile) - file to write to, or NULL to only compute
+//                              section offsets
+//         (Graph *graph) - positive or negative graph, or NULL if none
+//         (ULONG numEgs) - number of examples in graph
+//         (ULONG *egsVertexIndices) - first vertex of each example
+//         (BinaryGraphSection *section) - set to location of graph's
+//                                         arrays
+//         (ULONG *offset) - offset in file of section; advanced past it
+//
+// RETURN: (void)
+//
+// PURPOSE: Write a graph's examples, vertex labels, vertex edge arrays
+// (as the start of each vertex's edges, then all of their edges) and
+// edges to a binary graph file.  Edges are written with their flags
+// cleared, as after reading a graph file.
+//---------------------------------------------------------------------------
+
+void WriteBinaryGraphSection(FILE *binaryFile, Graph *graph, ULONG numEgs,
+                             ULONG *egsVertexIndices,
+                             BinaryGraphSection *section, ULONG *offset)
+{
+   Edge edges[LIST_SIZE_INC];
+   ULONG numVertices;
+   ULONG numVertexEdges;
+   ULONG start;
+   ULONG v, e, i;
+
+   numVertices = (graph == NULL) ? 0 : graph->numVertices;
+   numVertexEdges = 0;
+   for (v = 0; v < numVertices; v++)
+      numVertexEdges += graph->vertices[v].numEdges;
+
+   section->numVertices = numVertices;
+   section->numEdges = (graph == NULL) ? 0 : graph->numEdges;
+   section->numEgs = (graph == NULL) ? 0 : numEgs;
+   section->egsOffset = *offset;
+   section->vertexLabelsOffset = section->egsOffset +
+      BinaryGraphAlign(sizeof(ULONG) * section->numEgs);
+   section->edgeStartOffset = section->vertexLabelsOffset +
+      BinaryGraphAlign(sizeof(INDEX) * numVertices);
+   section->vertexEdgesOffset = section->edgeStartOffset +
+      BinaryGraphAlign(sizeof(ULONG) * (numVertices + 1));
+   section->edgesOffset = section->vertexEdgesOffset +
+      BinaryGraphAlign(sizeof(INDEX) * numVertexEdges);
+   *offset = section->edgesOffset +
+      BinaryGraphAlign(sizeof(Edge) * section->numEdges);
+   if ((binaryFile == NULL) || (graph == NULL))
+      return;
+
+   // each array is written whole, then padded
+   fwrite(egsVertexIndices, sizeof(ULONG), numEgs, binaryFile);
+   WriteBinaryGraphData(binaryFile, NULL, sizeof(ULONG) * numEgs);
+   for (v = 0; v < numVertices; v++)
+      fwrite(& graph->vertices[v].label, sizeof(INDEX), 1, binaryFile);
+   WriteBinaryGraphData(binaryFile, NULL, sizeof(INDEX) * numVertices);
+   start = 0;
+   for (v = 0; v < numVertices; v++)
+   {
+      fwrite(& start, sizeof(ULONG), 1, binaryFile);
+      start += graph->vertices[v].numEdges;
+   }
+   fwrite(& start, sizeof(ULONG), 1, binaryFile);
+   WriteBinaryGraphData(binaryFile, NULL, sizeof(ULONG) * (numVertices + 1));
+   for (v = 0; v < numVertices; v++)
+      fwrite(graph->vertices[v].edges, sizeof(INDEX),
+             graph->vertices[v].numEdges, binaryFile);
+   WriteBinaryGraphData(binaryFile, NULL, sizeof(INDEX) * numVertexEdges);
+   // copy edges in batches, so padding bytes are written as zeros
+   memset(edges, 0, sizeof(edges));
+   for (e = 0; e < graph->numEdges; e += i)
+   {
+      for (i = 0; ((i < LIST_SIZE_INC) && ((e + i) < graph->numEdges)); i++)
+      {
+         edges[i].vertex1 = graph->edges[e + i].vertex1;
+         edges[i].vertex2 = graph->edges[e + i].vertex2;
+         edges[i].label = graph->edges[e + i].label;
+         edges[i].directed = graph->edges[e + i].directed;
+         edges[i].used = FALSE;
+         edges[i].spansIncrement = FALSE;
+         edges[i].validPath = TRUE;
+      }
+      fwrite(edges, sizeof(Edge), i, binaryFile);
+   }
+   WriteBinaryGraphData(binaryFile, NULL, sizeof(Edge) * graph->numEdges);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: WriteBinaryGraphData
+//
+// INPUTS: (FILE *binaryFile) - file to write to
+//         (void *data) - data to write, or NULL if already written
+//         (ULONG size) - size of data
+//
+// RETURN: (void)
+//
+// PURPOSE: Write data to a binary graph file, followed by zeros up to a
+// multiple of BINARY_GRAPH_ALIGN.
+//---------------------------------------------------------------------------
+
+void WriteBinaryGraphData(FILE *binaryFile, void *data, ULONG size)
+{
+   char padding[BINARY_GRAPH_ALIGN] = { 0 };
+
+   if ((data != NULL) && (size > 0))
+      fwrite(data, 1, size, binaryFile);
+   if ((size % BINARY_GRAPH_ALIGN) != 0)
+      fwrite(padding, 1, (BINARY_GRAPH_ALIGN - (size % BINARY_GRAPH_ALIGN)),
+             binaryFile);
+}
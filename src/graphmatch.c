@@ -12,6 +12,14 @@
 #define HeapLeftChild(i) ((2 * i) + 1)
 #define HeapRightChild(i) ((2 * i) + 2)
 
+// Calling thread's match workspace, allocated on first use
+static __thread MatchWorkspace *matchWorkspace = NULL;
+
+// Match cache counts of threads whose workspaces have been released
+static ULONG releasedCacheHits = 0;
+static ULONG releasedCacheMisses = 0;
+static pthread_mutex_t matchCacheCountsLock = PTHREAD_MUTEX_INITIALIZER;
+
 
 //---------------------------------------------------------------------------
 // NAME:    GraphMatch
@@ -20,6 +28,8 @@
 //          (Graph *g2) - graphs to be matched
 //          (LabelList *labelList) - list of vertex and edge labels
 //          double threshold - upper bound on match cost
+//          (ULONG matchMethod) - MATCH_SEARCH or MATCH_BIPARTITE, method
+//                                used for inexact matches
 //          double *matchCost - pointer to pass back actual cost of match;
 //                              ignored if NULL
 //          (VertexMap *mapping) - array to hold final vertex mapping;
@@ -30,25 +40,99 @@
 // PURPOSE: Returns TRUE if g1 and g2 match with cost less than the given
 // threshold.  If so, side-effects are to store the match cost in the
 // variable pointed to by matchCost and to store the mapping between g1 and
-// g2 in the given mapping input if non-NULL.
+// g2 in the given mapping input if non-NULL.  A threshold of 0.0 asks for
+// an exact match, which is found by ExactGraphMatch instead of the more
+// general InexactGraphMatch.  With MATCH_BIPARTITE, inexact matches are
+// found by the faster BipartiteGraphMatch instead, which may miss
+// matches InexactGraphMatch would find.  Before any search, the graphs'
+// invariants are compared, which rejects most non-matching pairs.  The
+// search uses the calling thread's match workspace.  When no mapping is
+// wanted and the graphs are small enough, the result is looked up in the
+// workspace's match cache, keyed by the graphs and the threshold and
+// method, and a search is only made if not found.  Compiling with
+// -DNO_MATCH_CACHE turns the cache off.
 //---------------------------------------------------------------------------
 
 BOOLEAN GraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
-                   double threshold, double *matchCost, VertexMap *mapping)
+                   double threshold, ULONG matchMethod, double *matchCost,
+                   VertexMap *mapping)
 {
+   MatchWorkspace *workspace;
    double cost;
+   MatchCacheEntry key;
+   MatchCacheEntry *entry = NULL;
 
    // first, quick check for exact matches
    if ((threshold == 0.0) &&
        ((g1->numVertices != g2->numVertices) ||
-        (g1->numEdges != g2->numEdges)))
+        (g1->numEdges != g2->numEdges) ||
+        InvariantsDiffer(g1, g2)))
       return FALSE;
 
-   // call InexactGraphMatch with larger graph first
-   if (g1->numVertices < g2->numVertices)
-      cost = InexactGraphMatch(g2, g1, labelList, threshold, mapping);
+   // reject inexact matches whose cost must exceed the threshold
+   if (threshold > 0.0)
+   {
+      if (g1->numVertices < g2->numVertices)
+         cost = MatchCostLowerBound(g2, g1);
+      else
+         cost = MatchCostLowerBound(g1, g2);
+      if (cost > threshold)
+         return FALSE;
+   }
+
+   workspace = GetMatchWorkspace();
+#ifndef NO_MATCH_CACHE
+   // cache only pairs whose encoding (at most 2 values per vertex and
+   // 5 per edge) fits in MATCH_CACHE_GRAPH_SIZE, which bounds the
+   // cache's memory
+   if ((mapping == NULL) &&
+       (((2 * (g1->numVertices + g2->numVertices)) +
+         (5 * (g1->numEdges + g2->numEdges))) <= MATCH_CACHE_GRAPH_SIZE))
+   {
+      key.code1 = CachedGraphCode(g1);
+      key.code2 = CachedGraphCode(g2);
+      key.numVertices1 = g1->numVertices;
+      key.numEdges1 = g1->numEdges;
+      key.numVertices2 = g2->numVertices;
+      key.numEdges2 = g2->numEdges;
+      key.threshold = threshold;
+      key.matchMethod = matchMethod;
+      key.graphsLength = EncodeMatchGraphs(workspace, g1, g2);
+      key.graphs = workspace->matchGraphs;
+      if (FindMatchCacheEntry(workspace, & key, & entry))
+      {
+         if (matchCost != NULL)
+            *matchCost = entry->cost;
+         return (entry->cost <= threshold);
+      }
+   }
+#endif
+   // exact matches use the dedicated exact matcher
+   if (threshold == 0.0)
+   {
+      if (ExactGraphMatch(g1, g2, mapping, workspace))
+         cost = 0.0;
+      else
+         cost = MAX_DOUBLE;
+   }
+   // call inexact matchers with larger graph first
+   else if (matchMethod == MATCH_BIPARTITE)
+   {
+      if (g1->numVertices < g2->numVertices)
+         cost = BipartiteGraphMatch(g2, g1, labelList, mapping, workspace);
+      else
+         cost = BipartiteGraphMatch(g1, g2, labelList, mapping, workspace);
+   }
+   else if (g1->numVertices < g2->numVertices)
+      cost = InexactGraphMatch(g2, g1, labelList, threshold, mapping,
+                               workspace);
    else 
-      cost = InexactGraphMatch(g1, g2, labelList, threshold, mapping);
+      cost = InexactGraphMatch(g1, g2, labelList, threshold, mapping,
+                               workspace);
+
+   // remember result in slot given by cache lookup
+   if (entry != NULL)
+      StoreMatchCacheEntry(workspace, entry, & key, cost);
 
    // pass back actual match cost, if desired
    if (matchCost != NULL)
@@ -61,6 +145,669 @@ BOOLEAN GraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
 }
 
 
+//---------------------------------------------------------------------------
+// NAME:    GraphCode
+//
+// INPUTS:  (Graph *graph) - graph to be encoded
+//
+// RETURN:  (ULONG) - code of graph; never zero
+//
+// PURPOSE: Computes a code for the graph that does not depend on the
+// order of its vertices or edges, so graphs that match exactly (i.e.,
+// GraphMatch with a threshold of 0.0) always have the same code.  Graphs
+// with different codes therefore cannot match exactly, although graphs
+// with the same code may still differ.  Each vertex starts with a code
+// based on its label, which is refined GRAPH_CODE_ROUNDS times by
+// combining it with the codes of its neighbors and the labels and
+// directions of the connecting edges.  The vertex codes are then
+// combined into the graph's code.  All combinations of codes from
+// different vertices or edges are sums, which do not depend on order.
+//---------------------------------------------------------------------------
+
+ULONG GraphCode(Graph *graph)
+{
+   ULONG *vertexCodes;
+   ULONG *neighborCodes;
+   ULONG v, e, round;
+   ULONG code;
+   Edge *edge;
+
+   vertexCodes = NULL;
+   neighborCodes = NULL;
+   if (graph->numVertices > 0)
+   {
+      vertexCodes = (ULONG *) malloc(sizeof(ULONG) * graph->numVertices);
+      neighborCodes = (ULONG *) malloc(sizeof(ULONG) * graph->numVertices);
+      if ((vertexCodes == NULL) || (neighborCodes == NULL))
+         OutOfMemoryError("GraphCode");
+   }
+   for (v = 0; v < graph->numVertices; v++)
+      vertexCodes[v] = MixCode(graph->vertices[v].label + 1);
+
+   for (round = 0; round < GRAPH_CODE_ROUNDS; round++)
+   {
+      for (v = 0; v < graph->numVertices; v++)
+         neighborCodes[v] = 0;
+      for (e = 0; e < graph->numEdges; e++)
+      {
+         // edge seen from the source (2 if directed) and the target (3 if
+         // directed) vertices; undirected edges look the same (1) from both
+         edge = & graph->edges[e];
+         code = MixCode((edge->label * 4) + (edge->directed ? 2 : 1));
+         neighborCodes[edge->vertex1] +=
+            MixCode(code + vertexCodes[edge->vertex2]);
+         code = MixCode((edge->label * 4) + (edge->directed ? 3 : 1));
+         neighborCodes[edge->vertex2] +=
+            MixCode(code + vertexCodes[edge->vertex1]);
+      }
+      for (v = 0; v < graph->numVertices; v++)
+         vertexCodes[v] = MixCode(vertexCodes[v] + MixCode(neighborCodes[v]));
+   }
+
+   code = MixCode((graph->numVertices * 31) + graph->numEdges);
+   for (v = 0; v < graph->numVertices; v++)
+      code += MixCode(vertexCodes[v]);
+   code = MixCode(code);
+   if (code == 0)
+      code = 1;
+
+   free(vertexCodes);
+   free(neighborCodes);
+   return code;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    MixCode
+//
+// INPUTS:  (ULONG code)
+//
+// RETURN:  (ULONG) - scrambled code
+//
+// PURPOSE: Scrambles the bits of the given code, so that sums of
+// scrambled codes rarely collide.
+//---------------------------------------------------------------------------
+
+ULONG MixCode(ULONG code)
+{
+   code ^= code >> 16;
+   code *= 0x85ebca6bUL;
+   code ^= code >> 13;
+   code *= 0xc2b2ae35UL;
+   code ^= code >> 16;
+   return code;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    ExactGraphMatch
+//
+// INPUTS:  (Graph *g1)
+//          (Graph *g2) - graphs to be matched, with equal numbers of
+//                        vertices and edges
+//          (VertexMap *mapping) - array to hold final vertex mapping;
+//                                 if NULL, then ignored
+//          (MatchWorkspace *workspace) - buffers used by the search
+//
+// RETURN:  (BOOLEAN) - TRUE if g1 and g2 are isomorphic
+//
+// PURPOSE: Decide whether g1 and g2 match exactly, i.e., whether
+// InexactGraphMatch would find a mapping of cost 0.0, by a depth-first
+// search in the style of VF2.  The vertices of g1 are mapped in the
+// order computed by ExactMatchOrder, so each vertex after the first of
+// a connected component has an already mapped neighbor, and only the
+// neighbors of that neighbor's image in g2 are tried as its image.  A
+// vertex is mapped only if ExactMatchFeasible accepts it, so every
+// partial mapping is itself an exact match of the mapped vertices.  The
+// search keeps one partial mapping and backtracks, instead of queueing
+// a copy of every partial mapping.  For graphs small enough to keep
+// their neighbor sets as VertexMasks, a candidate is first checked to
+// have as many mapped neighbors as v1 by counting bits.  A side-effect
+// is to store the mapping between g1 and g2 in the given mapping input
+// if non-NULL.
+//---------------------------------------------------------------------------
+
+BOOLEAN ExactGraphMatch(Graph *g1, Graph *g2, VertexMap *mapping,
+                        MatchWorkspace *workspace)
+{
+   ULONG nv1 = g1->numVertices;
+   ULONG nv2 = g2->numVertices;
+   ULONG *order;       // order in which vertices of g1 are mapped
+   ULONG *parent;      // mapped neighbor of each ordered vertex, if any
+   ULONG *nextChoice;  // next candidate to try at each depth
+   ULONG *mapped1;     // mapping of vertices in g1 to vertices in g2
+   ULONG *mapped2;     // mapping of vertices in g2 to vertices in g1
+   ULONG depth;
+   ULONG numChoices;
+   ULONG choice;
+   ULONG i, v1, v2, p2;
+   Edge *edge;
+   BOOLEAN found;
+   VertexMask *neighbors1; // neighbor sets of small graphs, else NULL
+   VertexMask *neighbors2;
+   VertexMask mappedSet1 = 0; // mapped vertices, if neighbor sets kept
+   VertexMask mappedSet2 = 0;
+
+   if (nv1 == 0)
+      return TRUE;
+
+   PrepareMatchWorkspace(workspace, nv1);
+   order = workspace->orderedVertices;
+   parent = workspace->parent;
+   nextChoice = workspace->nextChoice;
+   mapped1 = workspace->mapped1;
+   mapped2 = workspace->mapped2;
+   PrepareEdgeMarks(workspace, g2->numEdges);
+   ExactMatchOrder(g1, order, parent, workspace->vertexScratch);
+   for (i = 0; i < nv1; i++)
+      mapped1[i] = VERTEX_UNMAPPED;
+   for (i = 0; i < nv2; i++)
+      mapped2[i] = VERTEX_UNMAPPED;
+   neighbors1 = GetGraphInvariants(g1)->neighbors;
+   neighbors2 = GetGraphInvariants(g2)->neighbors;
+   if (neighbors2 == NULL)
+      neighbors1 = NULL;
+
+   depth = 0;
+   nextChoice[0] = 0;
+   while (TRUE)
+   {
+      v1 = order[depth];
+      // undo mapping tried last at this depth, if any
+      if (mapped1[v1] != VERTEX_UNMAPPED)
+      {
+         if (neighbors1 != NULL)
+         {
+            mappedSet1 &= ~ VertexBit(v1);
+            mappedSet2 &= ~ VertexBit(mapped1[v1]);
+         }
+         mapped2[mapped1[v1]] = VERTEX_UNMAPPED;
+         mapped1[v1] = VERTEX_UNMAPPED;
+      }
+      // candidates are neighbors of parent's image, else all of g2
+      p2 = VERTEX_UNMAPPED;
+      if (parent[depth] != VERTEX_UNMAPPED)
+      {
+         p2 = mapped1[parent[depth]];
+         numChoices = g2->vertices[p2].numEdges;
+      }
+      else
+         numChoices = nv2;
+      found = FALSE;
+      choice = nextChoice[depth];
+      while ((choice < numChoices) && (! found))
+      {
+         if (p2 == VERTEX_UNMAPPED)
+            v2 = choice;
+         else
+         {
+            edge = & g2->edges[g2->vertices[p2].edges[choice]];
+            if (edge->vertex1 == p2)
+               v2 = edge->vertex2;
+            else
+               v2 = edge->vertex1;
+         }
+         // v1 and v2 must have as many mapped neighbors
+         if ((mapped2[v2] == VERTEX_UNMAPPED) &&
+             ((neighbors1 == NULL) ||
+              (__builtin_popcountll(neighbors1[v1] & mappedSet1) ==
+               __builtin_popcountll(neighbors2[v2] & mappedSet2))) &&
+             ExactMatchFeasible(g1, g2, v1, v2, mapped1, mapped2,
+                                workspace->edgeUsed))
+            found = TRUE;
+         choice++;
+      }
+      if (found)
+      {
+         mapped1[v1] = v2;
+         mapped2[v2] = v1;
+         if (neighbors1 != NULL)
+         {
+            mappedSet1 |= VertexBit(v1);
+            mappedSet2 |= VertexBit(v2);
+         }
+         nextChoice[depth] = choice;
+         depth++;
+         if (depth == nv1)
+            break; // complete mapping found
+         nextChoice[depth] = 0;
+      }
+      else
+      {
+         if (depth == 0)
+            break; // all mappings tried
+         depth--;
+      }
+   }
+
+   // copy mapping to input mapping array, if available
+   if ((depth == nv1) && (mapping != NULL))
+      for (i = 0; i < nv1; i++)
+      {
+         mapping[i].v1 = order[i];
+         mapping[i].v2 = mapped1[order[i]];
+      }
+
+   return (depth == nv1);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    ExactMatchOrder
+//
+// INPUTS:  (Graph *g) - graph whose vertices are to be ordered
+//          (ULONG *order) - array to hold vertex indices in mapping order
+//          (ULONG *parent) - array to hold, for each vertex in order, an
+//                            earlier neighbor, or VERTEX_UNMAPPED
+//          (ULONG *connections) - scratch array of size of vertices
+//
+// RETURN:  (void)
+//
+// PURPOSE: Compute the order in which ExactGraphMatch maps the vertices
+// of g.  Each next vertex is the one with the most edges to the vertices
+// already ordered, breaking ties by higher degree, so that constraints
+// on a candidate mapping are checked as early as possible.
+//---------------------------------------------------------------------------
+
+void ExactMatchOrder(Graph *g, ULONG *order, ULONG *parent,
+                     ULONG *connections)
+{
+   ULONG nv = g->numVertices;
+   ULONG i, j, e;
+   ULONG v, w;
+   ULONG best;
+   Edge *edge;
+
+   for (v = 0; v < nv; v++)
+      connections[v] = 0;
+
+   for (i = 0; i < nv; i++)
+   {
+      // choose next vertex; connections of ordered vertices are MAX_UNSIGNED_LONG
+      best = VERTEX_UNMAPPED;
+      for (v = 0; v < nv; v++)
+         if ((connections[v] != MAX_UNSIGNED_LONG) &&
+             ((best == VERTEX_UNMAPPED) ||
+              (connections[v] > connections[best]) ||
+              ((connections[v] == connections[best]) &&
+               (g->vertices[v].numEdges > g->vertices[best].numEdges))))
+            best = v;
+      order[i] = best;
+      parent[i] = VERTEX_UNMAPPED;
+      for (j = 0; j < g->vertices[best].numEdges; j++)
+      {
+         e = g->vertices[best].edges[j];
+         edge = & g->edges[e];
+         if (edge->vertex1 == best)
+            w = edge->vertex2;
+         else
+            w = edge->vertex1;
+         if (connections[w] == MAX_UNSIGNED_LONG)
+         {
+            if ((w != best) && (parent[i] == VERTEX_UNMAPPED))
+               parent[i] = w;
+         }
+         else if (w != best)
+            connections[w]++;
+      }
+      connections[best] = MAX_UNSIGNED_LONG;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    ExactMatchFeasible
+//
+// INPUTS:  (Graph *g1)
+//          (Graph *g2) - graphs being matched
+//          (ULONG v1) - vertex in g1 being mapped
+//          (ULONG v2) - unmapped vertex in g2 being mapped to
+//          (ULONG *mapped1) - mapping of vertices in g1 to vertices in g2
+//          (ULONG *mapped2) - mapping of vertices in g2 to vertices in g1
+//          (BOOLEAN *edgeUsed) - marks of g2's edges, all FALSE
+//
+// RETURN:  (BOOLEAN) - TRUE if v1 -> v2 extends the exact partial mapping
+//
+// PURPOSE: Check that v1 and v2 have the same label and degree, and that
+// the edges between v1 and the mapped vertices (including self edges)
+// correspond one-to-one to those between v2 and the mapped vertices,
+// with equal labels, directedness and, for directed edges, direction.
+// Edges of g2 are marked in edgeUsed while matched, as in
+// DeletedEdgesCost, and unmarked before returning.
+//---------------------------------------------------------------------------
+
+BOOLEAN ExactMatchFeasible(Graph *g1, Graph *g2, ULONG v1, ULONG v2,
+                           ULONG *mapped1, ULONG *mapped2,
+                           BOOLEAN *edgeUsed)
+{
+   ULONG e1, e2;
+   ULONG edgeIndex2;
+   Edge *edge1, *edge2;
+   ULONG otherVertex1, otherVertex2;
+   ULONG source2, target2;
+   ULONG numMappedEdges1 = 0;
+   ULONG numMappedEdges2 = 0;
+   BOOLEAN feasible = TRUE;
+   BOOLEAN found;
+
+   if ((g1->vertices[v1].label != g2->vertices[v2].label) ||
+       (g1->vertices[v1].numEdges != g2->vertices[v2].numEdges))
+      return FALSE;
+
+   // match each edge between v1 and a mapped vertex to an edge of v2
+   for (e1 = 0; ((e1 < g1->vertices[v1].numEdges) && feasible); e1++)
+   {
+      edge1 = & g1->edges[g1->vertices[v1].edges[e1]];
+      if (edge1->vertex1 == v1)
+         otherVertex1 = edge1->vertex2;
+      else
+         otherVertex1 = edge1->vertex1;
+      if (otherVertex1 == v1)
+         otherVertex2 = v2;
+      else if (mapped1[otherVertex1] != VERTEX_UNMAPPED)
+         otherVertex2 = mapped1[otherVertex1];
+      else
+         continue;
+      numMappedEdges1++;
+      if (edge1->vertex1 == v1)
+      {
+         source2 = v2;
+         target2 = otherVertex2;
+      }
+      else
+      {
+         source2 = otherVertex2;
+         target2 = v2;
+      }
+      found = FALSE;
+      for (e2 = 0; ((e2 < g2->vertices[v2].numEdges) && (! found)); e2++)
+      {
+         edgeIndex2 = g2->vertices[v2].edges[e2];
+         edge2 = & g2->edges[edgeIndex2];
+         if ((! edgeUsed[edgeIndex2]) &&
+             (edge2->label == edge1->label) &&
+             (edge2->directed == edge1->directed) &&
+             (((edge2->vertex1 == source2) && (edge2->vertex2 == target2)) ||
+              ((! edge2->directed) &&
+               (edge2->vertex1 == target2) && (edge2->vertex2 == source2))))
+         {
+            edgeUsed[edgeIndex2] = TRUE;
+            found = TRUE;
+         }
+      }
+      if (! found)
+         feasible = FALSE;
+   }
+
+   // count edges between v2 and mapped vertices, clearing used marks
+   for (e2 = 0; e2 < g2->vertices[v2].numEdges; e2++)
+   {
+      edgeIndex2 = g2->vertices[v2].edges[e2];
+      edge2 = & g2->edges[edgeIndex2];
+      if (edge2->vertex1 == v2)
+         otherVertex2 = edge2->vertex2;
+      else
+         otherVertex2 = edge2->vertex1;
+      if ((otherVertex2 == v2) || (mapped2[otherVertex2] != VERTEX_UNMAPPED))
+         numMappedEdges2++;
+      edgeUsed[edgeIndex2] = FALSE;
+   }
+
+   return (feasible && (numMappedEdges1 == numMappedEdges2));
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    GetGraphInvariants
+//
+// INPUTS:  (Graph *graph)
+//
+// RETURN:  (GraphInvariants *) - graph's invariants
+//
+// PURPOSE: Return the graph's invariants, computing and caching them
+// in the graph if necessary.  The cache is freed by AddVertex and
+// AddEdge, so it is only computed once the graph is built.
+//---------------------------------------------------------------------------
+
+GraphInvariants *GetGraphInvariants(Graph *graph)
+{
+   GraphInvariants *invariants;
+   ULONG nv = graph->numVertices;
+   ULONG ne = graph->numEdges;
+   ULONG v, e;
+
+   if (graph->invariants != NULL)
+      return graph->invariants;
+
+   invariants = (GraphInvariants *) malloc(sizeof(GraphInvariants));
+   if (invariants == NULL)
+      OutOfMemoryError("GetGraphInvariants:invariants");
+   // one array holds vertex labels, degrees and edge keys
+   invariants->vertexLabels =
+      (ULONG *) malloc(sizeof(ULONG) * ((2 * nv) + ne + 1));
+   if (invariants->vertexLabels == NULL)
+      OutOfMemoryError("GetGraphInvariants:vertexLabels");
+   invariants->degrees = invariants->vertexLabels + nv;
+   invariants->edgeKeys = invariants->degrees + nv;
+
+   for (v = 0; v < nv; v++)
+   {
+      invariants->vertexLabels[v] = graph->vertices[v].label;
+      invariants->degrees[v] = graph->vertices[v].numEdges;
+   }
+   invariants->numDirectedEdges = 0;
+   invariants->code = 0;
+   for (e = 0; e < ne; e++)
+   {
+      invariants->edgeKeys[e] = graph->edges[e].label * 2;
+      if (graph->edges[e].directed)
+      {
+         invariants->edgeKeys[e]++;
+         invariants->numDirectedEdges++;
+      }
+   }
+   // neighbor sets of small graphs
+   invariants->neighbors = NULL;
+   if ((nv > 0) && (nv <= VERTEX_MASK_BITS))
+   {
+      invariants->neighbors = (VertexMask *) malloc(sizeof(VertexMask) * nv);
+      if (invariants->neighbors == NULL)
+         OutOfMemoryError("GetGraphInvariants:neighbors");
+      for (v = 0; v < nv; v++)
+         invariants->neighbors[v] = 0;
+      for (e = 0; e < ne; e++)
+      {
+         invariants->neighbors[graph->edges[e].vertex1] |=
+            VertexBit(graph->edges[e].vertex2);
+         invariants->neighbors[graph->edges[e].vertex2] |=
+            VertexBit(graph->edges[e].vertex1);
+      }
+   }
+   qsort(invariants->vertexLabels, nv, sizeof(ULONG), CompareULONG);
+   qsort(invariants->degrees, nv, sizeof(ULONG), CompareULONG);
+   qsort(invariants->edgeKeys, ne, sizeof(ULONG), CompareULONG);
+
+   graph->invariants = invariants;
+   return invariants;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    CompareULONG
+//
+// INPUTS:  (const void *a)
+//          (const void *b) - pointers to ULONGs
+//
+// RETURN:  (int) - negative, zero or positive as *a is less than, equal
+//                  to or greater than *b
+//
+// PURPOSE: Comparison function for sorting arrays of ULONG with qsort.
+//---------------------------------------------------------------------------
+
+int CompareULONG(const void *a, const void *b)
+{
+   ULONG x = *((const ULONG *) a);
+   ULONG y = *((const ULONG *) b);
+
+   if (x < y)
+      return -1;
+   if (x > y)
+      return 1;
+   return 0;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    InvariantsDiffer
+//
+// INPUTS:  (Graph *g1)
+//          (Graph *g2) - graphs with equal numbers of vertices and edges
+//
+// RETURN:  (BOOLEAN) - TRUE if the graphs' invariants differ
+//
+// PURPOSE: Compare the invariants of two graphs of equal size.  If they
+// differ, then the graphs cannot match exactly.
+//---------------------------------------------------------------------------
+
+BOOLEAN InvariantsDiffer(Graph *g1, Graph *g2)
+{
+   GraphInvariants *invariants1 = GetGraphInvariants(g1);
+   GraphInvariants *invariants2 = GetGraphInvariants(g2);
+   ULONG nv = g1->numVertices;
+   ULONG ne = g1->numEdges;
+
+   if ((invariants1->numDirectedEdges != invariants2->numDirectedEdges) ||
+       (memcmp(invariants1->vertexLabels, invariants2->vertexLabels,
+               sizeof(ULONG) * nv) != 0) ||
+       (memcmp(invariants1->edgeKeys, invariants2->edgeKeys,
+               sizeof(ULONG) * ne) != 0) ||
+       (memcmp(invariants1->degrees, invariants2->degrees,
+               sizeof(ULONG) * nv) != 0))
+      return TRUE;
+   return FALSE;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    MatchCostLowerBound
+//
+// INPUTS:  (Graph *g1)
+//          (Graph *g2) - graphs to be matched, in the order passed to
+//                        InexactGraphMatch
+//
+// RETURN:  (double) - lower bound on InexactGraphMatch(g1, g2)
+//
+// PURPOSE: Compute a lower bound on the cost of matching g1 to g2 from
+// their invariants.  Every vertex of the larger graph whose label has
+// no counterpart in the other graph costs at least a substitution,
+// deletion or insertion.  Likewise, every edge of g1 whose label and
+// directedness have no counterpart in g2 costs at least a substitution
+// or deletion.  Only edges of g1 are counted, because InexactGraphMatch
+// does not charge for edges of g2 between two inserted vertices.
+//---------------------------------------------------------------------------
+
+double MatchCostLowerBound(Graph *g1, Graph *g2)
+{
+   GraphInvariants *invariants1 = GetGraphInvariants(g1);
+   GraphInvariants *invariants2 = GetGraphInvariants(g2);
+   ULONG maxVertices;
+   ULONG commonVertices;
+   ULONG commonEdges;
+
+   maxVertices = g1->numVertices;
+   if (g2->numVertices > maxVertices)
+      maxVertices = g2->numVertices;
+   commonVertices = NumCommonValues(invariants1->vertexLabels, g1->numVertices,
+                                    invariants2->vertexLabels, g2->numVertices);
+   commonEdges = NumCommonValues(invariants1->edgeKeys, g1->numEdges,
+                                 invariants2->edgeKeys, g2->numEdges);
+   return ((maxVertices - commonVertices) * MIN_VERTEX_EDIT_COST) +
+          ((g1->numEdges - commonEdges) * MIN_EDGE_EDIT_COST);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    NumCommonValues
+//
+// INPUTS:  (ULONG *values1)
+//          (ULONG n1)
+//          (ULONG *values2)
+//          (ULONG n2) - sorted arrays and their lengths
+//
+// RETURN:  (ULONG) - size of the intersection of the two arrays, taken
+//                    as multisets
+//
+// PURPOSE: Count the values the two sorted arrays have in common, each
+// value counted as often as it appears in both arrays.
+//---------------------------------------------------------------------------
+
+ULONG NumCommonValues(ULONG *values1, ULONG n1, ULONG *values2, ULONG n2)
+{
+   ULONG i = 0;
+   ULONG j = 0;
+   ULONG numCommon = 0;
+
+   while ((i < n1) && (j < n2))
+   {
+      if (values1[i] < values2[j])
+         i++;
+      else if (values1[i] > values2[j])
+         j++;
+      else
+      {
+         numCommon++;
+         i++;
+         j++;
+      }
+   }
+   return numCommon;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    CachedGraphCode
+//
+// INPUTS:  (Graph *graph)
+//
+// RETURN:  (ULONG) - GraphCode of graph
+//
+// PURPOSE: Return the graph's code, which is computed the first time it
+// is needed and kept with the graph's invariants.
+//---------------------------------------------------------------------------
+
+ULONG CachedGraphCode(Graph *graph)
+{
+   GraphInvariants *invariants = GetGraphInvariants(graph);
+
+   if (invariants->code == 0)
+      invariants->code = GraphCode(graph);
+   return invariants->code;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    FreeGraphInvariants
+//
+// INPUTS:  (Graph *graph)
+//
+// RETURN:  (void)
+//
+// PURPOSE: Free the graph's cached invariants, if any.  Must be called
+// whenever the graph's structure changes.
+//---------------------------------------------------------------------------
+
+void FreeGraphInvariants(Graph *graph)
+{
+   if (graph->invariants != NULL)
+   {
+      free(graph->invariants->vertexLabels);
+      free(graph->invariants->neighbors);
+      free(graph->invariants);
+      graph->invariants = NULL;
+   }
+}
+
+
 //---------------------------------------------------------------------------
 // NAME:    InexactGraphMatch
 //
@@ -70,6 +817,7 @@ BOOLEAN GraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
 //          double threshold - upper bound on match cost
 //          (VertexMap *mapping) - array to hold final vertex mapping;
 //                                 if NULL, then ignored
+//          (MatchWorkspace *workspace) - buffers used by the search
 //
 // RETURN:  Cost of transforming g1 into an isomorphism of g2.  Will be
 //          MAX_DOUBLE if cost exceeds threshold
@@ -78,21 +826,31 @@ BOOLEAN GraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
 // isomorphism of g2, but any match cost exceeding the given threshold
 // is not considerd.  Graph g1 should be the larger graph in terms of
 // vertices.  A side-effect is to store the mapping between g1 and g2
-// in the given mapping input if non-NULL.
+// in the given mapping input if non-NULL.  Each search node's partial
+// mapping is a chain of pairs in the workspace's arena, which is
+// emptied at the start of the next match.
+//
+// The search is A*: nodes are ordered by their cost plus a lower bound
+// on the cost of mapping the remaining vertices (see
+// RemainingCostLowerBound), and nodes whose bound exceeds the threshold
+// or the best complete mapping are pruned.  Since the bound never
+// overestimates, the first complete mapping found is still optimal.
 //
 // TODO: May want to input a partial mapping to influence mapping
 // order of vertices in g1.
 //---------------------------------------------------------------------------
 
 double InexactGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
-                         double threshold, VertexMap *mapping)
+                         double threshold, VertexMap *mapping,
+                         MatchWorkspace *workspace)
 {
-   ULONG i, v1, v2;
+   ULONG i, m, v1, v2;
    ULONG nv1 = g1->numVertices;
    ULONG nv2 = g2->numVertices;
    Edge *edge;
-   MatchHeap *globalQueue = NULL;
-   MatchHeap *localQueue = NULL;
+   MatchHeap *globalQueue;
+   MatchHeap *localQueue;
+   MatchMapNode *mapNode;
    MatchHeapNode node;
    MatchHeapNode newNode;
    MatchHeapNode bestNode;
@@ -102,46 +860,56 @@ double InexactGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
    ULONG quickMatchThreshold = 0;
    BOOLEAN quickMatch = FALSE;
    BOOLEAN done = FALSE;
-   ULONG *orderedVertices = NULL;
-   ULONG *mapped1 = NULL; // mapping of vertices in g1 to vertices in g2
-   ULONG *mapped2 = NULL; // mapping of vertices in g2 to vertices in g1
+   ULONG *orderedVertices;
+   ULONG *mapped1; // mapping of vertices in g1 to vertices in g2
+   ULONG *mapped2; // mapping of vertices in g2 to vertices in g1
+   ULONG numUnmapped1 = 0;
+   ULONG numUnmapped2 = 0;
+   ULONG commonLabels = 0;
+   ULONG commonLabels2;
+   ULONG remainingEdges1 = 0;
+   ULONG availableEdges2 = 0;
+   ULONG label2;
+   VertexMask *neighbors2;
 
    // Compute threshold on mappings tried before changing from optimal
    // search to greedy search
    quickMatchThreshold = MaximumNodes(nv1);
 
+   // Take buffers and empty queues from workspace
+   if (nv1 > nv2)
+      PrepareMatchWorkspace(workspace, nv1);
+   else
+      PrepareMatchWorkspace(workspace, nv2);
+   PrepareEdgeMarks(workspace, g2->numEdges);
+   orderedVertices = workspace->orderedVertices;
+   mapped1 = workspace->mapped1;
+   mapped2 = workspace->mapped2;
+   globalQueue = workspace->globalQueue;
+   localQueue = workspace->localQueue;
+
    // Order vertices of g1 by degree
-   orderedVertices = (ULONG *) malloc(sizeof(ULONG) * nv1);
-   if (orderedVertices == NULL)
-      OutOfMemoryError("orderedVertices");
-   OrderVerticesByDegree(g1, orderedVertices);
-
-   // Allocate arrays holding vertex maps from g1 to g2 and g2 to g1
-   mapped1 = (ULONG *) malloc(sizeof(ULONG) * nv1);
-   if (mapped1 == NULL)
-      OutOfMemoryError("mapped1");
-   mapped2 = (ULONG *) malloc(sizeof(ULONG) * nv2);
-   if (mapped2 == NULL)
-      OutOfMemoryError("mapped2");
-
-   globalQueue = AllocateMatchHeap(nv1 * nv1);
-   localQueue = AllocateMatchHeap(nv1);
+   OrderVerticesByDegree(g1, orderedVertices, workspace->vertexScratch);
+   PrepareMatchBounds(g1, g2, workspace);
+   neighbors2 = GetGraphInvariants(g2)->neighbors;
+
    node.depth = 0;
    node.cost = 0.0;
-   node.mapping = NULL;
+   node.bound = 0.0;
+   node.mapping = MATCH_NO_NODE;
    InsertMatchHeapNode(& node, globalQueue);
    bestNode.depth = 0;
    bestNode.cost = MAX_DOUBLE;
-   bestNode.mapping = NULL;
+   bestNode.bound = MAX_DOUBLE;
+   bestNode.mapping = MATCH_NO_NODE;
 
    while ((! MatchHeapEmpty(globalQueue)) && (! done)) 
    {
       ExtractMatchHeapNode(globalQueue, & node);
-      if (node.cost < bestNode.cost) 
+      if (node.bound < bestNode.cost) 
       {
          if (node.depth == nv1) 
          {   // complete mapping found
-            free(bestNode.mapping);
             bestNode.cost = node.cost;
             bestNode.depth = node.depth;
             bestNode.mapping = node.mapping;
@@ -155,13 +923,23 @@ double InexactGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
                mapped1[i] = VERTEX_UNMAPPED;
             for (i = 0; i < nv2; i++)
                mapped2[i] = VERTEX_UNMAPPED;
-            for (i = 0; i < node.depth; i++) 
+            for (m = node.mapping; m != MATCH_NO_NODE; m = mapNode->parent)
             {
-               mapped1[node.mapping[i].v1] = node.mapping[i].v2;
-               if (node.mapping[i].v2 != VERTEX_DELETED)
-                  mapped2[node.mapping[i].v2] = node.mapping[i].v1;
+               mapNode = & workspace->mapNodes[m];
+               mapped1[mapNode->v1] = mapNode->v2;
+               if (mapNode->v2 != VERTEX_DELETED)
+                  mapped2[mapNode->v2] = mapNode->v1;
             }
             v1 = orderedVertices[node.depth];
+            // counts for bounding cost of vertices left after children
+            numUnmapped1 = nv1 - node.depth - 1;
+            if (numUnmapped1 > 0)
+            {
+               RemainingMatchCounts(g1, g2, node.depth + 1, mapped1, mapped2,
+                                    workspace, & commonLabels,
+                                    & remainingEdges1, & numUnmapped2,
+                                    & availableEdges2);
+            }
             // first, try mapping v1 to nothing
             newCost = node.cost + DELETE_VERTEX_COST;
             if ((newCost <= threshold) && (newCost < bestNode.cost)) 
@@ -191,13 +969,26 @@ double InexactGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
             }
             if ((newCost <= threshold) && (newCost < bestNode.cost)) 
             {
-               // add new node to local queue
-               newNode.depth = node.depth + 1;
-               newNode.cost = newCost;
-               newNode.mapping =
-                  AllocateNewMapping(node.depth + 1, node.mapping, v1,
-                                     VERTEX_DELETED);
-               InsertMatchHeapNode(& newNode, localQueue);
+               newNode.bound = newCost;
+               // edges from v1 to later vertices were charged with v1
+               if (numUnmapped1 > 0)
+                  newNode.bound +=
+                     RemainingCostLowerBound(numUnmapped1, numUnmapped2,
+                        commonLabels,
+                        remainingEdges1 -
+                           NumEdgesToLater(g1, v1, node.depth,
+                                           workspace->vertexPositions),
+                        availableEdges2);
+               if ((newNode.bound <= threshold) &&
+                   (newNode.bound < bestNode.cost))
+               {
+                  // add new node to local queue
+                  newNode.depth = node.depth + 1;
+                  newNode.cost = newCost;
+                  newNode.mapping = NewMatchMapNode(workspace, node.mapping,
+                                                    v1, VERTEX_DELETED);
+                  InsertMatchHeapNode(& newNode, localQueue);
+               }
             }
             // second, try mapping v1 to each unmapped vertex in g2
             for (v2 = 0; v2 < nv2; v2++) 
@@ -212,9 +1003,12 @@ double InexactGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
                                       g2->vertices[v2].label, labelList);
                   if ((newCost <= threshold) && (newCost < bestNode.cost)) 
                   {
-                     cost = DeletedEdgesCost(g1,g2,v1,v2,mapped1,labelList);
+                     cost = DeletedEdgesCost(g1, g2, v1, v2, mapped1,
+                                             labelList, neighbors2,
+                                             workspace->edgeUsed);
                      newCost += cost;
-                     cost = InsertedEdgesCost(g2, v2, mapped2);
+                     cost = InsertedEdgesCost(g2, v2, mapped2,
+                                              workspace->edgeUsed);
                      newCost += cost;
                   }
                   // if complete mapping, add cost for any unmapped vertices
@@ -229,18 +1023,36 @@ double InexactGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
                   }
                   if ((newCost <= threshold) && (newCost < bestNode.cost)) 
                   {
-                     // add new node to local queue
-                     newNode.depth = node.depth + 1;
-                     newNode.cost = newCost;
-                     newNode.mapping = 
-                        AllocateNewMapping(node.depth + 1,node.mapping,v1,v2);
-                     InsertMatchHeapNode(& newNode, localQueue);
+                     newNode.bound = newCost;
+                     if (numUnmapped1 > 0)
+                     {
+                        // v2 leaves the unmapped vertices of g2
+                        label2 = workspace->labelIds2[v2];
+                        commonLabels2 = commonLabels;
+                        if (workspace->labelCounts2[label2] <=
+                            workspace->labelCounts1[label2])
+                           commonLabels2--;
+                        newNode.bound +=
+                           RemainingCostLowerBound(numUnmapped1,
+                              numUnmapped2 - 1, commonLabels2, remainingEdges1,
+                              availableEdges2 -
+                                 NumEdgesToMapped(g2, v2, mapped2));
+                     }
+                     if ((newNode.bound <= threshold) &&
+                         (newNode.bound < bestNode.cost))
+                     {
+                        // add new node to local queue
+                        newNode.depth = node.depth + 1;
+                        newNode.cost = newCost;
+                        newNode.mapping =
+                           NewMatchMapNode(workspace, node.mapping, v1, v2);
+                        InsertMatchHeapNode(& newNode, localQueue);
+                     }
                   }
                   mapped1[v1] = VERTEX_UNMAPPED;
                   mapped2[v2] = VERTEX_UNMAPPED;
                }
             }
-            free(node.mapping);
             // Add nodes in localQueue to globalQueue
             if (quickMatch) 
             {
@@ -255,78 +1067,691 @@ double InexactGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
                MergeMatchHeaps(localQueue, globalQueue); // clears localQueue
          }
       } 
-      else 
-         free(node.mapping);
 
-      // check if maximum nodes exceeded, and if so, switch to greedy search
-      numNodes++;
-      if ((! quickMatch) && (numNodes > quickMatchThreshold)) 
+      // check if maximum nodes exceeded, and if so, switch to greedy search
+      numNodes++;
+      if ((! quickMatch) && (numNodes > quickMatchThreshold)) 
+      {
+         CompressMatchHeap(globalQueue, nv1, localQueue);
+         quickMatch = TRUE;
+      }
+   } // end while
+
+   // copy best mapping to input mapping array, if available; the chain
+   // holds the pairs in reverse order
+   if ((mapping != NULL) && (bestNode.mapping != MATCH_NO_NODE))
+   {
+      i = nv1;
+      for (m = bestNode.mapping; m != MATCH_NO_NODE; m = mapNode->parent)
+      {
+         mapNode = & workspace->mapNodes[m];
+         i--;
+         mapping[i].v1 = mapNode->v1;
+         mapping[i].v2 = mapNode->v2;
+      }
+   }
+
+   return bestNode.cost;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: OrderVerticesByDegree
+//
+// INPUTS: (Graph *g) - graph whose vertices are to be sorted by degree
+//         (ULONG *orderedVertices) - array to hold vertex indices
+//                                    sorted by degree
+//         (ULONG *vertexDegree) - scratch array of size of vertices
+//
+// RETURN: (void)
+//
+// PURPOSE: Compute an array of vertex indices ordered by degree.
+// Several studies have shown that matching higher degree vertices
+// first will speed up the match.
+//---------------------------------------------------------------------------
+
+void OrderVerticesByDegree(Graph *g, ULONG *orderedVertices,
+                           ULONG *vertexDegree)
+{
+   ULONG nv = g->numVertices;
+   ULONG i, j;
+   ULONG degree;
+
+   // insertion sort vertices by degree
+   for (i = 0; i < nv; i++) 
+   {
+      degree = g->vertices[i].numEdges;
+      j = i;
+      while ((j > 0) && (degree > vertexDegree[j-1])) 
+      {
+         vertexDegree[j] = vertexDegree[j-1];
+         orderedVertices[j] = orderedVertices[j-1];
+         j--;
+      }
+      vertexDegree[j] = degree;
+      orderedVertices[j] = i;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: PrepareMatchBounds
+//
+// INPUTS: (Graph *g1)
+//         (Graph *g2) - graphs being matched by InexactGraphMatch
+//         (MatchWorkspace *workspace) - workspace holding the order in
+//                                       which g1's vertices are mapped
+//
+// RETURN: (void)
+//
+// PURPOSE: Compute the per-match values used by RemainingMatchCounts.
+// The vertex labels of both graphs are numbered densely, so labels can
+// be counted in arrays, and the position of each vertex of g1 in the
+// mapping order is recorded.
+//---------------------------------------------------------------------------
+
+void PrepareMatchBounds(Graph *g1, Graph *g2, MatchWorkspace *workspace)
+{
+   ULONG nv1 = g1->numVertices;
+   ULONG nv2 = g2->numVertices;
+   ULONG *labelValues = workspace->labelValues;
+   ULONG numLabels;
+   ULONG label;
+   ULONG i, v, p;
+
+   // number distinct vertex labels of both graphs
+   numLabels = 0;
+   for (v = 0; v < nv1; v++)
+      labelValues[numLabels++] = g1->vertices[v].label;
+   for (v = 0; v < nv2; v++)
+      labelValues[numLabels++] = g2->vertices[v].label;
+   qsort(labelValues, numLabels, sizeof(ULONG), CompareULONG);
+   p = 0;
+   for (i = 0; i < numLabels; i++)
+      if ((p == 0) || (labelValues[i] != labelValues[p - 1]))
+         labelValues[p++] = labelValues[i];
+   numLabels = p;
+   workspace->numMatchLabels = numLabels;
+   for (v = 0; v < nv1; v++)
+   {
+      label = g1->vertices[v].label; // vertex labels may be narrower
+      workspace->labelIds1[v] = (ULONG *)
+         bsearch(& label, labelValues, numLabels,
+                 sizeof(ULONG), CompareULONG) - labelValues;
+   }
+   for (v = 0; v < nv2; v++)
+   {
+      label = g2->vertices[v].label;
+      workspace->labelIds2[v] = (ULONG *)
+         bsearch(& label, labelValues, numLabels,
+                 sizeof(ULONG), CompareULONG) - labelValues;
+   }
+
+   for (i = 0; i < nv1; i++)
+      workspace->vertexPositions[workspace->orderedVertices[i]] = i;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: RemainingMatchCounts
+//
+// INPUTS: (Graph *g1) - graph being mapped
+//         (Graph *g2) - graph being mapped to
+//         (ULONG depth) - number of vertices of g1 mapped or deleted
+//         (ULONG *mapped1) - mapping of vertices in g1 to vertices in g2
+//         (ULONG *mapped2) - mapping of vertices in g2 to vertices in g1
+//         (MatchWorkspace *workspace) - workspace of match
+//         (ULONG *commonLabels) - number of vertex labels, as multisets,
+//                                 common to the remaining vertices
+//         (ULONG *remainingEdges1) - number of edges of g1 not yet charged
+//         (ULONG *numUnmapped2) - number of unmapped vertices of g2
+//         (ULONG *availableEdges2) - number of edges of g2 with an
+//                                    unmapped endpoint
+//
+// RETURN: (void)
+//
+// PURPOSE: Compute the counts used by RemainingCostLowerBound for the
+// vertices of g1 from the given depth on and the unmapped vertices of
+// g2.  An edge of g1 is charged when its later endpoint is mapped, or
+// when either endpoint is deleted.  The label counts are left in the
+// workspace, so the effect of mapping one more vertex of g2 can be
+// found in constant time.
+//---------------------------------------------------------------------------
+
+void RemainingMatchCounts(Graph *g1, Graph *g2, ULONG depth,
+                          ULONG *mapped1, ULONG *mapped2,
+                          MatchWorkspace *workspace, ULONG *commonLabels,
+                          ULONG *remainingEdges1, ULONG *numUnmapped2,
+                          ULONG *availableEdges2)
+{
+   ULONG *labelCounts1 = workspace->labelCounts1;
+   ULONG *labelCounts2 = workspace->labelCounts2;
+   ULONG *position = workspace->vertexPositions;
+   ULONG numLabels = workspace->numMatchLabels;
+   ULONG i, v, e;
+   ULONG v1, v2;
+   ULONG numCommon = 0;
+   ULONG numRemaining = 0;
+   ULONG numUnmapped = 0;
+   ULONG numAvailable = 0;
+
+   for (i = 0; i < numLabels; i++)
+   {
+      labelCounts1[i] = 0;
+      labelCounts2[i] = 0;
+   }
+   for (i = depth; i < g1->numVertices; i++)
+      labelCounts1[workspace->labelIds1[workspace->orderedVertices[i]]]++;
+   for (v = 0; v < g2->numVertices; v++)
+      if (mapped2[v] == VERTEX_UNMAPPED)
+      {
+         labelCounts2[workspace->labelIds2[v]]++;
+         numUnmapped++;
+      }
+   for (i = 0; i < numLabels; i++)
+      if (labelCounts1[i] < labelCounts2[i])
+         numCommon += labelCounts1[i];
+      else
+         numCommon += labelCounts2[i];
+   for (e = 0; e < g1->numEdges; e++)
+   {
+      v1 = g1->edges[e].vertex1;
+      v2 = g1->edges[e].vertex2;
+      if ((position[v1] >= depth) || (position[v2] >= depth))
+         if ((mapped1[v1] != VERTEX_DELETED) &&
+             (mapped1[v2] != VERTEX_DELETED))
+            numRemaining++;
+   }
+   for (e = 0; e < g2->numEdges; e++)
+      if ((mapped2[g2->edges[e].vertex1] == VERTEX_UNMAPPED) ||
+          (mapped2[g2->edges[e].vertex2] == VERTEX_UNMAPPED))
+         numAvailable++;
+
+   *commonLabels = numCommon;
+   *remainingEdges1 = numRemaining;
+   *numUnmapped2 = numUnmapped;
+   *availableEdges2 = numAvailable;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: NumEdgesToLater
+//
+// INPUTS: (Graph *g1) - graph being mapped
+//         (ULONG v1) - vertex of g1 at the given depth
+//         (ULONG depth) - position of v1 in the mapping order
+//         (ULONG *position) - position of each vertex in the mapping order
+//
+// RETURN: (ULONG) - number of edges of v1 to vertices mapped after it
+//
+// PURPOSE: Count the edges of g1 that are charged early when v1 is
+// deleted.
+//---------------------------------------------------------------------------
+
+ULONG NumEdgesToLater(Graph *g1, ULONG v1, ULONG depth, ULONG *position)
+{
+   ULONG e;
+   Edge *edge;
+   ULONG numEdges = 0;
+
+   for (e = 0; e < g1->vertices[v1].numEdges; e++)
+   {
+      edge = & g1->edges[g1->vertices[v1].edges[e]];
+      if ((position[edge->vertex1] > depth) ||
+          (position[edge->vertex2] > depth))
+         numEdges++;
+   }
+   return numEdges;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: NumEdgesToMapped
+//
+// INPUTS: (Graph *g2) - graph being mapped to
+//         (ULONG v2) - unmapped vertex of g2
+//         (ULONG *mapped2) - mapping of vertices in g2 to vertices in g1
+//
+// RETURN: (ULONG) - number of edges of v2 whose other endpoint is mapped
+//                   or is v2 itself
+//
+// PURPOSE: Count the edges of g2 that no longer have an unmapped
+// endpoint once v2 is mapped.
+//---------------------------------------------------------------------------
+
+ULONG NumEdgesToMapped(Graph *g2, ULONG v2, ULONG *mapped2)
+{
+   ULONG e;
+   ULONG otherVertex;
+   Edge *edge;
+   ULONG numEdges = 0;
+
+   for (e = 0; e < g2->vertices[v2].numEdges; e++)
+   {
+      edge = & g2->edges[g2->vertices[v2].edges[e]];
+      if (edge->vertex1 == v2)
+         otherVertex = edge->vertex2;
+      else
+         otherVertex = edge->vertex1;
+      if ((otherVertex == v2) || (mapped2[otherVertex] != VERTEX_UNMAPPED))
+         numEdges++;
+   }
+   return numEdges;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: RemainingCostLowerBound
+//
+// INPUTS: (ULONG numUnmapped1) - number of vertices of g1 left to map
+//         (ULONG numUnmapped2) - number of unmapped vertices of g2
+//         (ULONG commonLabels) - number of vertex labels, as multisets,
+//                                common to those vertices
+//         (ULONG remainingEdges1) - number of edges of g1 not yet charged
+//         (ULONG availableEdges2) - number of edges of g2 with an unmapped
+//                                   endpoint
+//
+// RETURN: (double) - lower bound on cost of mapping the remaining vertices
+//
+// PURPOSE: Bound the cost InexactGraphMatch adds while mapping the
+// remaining vertices of g1.  Each remaining vertex of either graph
+// without a label counterpart in the other costs at least a deletion,
+// substitution or insertion.  Each remaining edge of g1 is charged when
+// its last endpoint is mapped, and can only be matched to an edge of g2
+// with an unmapped endpoint, so edges of g1 beyond those available in
+// g2 cost at least a deletion.  Edges of g2 are not otherwise counted,
+// because InexactGraphMatch does not charge edges of g2 between two
+// inserted vertices.
+//---------------------------------------------------------------------------
+
+double RemainingCostLowerBound(ULONG numUnmapped1, ULONG numUnmapped2,
+                               ULONG commonLabels, ULONG remainingEdges1,
+                               ULONG availableEdges2)
+{
+   double bound;
+
+   if (numUnmapped1 > numUnmapped2)
+      bound = (numUnmapped1 - commonLabels) * MIN_VERTEX_EDIT_COST;
+   else
+      bound = (numUnmapped2 - commonLabels) * MIN_VERTEX_EDIT_COST;
+   if (remainingEdges1 > availableEdges2)
+      bound += (remainingEdges1 - availableEdges2) * MIN_EDGE_EDIT_COST;
+   return bound;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: BipartiteGraphMatch
+//
+// INPUTS: (Graph *g1) - graph to be mapped
+//         (Graph *g2) - graph to be mapped to
+//         (LabelList *labelList) - list of vertex and edge labels
+//         (VertexMap *mapping) - array to hold final vertex mapping;
+//                                ignored if NULL
+//         (MatchWorkspace *workspace) - calling thread's match workspace
+//
+// RETURN: (double) - cost of the mapping found
+//
+// PURPOSE: Approximate the cost of transforming g1 into g2 in O(V^3)
+// time by solving a vertex assignment problem (Riesen and Bunke).  The
+// square cost matrix has a row for each vertex of g1 and each possible
+// inserted vertex, and a column for each vertex of g2 and each possible
+// deleted vertex.  Each entry holds the cost of the vertex edit plus
+// half the cost of matching, deleting or inserting the vertex's edges,
+// judged by the labels and directions of the edges alone; each edge is
+// shared with another vertex.  The cost returned is the actual cost of
+// the mapping read from the optimal assignment, computed as
+// InexactGraphMatch does, so it is never less than the cost found by
+// InexactGraphMatch with an unlimited threshold, and may be greater.
+//---------------------------------------------------------------------------
+
+double BipartiteGraphMatch(Graph *g1, Graph *g2, LabelList *labelList,
+                           VertexMap *mapping, MatchWorkspace *workspace)
+{
+   ULONG nv1 = g1->numVertices;
+   ULONG nv2 = g2->numVertices;
+   ULONG n = nv1 + nv2;
+   double *costs;
+   double cost;
+   double maxCost;
+   double forbiddenCost;
+   ULONG *edgeKeys1;
+   ULONG *edgeKeys2;
+   ULONG *starts1;
+   ULONG *starts2;
+   ULONG *assignment;
+   ULONG i, j, v1, v2;
+
+   if (n == 0)
+      return 0.0;
+   if (nv1 > nv2)
+      PrepareMatchWorkspace(workspace, nv1);
+   else
+      PrepareMatchWorkspace(workspace, nv2);
+   PrepareAssignmentWorkspace(workspace, n,
+                              2 * (g1->numEdges + g2->numEdges));
+   PrepareEdgeMarks(workspace, g2->numEdges);
+   costs = workspace->assignmentCosts;
+   starts1 = workspace->edgeKeyStarts1;
+   starts2 = workspace->edgeKeyStarts2;
+   assignment = workspace->vertexAssignment;
+
+   // sorted keys of the edges of each vertex of both graphs
+   edgeKeys1 = workspace->edgeKeys;
+   StoreEdgeKeys(g1, edgeKeys1, starts1);
+   edgeKeys2 = edgeKeys1 + starts1[nv1];
+   StoreEdgeKeys(g2, edgeKeys2, starts2);
+
+   // substitutions, deletions (right) and insertions (bottom)
+   maxCost = 0.0;
+   for (v1 = 0; v1 < nv1; v1++)
+      for (v2 = 0; v2 < nv2; v2++)
+      {
+         cost = SUBSTITUTE_VERTEX_LABEL_COST *
+                LabelMatchFactor(g1->vertices[v1].label,
+                                 g2->vertices[v2].label, labelList) +
+                LocalEdgesCost(edgeKeys1 + starts1[v1],
+                               starts1[v1 + 1] - starts1[v1],
+                               edgeKeys2 + starts2[v2],
+                               starts2[v2 + 1] - starts2[v2]);
+         costs[(v1 * n) + v2] = cost;
+         if (cost > maxCost)
+            maxCost = cost;
+      }
+   for (v1 = 0; v1 < nv1; v1++)
+   {
+      cost = DELETE_VERTEX_COST + (DELETE_EDGE_WITH_VERTEX_COST *
+                                   (starts1[v1 + 1] - starts1[v1]) / 2.0);
+      costs[(v1 * n) + nv2 + v1] = cost;
+      if (cost > maxCost)
+         maxCost = cost;
+   }
+   for (v2 = 0; v2 < nv2; v2++)
+   {
+      cost = INSERT_VERTEX_COST + (INSERT_EDGE_WITH_VERTEX_COST *
+                                   (starts2[v2 + 1] - starts2[v2]) / 2.0);
+      costs[((nv1 + v2) * n) + v2] = cost;
+      if (cost > maxCost)
+         maxCost = cost;
+   }
+   // any assignment using a forbidden entry costs more than one without
+   forbiddenCost = (maxCost + 1.0) * n;
+   for (i = 0; i < nv1; i++)
+      for (j = nv2; j < n; j++)
+         if ((j - nv2) != i)
+            costs[(i * n) + j] = forbiddenCost;
+   for (i = nv1; i < n; i++)
+      for (j = 0; j < n; j++)
+         if (j >= nv2)
+            costs[(i * n) + j] = 0.0;
+         else if ((i - nv1) != j)
+            costs[(i * n) + j] = forbiddenCost;
+
+   SolveAssignment(n, workspace);
+
+   // read mapping of g1's vertices from the assignment
+   for (j = 1; j <= n; j++)
+   {
+      i = workspace->columnRows[j] - 1;
+      if (i < nv1)
+      {
+         if ((j - 1) < nv2)
+            assignment[i] = j - 1;
+         else
+            assignment[i] = VERTEX_DELETED;
+      }
+   }
+   if (mapping != NULL)
+      for (v1 = 0; v1 < nv1; v1++)
+      {
+         mapping[v1].v1 = v1;
+         mapping[v1].v2 = assignment[v1];
+      }
+
+   return MappingCost(g1, g2, labelList, assignment,
+                      workspace->mapped1, workspace->mapped2,
+                      workspace->edgeUsed);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: StoreEdgeKeys
+//
+// INPUTS: (Graph *g) - graph whose edges are keyed
+//         (ULONG *edgeKeys) - array to hold keys of edges, by vertex
+//         (ULONG *starts) - array to hold start of each vertex's keys in
+//                           edgeKeys, plus the end of the last vertex's
+//
+// RETURN: (void)
+//
+// PURPOSE: Store a sorted key for each edge of each vertex, combining
+// the edge's label with its direction as seen from the vertex.  A self
+// edge is stored twice, as both of its ends are at the vertex.
+//---------------------------------------------------------------------------
+
+void StoreEdgeKeys(Graph *g, ULONG *edgeKeys, ULONG *starts)
+{
+   ULONG v, e;
+   ULONG numKeys = 0;
+   Edge *edge;
+   ULONG key;
+
+   for (v = 0; v < g->numVertices; v++)
+   {
+      starts[v] = numKeys;
+      for (e = 0; e < g->vertices[v].numEdges; e++)
       {
-         CompressMatchHeap(globalQueue, nv1);
-         quickMatch = TRUE;
+         edge = & g->edges[g->vertices[v].edges[e]];
+         key = edge->label * 4;
+         if (edge->vertex1 == edge->vertex2)
+         {
+            key += 3;
+            edgeKeys[numKeys++] = key;
+         }
+         else if (edge->directed)
+         {
+            if (edge->vertex1 == v)
+               key += 1;
+            else
+               key += 2;
+         }
+         edgeKeys[numKeys++] = key;
       }
-   } // end while
+      qsort(edgeKeys + starts[v], numKeys - starts[v], sizeof(ULONG),
+            CompareULONG);
+   }
+   starts[g->numVertices] = numKeys;
+}
 
-   // copy best mapping to input mapping array, if available
-   if ((mapping != NULL) && (bestNode.mapping != NULL))
-      for (i = 0; i < nv1; i++) 
-      {
-         mapping[i].v1 = bestNode.mapping[i].v1;
-         mapping[i].v2 = bestNode.mapping[i].v2;
-      }
 
-   // free memory
-   free(bestNode.mapping);
-   FreeMatchHeap(localQueue);
-   FreeMatchHeap(globalQueue);
-   free(mapped2);
-   free(mapped1);
-   free(orderedVertices);
+//---------------------------------------------------------------------------
+// NAME: LocalEdgesCost
+//
+// INPUTS: (ULONG *keys1) - sorted edge keys of vertex of g1
+//         (ULONG numKeys1) - number of keys of vertex of g1
+//         (ULONG *keys2) - sorted edge keys of vertex of g2
+//         (ULONG numKeys2) - number of keys of vertex of g2
+//
+// RETURN: (double) - estimated share of the cost of the vertices' edges
+//
+// PURPOSE: Estimate the cost of transforming the edges of one vertex
+// into those of another.  Edges with equal keys are matched for free,
+// the other edges are paired and substituted, and the remaining edges
+// are deleted or inserted.  Half the cost is returned, as each edge is
+// also charged at its other end.
+//---------------------------------------------------------------------------
 
-   return bestNode.cost;
+double LocalEdgesCost(ULONG *keys1, ULONG numKeys1,
+                      ULONG *keys2, ULONG numKeys2)
+{
+   ULONG numCommon;
+   double cost;
+
+   numCommon = NumCommonValues(keys1, numKeys1, keys2, numKeys2);
+   if (numKeys1 > numKeys2)
+      cost = ((numKeys2 - numCommon) * SUBSTITUTE_EDGE_LABEL_COST) +
+             ((numKeys1 - numKeys2) * DELETE_EDGE_COST);
+   else
+      cost = ((numKeys1 - numCommon) * SUBSTITUTE_EDGE_LABEL_COST) +
+             ((numKeys2 - numKeys1) * INSERT_EDGE_COST);
+   return cost / 2.0;
 }
 
 
 //---------------------------------------------------------------------------
-// NAME: OrderVerticesByDegree
+// NAME: SolveAssignment
 //
-// INPUTS: (Graph *g) - graph whose vertices are to be sorted by degree
-//         (ULONG *orderedVertices) - array to hold vertex indices
-//                                    sorted by degree
+// INPUTS: (ULONG n) - number of rows and columns of problem
+//         (MatchWorkspace *workspace) - workspace holding the n by n cost
+//                                       matrix in assignmentCosts
 //
 // RETURN: (void)
 //
-// PURPOSE: Compute an array of vertex indices ordered by degree.
-// Several studies have shown that matching higher degree vertices
-// first will speed up the match.
+// PURPOSE: Find an assignment of rows to columns of least total cost
+// with the Hungarian method, in O(n^3) time.  Rows are added one at a
+// time, each along a shortest augmenting path found with the dual
+// potentials of the rows and columns.  Rows and columns are numbered
+// from 1, so that 0 can stand for the added row's starting point.  On
+// return, columnRows[j] holds the row assigned to column j.
 //---------------------------------------------------------------------------
 
-void OrderVerticesByDegree(Graph *g, ULONG *orderedVertices)
+void SolveAssignment(ULONG n, MatchWorkspace *workspace)
 {
-   ULONG nv = g->numVertices;
-   ULONG i, j;
-   ULONG degree;
-   ULONG *vertexDegree = NULL;
+   double *costs = workspace->assignmentCosts;
+   double *u = workspace->rowPotentials;
+   double *v = workspace->columnPotentials;
+   double *minima = workspace->columnMinima;
+   ULONG *rows = workspace->columnRows;
+   ULONG *ways = workspace->columnWays;
+   BOOLEAN *used = workspace->columnUsed;
+   ULONG i, j, i0, j0, j1;
+   double delta;
+   double reducedCost;
+
+   for (j = 0; j <= n; j++)
+   {
+      u[j] = 0.0;
+      v[j] = 0.0;
+      rows[j] = 0;
+      ways[j] = 0;
+   }
+   for (i = 1; i <= n; i++)
+   {
+      rows[0] = i;
+      j0 = 0;
+      for (j = 0; j <= n; j++)
+      {
+         minima[j] = MAX_DOUBLE;
+         used[j] = FALSE;
+      }
+      // grow tree of shortest paths until a free column is reached
+      do
+      {
+         used[j0] = TRUE;
+         i0 = rows[j0];
+         delta = MAX_DOUBLE;
+         j1 = 0;
+         for (j = 1; j <= n; j++)
+            if (! used[j])
+            {
+               reducedCost = costs[((i0 - 1) * n) + (j - 1)] - u[i0] - v[j];
+               if (reducedCost < minima[j])
+               {
+                  minima[j] = reducedCost;
+                  ways[j] = j0;
+               }
+               if (minima[j] < delta)
+               {
+                  delta = minima[j];
+                  j1 = j;
+               }
+            }
+         for (j = 0; j <= n; j++)
+            if (used[j])
+            {
+               u[rows[j]] += delta;
+               v[j] -= delta;
+            }
+            else
+               minima[j] -= delta;
+         j0 = j1;
+      } while (rows[j0] != 0);
+      // augment along path back to starting point
+      do
+      {
+         j1 = ways[j0];
+         rows[j0] = rows[j1];
+         j0 = j1;
+      } while (j0 != 0);
+   }
+}
 
-   vertexDegree = (ULONG *) malloc(sizeof(ULONG) * nv);
-   if (vertexDegree == NULL)
-      OutOfMemoryError("vertexDegree");
 
-   // insertion sort vertices by degree
-   for (i = 0; i < nv; i++) 
+//---------------------------------------------------------------------------
+// NAME: MappingCost
+//
+// INPUTS: (Graph *g1) - graph being mapped
+//         (Graph *g2) - graph being mapped to
+//         (LabelList *labelList) - list of vertex and edge labels
+//         (ULONG *assignment) - vertex of g2, or VERTEX_DELETED, for each
+//                               vertex of g1
+//         (ULONG *mapped1)
+//         (ULONG *mapped2) - scratch arrays of size of g1 and g2
+//         (BOOLEAN *edgeUsed) - marks of g2's edges, all FALSE
+//
+// RETURN: (double) - cost of transforming g1 into g2 under assignment
+//
+// PURPOSE: Compute the cost of a complete mapping, charging each vertex
+// of g1 in turn as InexactGraphMatch charges the nodes of its search.
+//---------------------------------------------------------------------------
+
+double MappingCost(Graph *g1, Graph *g2, LabelList *labelList,
+                   ULONG *assignment, ULONG *mapped1, ULONG *mapped2,
+                   BOOLEAN *edgeUsed)
+{
+   ULONG v1, v2, e;
+   ULONG otherVertex;
+   Edge *edge;
+   double cost = 0.0;
+
+   for (v1 = 0; v1 < g1->numVertices; v1++)
+      mapped1[v1] = VERTEX_UNMAPPED;
+   for (v2 = 0; v2 < g2->numVertices; v2++)
+      mapped2[v2] = VERTEX_UNMAPPED;
+   for (v1 = 0; v1 < g1->numVertices; v1++)
    {
-      degree = g->vertices[i].numEdges;
-      j = i;
-      while ((j > 0) && (degree > vertexDegree[j-1])) 
+      v2 = assignment[v1];
+      if (v2 == VERTEX_DELETED)
       {
-         vertexDegree[j] = vertexDegree[j-1];
-         orderedVertices[j] = orderedVertices[j-1];
-         j--;
+         cost += DELETE_VERTEX_COST;
+         for (e = 0; e < g1->vertices[v1].numEdges; e++)
+         {
+            edge = & g1->edges[g1->vertices[v1].edges[e]];
+            if (v1 == edge->vertex1)
+               otherVertex = edge->vertex2;
+            else
+               otherVertex = edge->vertex1;
+            if ((mapped1[otherVertex] != VERTEX_DELETED) ||
+                (otherVertex == v1))
+               cost += DELETE_EDGE_WITH_VERTEX_COST;
+         }
+         mapped1[v1] = VERTEX_DELETED;
+      }
+      else
+      {
+         mapped1[v1] = v2;
+         mapped2[v2] = v1;
+         cost += SUBSTITUTE_VERTEX_LABEL_COST *
+                 LabelMatchFactor(g1->vertices[v1].label,
+                                  g2->vertices[v2].label, labelList);
+         cost += DeletedEdgesCost(g1, g2, v1, v2, mapped1, labelList,
+                                  GetGraphInvariants(g2)->neighbors,
+                                  edgeUsed);
+         cost += InsertedEdgesCost(g2, v2, mapped2, edgeUsed);
       }
-      vertexDegree[j] = degree;
-      orderedVertices[j] = i;
    }
-   free(vertexDegree);
+   cost += InsertedVerticesCost(g2, mapped2);
+   return cost;
 }
 
 
@@ -361,21 +1786,28 @@ ULONG MaximumNodes(ULONG n)
 //         (ULONG v2) - vertex in g2 being mapped
 //         (ULONG *mapped1) - mapping of vertices in g1 to vertices in g2
 //         (LabelList *labelList) - label list containing labels for g1 and g2
+//         (VertexMask *neighbors2) - neighbors of g2's vertices, or NULL
+//         (BOOLEAN *edgeUsed) - marks of g2's edges
 //
 // RETURN: (double) - cost of match edges according to given mapping
 //
 // PURPOSE: Compute the cost of matching edges involved in the new
 // mapping, which has just added v1 -> v2.  In the case of multiple
 // edges between two vertices, do a greedy search to find a low-cost
-// mapping of edges to edges.
+// mapping of edges to edges, marking the matched edges of g2 in
+// edgeUsed.  If g2's neighbor sets are given, v2's edges are only
+// searched for vertices adjacent to v2.
 //
 // NOTE: Assumes InsertedEdgesCost() run right after this one.
 //---------------------------------------------------------------------------
 
 double DeletedEdgesCost(Graph *g1, Graph *g2, ULONG v1, ULONG v2,
-                        ULONG *mapped1, LabelList *labelList)
+                        ULONG *mapped1, LabelList *labelList,
+                        VertexMask *neighbors2, BOOLEAN *edgeUsed)
 {
    ULONG e1, e2;
+   ULONG edgeIndex2;
+   ULONG numEdges2;
    Edge *edge1, *edge2;
    ULONG otherVertex1, otherVertex2;
    Edge *bestMatchEdge;
@@ -398,10 +1830,15 @@ double DeletedEdgesCost(Graph *g1, Graph *g2, ULONG v1, ULONG v2,
          bestMatchEdge = NULL;
          bestMatchCost = -1.0;
          otherVertex2 = mapped1[otherVertex1];
-         for (e2 = 0; e2 < g2->vertices[v2].numEdges; e2++) 
+         numEdges2 = g2->vertices[v2].numEdges;
+         if ((neighbors2 != NULL) &&
+             ((neighbors2[v2] & VertexBit(otherVertex2)) == 0))
+            numEdges2 = 0; // no edge between v2 and otherVertex2
+         for (e2 = 0; e2 < numEdges2; e2++) 
          {
-            edge2 = & g2->edges[g2->vertices[v2].edges[e2]];
-            if ((! edge2->used) &&
+            edgeIndex2 = g2->vertices[v2].edges[e2];
+            edge2 = & g2->edges[edgeIndex2];
+            if ((! edgeUsed[edgeIndex2]) &&
                 (((edge2->vertex1 == otherVertex2) && (edge2->vertex2 == v2)) ||
                 ((edge2->vertex1 == v2) && (edge2->vertex2 == otherVertex2)))) 
             {
@@ -429,7 +1866,7 @@ double DeletedEdgesCost(Graph *g1, Graph *g2, ULONG v1, ULONG v2,
          // else add cost of deleting edge from g1
          if (bestMatchEdge != NULL) 
          {
-            bestMatchEdge->used = TRUE;
+            edgeUsed[bestMatchEdge - g2->edges] = TRUE;
             totalCost += bestMatchCost;
          } 
          else 
@@ -446,6 +1883,7 @@ double DeletedEdgesCost(Graph *g1, Graph *g2, ULONG v1, ULONG v2,
 // INPUTS: (Graph *g2) - graph containing vertex being mapped to
 //         (ULONG v2) - vertex in g2 being mapped to
 //         (ULONG *mapped2) - array mapping vertices of g2 to vertices of g1
+//         (BOOLEAN *edgeUsed) - marks of g2's edges
 //
 // RETURN: (double) - cost of inserting edges found in g2 between v2
 //                    and another mapped vertex, but not matched to
@@ -454,24 +1892,28 @@ double DeletedEdgesCost(Graph *g1, Graph *g2, ULONG v1, ULONG v2,
 // PURPOSE: Compute the cost of adding edges to the transformation
 // from g1 to g2 for edges in g2 that are between v2 and another mapped
 // vertex, but are not matched to edges in g1 by DeleteEdgesCost().
+// Clears the marks of v2's edges.
 //
 // NOTE: Assumes DeletedEdgesCost() run before this one.
 //---------------------------------------------------------------------------
 
-double InsertedEdgesCost(Graph *g2, ULONG v2, ULONG *mapped2)
+double InsertedEdgesCost(Graph *g2, ULONG v2, ULONG *mapped2,
+                         BOOLEAN *edgeUsed)
 {
    ULONG e2;
+   ULONG edgeIndex2;
    Edge *edge2;
    double totalCost = 0.0;
 
    for (e2 = 0; e2 < g2->vertices[v2].numEdges; e2++) 
    {
-      edge2 = & g2->edges[g2->vertices[v2].edges[e2]];
-      if ((! edge2->used) &&
+      edgeIndex2 = g2->vertices[v2].edges[e2];
+      edge2 = & g2->edges[edgeIndex2];
+      if ((! edgeUsed[edgeIndex2]) &&
           (mapped2[edge2->vertex1] != VERTEX_UNMAPPED) &&
           (mapped2[edge2->vertex2] != VERTEX_UNMAPPED))
          totalCost += INSERT_EDGE_COST;
-      edge2->used = FALSE;
+      edgeUsed[edgeIndex2] = FALSE;
    }
    return totalCost;
 }
@@ -519,6 +1961,527 @@ double InsertedVerticesCost(Graph *g2, ULONG *mapped2)
 }
 
 
+//---------------------------------------------------------------------------
+// Match Workspace Functions
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+// NAME: GetMatchWorkspace
+//
+// INPUTS: (void)
+//
+// RETURN: (MatchWorkspace *) - calling thread's match workspace
+//
+// PURPOSE: Return the calling thread's match workspace, allocating it
+// on first use.  The vertex buffers are allocated by
+// PrepareMatchWorkspace, and the assignment buffers by
+// PrepareAssignmentWorkspace.
+//---------------------------------------------------------------------------
+
+MatchWorkspace *GetMatchWorkspace(void)
+{
+   MatchWorkspace *workspace = matchWorkspace;
+
+   if (workspace == NULL)
+   {
+      workspace = (MatchWorkspace *) malloc(sizeof(MatchWorkspace));
+      if (workspace == NULL)
+         OutOfMemoryError("GetMatchWorkspace:workspace");
+      workspace->vertexListSize = 0;
+      workspace->orderedVertices = NULL;
+      workspace->mapped1 = NULL;
+      workspace->mapped2 = NULL;
+      workspace->parent = NULL;
+      workspace->nextChoice = NULL;
+      workspace->edgeListSize = 0;
+      workspace->edgeUsed = NULL;
+      workspace->vertexScratch = NULL;
+      workspace->vertexAssignment = NULL;
+      workspace->numMatchLabels = 0;
+      workspace->labelValues = NULL;
+      workspace->labelIds1 = NULL;
+      workspace->labelIds2 = NULL;
+      workspace->labelCounts1 = NULL;
+      workspace->labelCounts2 = NULL;
+      workspace->vertexPositions = NULL;
+      workspace->assignmentSize = 0;
+      workspace->assignmentCosts = NULL;
+      workspace->rowPotentials = NULL;
+      workspace->columnPotentials = NULL;
+      workspace->columnMinima = NULL;
+      workspace->columnRows = NULL;
+      workspace->columnWays = NULL;
+      workspace->columnUsed = NULL;
+      workspace->edgeKeyStarts1 = NULL;
+      workspace->edgeKeyStarts2 = NULL;
+      workspace->edgeKeyListSize = 0;
+      workspace->edgeKeys = NULL;
+      workspace->globalQueue = AllocateMatchHeap(LIST_SIZE_INC);
+      workspace->localQueue = AllocateMatchHeap(LIST_SIZE_INC);
+      workspace->mapNodeListSize = LIST_SIZE_INC;
+      workspace->numMapNodes = 0;
+      workspace->mapNodes =
+         (MatchMapNode *) malloc(sizeof(MatchMapNode) * LIST_SIZE_INC);
+      if (workspace->mapNodes == NULL)
+         OutOfMemoryError("GetMatchWorkspace:mapNodes");
+      workspace->matchCache = (MatchCacheEntry *)
+         calloc(MATCH_CACHE_SETS * MATCH_CACHE_WAYS, sizeof(MatchCacheEntry));
+      if (workspace->matchCache == NULL)
+         OutOfMemoryError("GetMatchWorkspace:matchCache");
+      workspace->matchCacheClock = 0;
+      workspace->matchCacheHits = 0;
+      workspace->matchCacheMisses = 0;
+      workspace->matchGraphsSize = 0;
+      workspace->matchGraphs = NULL;
+      matchWorkspace = workspace;
+   }
+   return workspace;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: PrepareMatchWorkspace
+//
+// INPUTS: (MatchWorkspace *workspace)
+//         (ULONG numVertices) - number of vertices of larger graph
+//
+// RETURN: (void)
+//
+// PURPOSE: Make the workspace ready for a new match: grow the vertex
+// buffers to hold numVertices vertices if necessary, and empty the
+// search queues and the arena of partial mappings.  Buffers indexed by
+// label or depth hold up to the vertices of both graphs, plus one.
+//---------------------------------------------------------------------------
+
+void PrepareMatchWorkspace(MatchWorkspace *workspace, ULONG numVertices)
+{
+   ULONG size;
+   ULONG size2;
+
+   if (numVertices > workspace->vertexListSize)
+   {
+      size = sizeof(ULONG) * numVertices;
+      workspace->orderedVertices =
+         (ULONG *) realloc(workspace->orderedVertices, size);
+      workspace->mapped1 = (ULONG *) realloc(workspace->mapped1, size);
+      workspace->mapped2 = (ULONG *) realloc(workspace->mapped2, size);
+      workspace->parent = (ULONG *) realloc(workspace->parent, size);
+      workspace->nextChoice = (ULONG *) realloc(workspace->nextChoice, size);
+      workspace->vertexScratch =
+         (ULONG *) realloc(workspace->vertexScratch, size);
+      workspace->vertexAssignment =
+         (ULONG *) realloc(workspace->vertexAssignment, size);
+      workspace->labelIds1 = (ULONG *) realloc(workspace->labelIds1, size);
+      workspace->labelIds2 = (ULONG *) realloc(workspace->labelIds2, size);
+      workspace->vertexPositions =
+         (ULONG *) realloc(workspace->vertexPositions, size);
+      size2 = sizeof(ULONG) * ((2 * numVertices) + 1);
+      workspace->labelValues =
+         (ULONG *) realloc(workspace->labelValues, size2);
+      workspace->labelCounts1 =
+         (ULONG *) realloc(workspace->labelCounts1, size2);
+      workspace->labelCounts2 =
+         (ULONG *) realloc(workspace->labelCounts2, size2);
+      if ((workspace->orderedVertices == NULL) ||
+          (workspace->mapped1 == NULL) || (workspace->mapped2 == NULL) ||
+          (workspace->parent == NULL) || (workspace->nextChoice == NULL) ||
+          (workspace->vertexScratch == NULL) ||
+          (workspace->vertexAssignment == NULL) ||
+          (workspace->labelIds1 == NULL) || (workspace->labelIds2 == NULL) ||
+          (workspace->vertexPositions == NULL) ||
+          (workspace->labelValues == NULL) ||
+          (workspace->labelCounts1 == NULL) ||
+          (workspace->labelCounts2 == NULL))
+         OutOfMemoryError("PrepareMatchWorkspace");
+      workspace->vertexListSize = numVertices;
+   }
+   ClearMatchHeap(workspace->globalQueue);
+   ClearMatchHeap(workspace->localQueue);
+   workspace->numMapNodes = 0;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: PrepareEdgeMarks
+//
+// INPUTS: (MatchWorkspace *workspace)
+//         (ULONG numEdges) - number of edges of graph being matched to
+//
+// RETURN: (void)
+//
+// PURPOSE: Grow the workspace's edge marks, if necessary, to hold
+// numEdges edges.  The marks are FALSE between uses.  The matchers
+// mark the edges of g2 here rather than in g2, which other threads
+// may be matching at the same time.
+//---------------------------------------------------------------------------
+
+void PrepareEdgeMarks(MatchWorkspace *workspace, ULONG numEdges)
+{
+   ULONG e;
+
+   if (numEdges > workspace->edgeListSize)
+   {
+      workspace->edgeUsed = (BOOLEAN *)
+         realloc(workspace->edgeUsed, sizeof(BOOLEAN) * numEdges);
+      if (workspace->edgeUsed == NULL)
+         OutOfMemoryError("PrepareEdgeMarks:edgeUsed");
+      for (e = workspace->edgeListSize; e < numEdges; e++)
+         workspace->edgeUsed[e] = FALSE;
+      workspace->edgeListSize = numEdges;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: PrepareAssignmentWorkspace
+//
+// INPUTS: (MatchWorkspace *workspace)
+//         (ULONG size) - number of rows and columns of assignment problem
+//         (ULONG numEdgeKeys) - number of edge keys of both graphs
+//
+// RETURN: (void)
+//
+// PURPOSE: Grow the buffers used by BipartiteGraphMatch, if necessary,
+// to hold a size by size assignment problem and the given number of
+// edge keys.
+//---------------------------------------------------------------------------
+
+void PrepareAssignmentWorkspace(MatchWorkspace *workspace, ULONG size,
+                                ULONG numEdgeKeys)
+{
+   ULONG n;
+
+   if (size > workspace->assignmentSize)
+   {
+      n = size + 1;
+      workspace->assignmentCosts = (double *)
+         realloc(workspace->assignmentCosts, sizeof(double) * size * size);
+      workspace->rowPotentials = (double *)
+         realloc(workspace->rowPotentials, sizeof(double) * n);
+      workspace->columnPotentials = (double *)
+         realloc(workspace->columnPotentials, sizeof(double) * n);
+      workspace->columnMinima = (double *)
+         realloc(workspace->columnMinima, sizeof(double) * n);
+      workspace->columnRows = (ULONG *)
+         realloc(workspace->columnRows, sizeof(ULONG) * n);
+      workspace->columnWays = (ULONG *)
+         realloc(workspace->columnWays, sizeof(ULONG) * n);
+      workspace->columnUsed = (BOOLEAN *)
+         realloc(workspace->columnUsed, sizeof(BOOLEAN) * n);
+      workspace->edgeKeyStarts1 = (ULONG *)
+         realloc(workspace->edgeKeyStarts1, sizeof(ULONG) * n);
+      workspace->edgeKeyStarts2 = (ULONG *)
+         realloc(workspace->edgeKeyStarts2, sizeof(ULONG) * n);
+      if ((workspace->assignmentCosts == NULL) ||
+          (workspace->rowPotentials == NULL) ||
+          (workspace->columnPotentials == NULL) ||
+          (workspace->columnMinima == NULL) ||
+          (workspace->columnRows == NULL) ||
+          (workspace->columnWays == NULL) ||
+          (workspace->columnUsed == NULL) ||
+          (workspace->edgeKeyStarts1 == NULL) ||
+          (workspace->edgeKeyStarts2 == NULL))
+         OutOfMemoryError("PrepareAssignmentWorkspace");
+      workspace->assignmentSize = size;
+   }
+   if (numEdgeKeys > workspace->edgeKeyListSize)
+   {
+      workspace->edgeKeys = (ULONG *)
+         realloc(workspace->edgeKeys, sizeof(ULONG) * numEdgeKeys);
+      if (workspace->edgeKeys == NULL)
+         OutOfMemoryError("PrepareAssignmentWorkspace:edgeKeys");
+      workspace->edgeKeyListSize = numEdgeKeys;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: NewMatchMapNode
+//
+// INPUTS: (MatchWorkspace *workspace)
+//         (ULONG parent) - last pair of partial mapping to be augmented,
+//                          or MATCH_NO_NODE
+//         (ULONG v1)
+//         (ULONG v2) - new mapping includes v1 -> v2
+//
+// RETURN: (ULONG) - index in arena of new mapping's last pair
+//
+// PURPOSE: Add the pair v1 -> v2 to the workspace's arena, extending
+// the given partial mapping, which is shared rather than copied.
+//---------------------------------------------------------------------------
+
+ULONG NewMatchMapNode(MatchWorkspace *workspace, ULONG parent,
+                      ULONG v1, ULONG v2)
+{
+   MatchMapNode *mapNodes;
+   ULONG index = workspace->numMapNodes;
+
+   if (index == workspace->mapNodeListSize)
+   {
+      workspace->mapNodeListSize *= 2;
+      mapNodes = (MatchMapNode *) realloc(workspace->mapNodes,
+                    sizeof(MatchMapNode) * workspace->mapNodeListSize);
+      if (mapNodes == NULL)
+         OutOfMemoryError("NewMatchMapNode:mapNodes");
+      workspace->mapNodes = mapNodes;
+   }
+   workspace->mapNodes[index].v1 = v1;
+   workspace->mapNodes[index].v2 = v2;
+   workspace->mapNodes[index].parent = parent;
+   workspace->numMapNodes++;
+   return index;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReleaseMatchWorkspace
+//
+// INPUTS: (void)
+//
+// RETURN: (void)
+//
+// PURPOSE: Free the calling thread's match workspace, if any, adding
+// its match cache counts to those of released workspaces.  Should be
+// called by a thread before it exits.
+//---------------------------------------------------------------------------
+
+void ReleaseMatchWorkspace(void)
+{
+   MatchWorkspace *workspace = matchWorkspace;
+   ULONG i;
+
+   if (workspace != NULL)
+   {
+      pthread_mutex_lock(& matchCacheCountsLock);
+      releasedCacheHits += workspace->matchCacheHits;
+      releasedCacheMisses += workspace->matchCacheMisses;
+      pthread_mutex_unlock(& matchCacheCountsLock);
+      free(workspace->orderedVertices);
+      free(workspace->mapped1);
+      free(workspace->mapped2);
+      free(workspace->parent);
+      free(workspace->nextChoice);
+      free(workspace->edgeUsed);
+      free(workspace->vertexScratch);
+      free(workspace->vertexAssignment);
+      free(workspace->labelValues);
+      free(workspace->labelIds1);
+      free(workspace->labelIds2);
+      free(workspace->labelCounts1);
+      free(workspace->labelCounts2);
+      free(workspace->vertexPositions);
+      free(workspace->assignmentCosts);
+      free(workspace->rowPotentials);
+      free(workspace->columnPotentials);
+      free(workspace->columnMinima);
+      free(workspace->columnRows);
+      free(workspace->columnWays);
+      free(workspace->columnUsed);
+      free(workspace->edgeKeyStarts1);
+      free(workspace->edgeKeyStarts2);
+      free(workspace->edgeKeys);
+      FreeMatchHeap(workspace->globalQueue);
+      FreeMatchHeap(workspace->localQueue);
+      free(workspace->mapNodes);
+      for (i = 0; i < (MATCH_CACHE_SETS * MATCH_CACHE_WAYS); i++)
+         free(workspace->matchCache[i].graphs);
+      free(workspace->matchCache);
+      free(workspace->matchGraphs);
+      free(workspace);
+      matchWorkspace = NULL;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: EncodeMatchGraphs
+//
+// INPUTS: (MatchWorkspace *workspace)
+//         (Graph *g1)
+//         (Graph *g2) - graphs being matched
+//
+// RETURN: (ULONG) - length of encoding
+//
+// PURPOSE: Encode the two graphs into the workspace's matchGraphs
+// buffer: each vertex's label and edges, then each edge's vertices,
+// label and direction.  Graphs with the same encoding are the same
+// graph as far as the matchers are concerned, so a cached result is
+// only used for graphs with the same encoding as the graphs it was
+// computed for.
+//---------------------------------------------------------------------------
+
+ULONG EncodeMatchGraphs(MatchWorkspace *workspace, Graph *g1, Graph *g2)
+{
+   Graph *graphs[2];
+   Graph *graph;
+   Vertex *vertex;
+   Edge *edge;
+   ULONG *buffer;
+   ULONG length;
+   ULONG g, v, e;
+
+   // find length of encoding and make room for it
+   graphs[0] = g1;
+   graphs[1] = g2;
+   length = 0;
+   for (g = 0; g < 2; g++)
+   {
+      graph = graphs[g];
+      length += (2 * graph->numVertices) + (3 * graph->numEdges);
+      for (v = 0; v < graph->numVertices; v++)
+         length += graph->vertices[v].numEdges;
+   }
+   if (length > workspace->matchGraphsSize)
+   {
+      workspace->matchGraphs =
+         (ULONG *) realloc(workspace->matchGraphs, sizeof(ULONG) * length);
+      if (workspace->matchGraphs == NULL)
+         OutOfMemoryError("EncodeMatchGraphs:matchGraphs");
+      workspace->matchGraphsSize = length;
+   }
+
+   buffer = workspace->matchGraphs;
+   for (g = 0; g < 2; g++)
+   {
+      graph = graphs[g];
+      for (v = 0; v < graph->numVertices; v++)
+      {
+         vertex = & graph->vertices[v];
+         *buffer++ = vertex->label;
+         *buffer++ = vertex->numEdges;
+         for (e = 0; e < vertex->numEdges; e++)
+            *buffer++ = vertex->edges[e];
+      }
+      for (e = 0; e < graph->numEdges; e++)
+      {
+         edge = & graph->edges[e];
+         *buffer++ = edge->vertex1;
+         *buffer++ = edge->vertex2;
+         *buffer++ = (edge->label * 2) + (edge->directed ? 1 : 0);
+      }
+   }
+   return length;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FindMatchCacheEntry
+//
+// INPUTS: (MatchWorkspace *workspace)
+//         (MatchCacheEntry *key) - entry whose key fields are set
+//         (MatchCacheEntry **entry) - pointer to pass back entry found,
+//                                     or slot to store the result in
+//
+// RETURN: (BOOLEAN) - TRUE if an entry with the key was found
+//
+// PURPOSE: Look up the key in the workspace's match cache.  The key
+// selects a set of MATCH_CACHE_WAYS entries.  An entry holds the key
+// only if its graphs' encoding is the same as the key's, so graphs with
+// the same codes but different structure never share a result.  If
+// none of them holds the key, the unused or least recently used entry
+// of the set is passed back to be overwritten by StoreMatchCacheEntry.
+//---------------------------------------------------------------------------
+
+BOOLEAN FindMatchCacheEntry(MatchWorkspace *workspace, MatchCacheEntry *key,
+                            MatchCacheEntry **entry)
+{
+   MatchCacheEntry *set;
+   MatchCacheEntry *oldest;
+   ULONG i;
+
+   workspace->matchCacheClock++;
+   set = workspace->matchCache + (MATCH_CACHE_WAYS *
+      (MixCode(key->code1 + MixCode(key->code2)) & (MATCH_CACHE_SETS - 1)));
+   oldest = set;
+   for (i = 0; i < MATCH_CACHE_WAYS; i++)
+   {
+      if ((set[i].code1 == key->code1) && (set[i].code2 == key->code2) &&
+          (set[i].numVertices1 == key->numVertices1) &&
+          (set[i].numEdges1 == key->numEdges1) &&
+          (set[i].numVertices2 == key->numVertices2) &&
+          (set[i].numEdges2 == key->numEdges2) &&
+          (set[i].threshold == key->threshold) &&
+          (set[i].matchMethod == key->matchMethod) &&
+          (set[i].graphsLength == key->graphsLength) &&
+          (memcmp(set[i].graphs, key->graphs,
+                  sizeof(ULONG) * key->graphsLength) == 0))
+      {
+         set[i].lastUse = workspace->matchCacheClock;
+         workspace->matchCacheHits++;
+         *entry = & set[i];
+         return TRUE;
+      }
+      if ((set[i].code1 == 0) ||
+          ((oldest->code1 != 0) && (set[i].lastUse < oldest->lastUse)))
+         oldest = & set[i];
+   }
+   workspace->matchCacheMisses++;
+   *entry = oldest;
+   return FALSE;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: StoreMatchCacheEntry
+//
+// INPUTS: (MatchWorkspace *workspace)
+//         (MatchCacheEntry *entry) - entry passed back by
+//                                    FindMatchCacheEntry
+//         (MatchCacheEntry *key) - key that was looked up
+//         (double cost) - cost returned by matcher
+//
+// RETURN: (void)
+//
+// PURPOSE: Store the key and match cost in the cache entry, with its
+// own copy of the key's graph encoding.
+//---------------------------------------------------------------------------
+
+void StoreMatchCacheEntry(MatchWorkspace *workspace, MatchCacheEntry *entry,
+                          MatchCacheEntry *key, double cost)
+{
+   ULONG *graphs = entry->graphs;
+
+   if (key->graphsLength > entry->graphsLength)
+   {
+      graphs = (ULONG *) realloc(graphs, sizeof(ULONG) * key->graphsLength);
+      if (graphs == NULL)
+         OutOfMemoryError("StoreMatchCacheEntry:graphs");
+   }
+   memcpy(graphs, key->graphs, sizeof(ULONG) * key->graphsLength);
+   *entry = *key;
+   entry->graphs = graphs;
+   entry->cost = cost;
+   entry->lastUse = workspace->matchCacheClock;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: MatchCacheCounts
+//
+// INPUTS: (ULONG *hits) - pointer to pass back number of cache hits
+//         (ULONG *misses) - pointer to pass back number of cache misses
+//
+// RETURN: (void)
+//
+// PURPOSE: Count the GraphMatch calls answered by the match caches and
+// those that needed a match, over the calling thread and all threads
+// whose workspaces have been released.
+//---------------------------------------------------------------------------
+
+void MatchCacheCounts(ULONG *hits, ULONG *misses)
+{
+   pthread_mutex_lock(& matchCacheCountsLock);
+   *hits = releasedCacheHits;
+   *misses = releasedCacheMisses;
+   pthread_mutex_unlock(& matchCacheCountsLock);
+   if (matchWorkspace != NULL)
+   {
+      *hits += matchWorkspace->matchCacheHits;
+      *misses += matchWorkspace->matchCacheMisses;
+   }
+}
+
+
 //---------------------------------------------------------------------------
 // Match Node Heap Functions
 //---------------------------------------------------------------------------
@@ -551,41 +2514,6 @@ MatchHeap *AllocateMatchHeap(ULONG size)
 }
 
 
-//---------------------------------------------------------------------------
-// NAME: AllocateNewMapping
-//
-// INPUTS: (ULONG depth) - depth (vertices mapped) of new node in search space
-//         (VertexMap *mapping) - partial mapping to be augmented
-//         (ULONG v1)
-//         (ULONG v2) - node's mapping includes v1 -> v2
-//
-// RETURN:  (VertexMap *) - newly-allocated vertex mapping
-//
-// PURPOSE: Allocate a new vertex mapping as a copy of the given mapping
-// appended with the new map v1 -> v2.
-//---------------------------------------------------------------------------
-
-VertexMap *AllocateNewMapping(ULONG depth, VertexMap *mapping,
-                ULONG v1, ULONG v2)
-{
-   VertexMap *newMapping;
-   ULONG i;
-
-   newMapping = (VertexMap *) malloc(sizeof(VertexMap) * depth);
-   if (newMapping == NULL)
-      OutOfMemoryError("AllocateNewMapping: newMapping");
-   for (i = 0; i < (depth - 1); i++) 
-   {
-      newMapping[i].v1 = mapping[i].v1;
-      newMapping[i].v2 = mapping[i].v2;
-   }
-   newMapping[depth-1].v1 = v1;
-   newMapping[depth-1].v2 = v2;
-
-   return newMapping;
-}
-
-
 //---------------------------------------------------------------------------
 // NAME: MatchHeapEmpty
 //
@@ -613,7 +2541,7 @@ BOOLEAN MatchHeapEmpty(MatchHeap *heap)
 // RETURN:  (void)
 //
 // PURPOSE: Insert given node into given heap, maintaining increasing
-// order by cost, and for nodes with the same cost, in decreasing order
+// order by bound, and for nodes with the same bound, in decreasing order
 // by depth.
 //---------------------------------------------------------------------------
 
@@ -641,10 +2569,11 @@ void InsertMatchHeapNode(MatchHeapNode *node, MatchHeap *heap)
    {
       parent = HeapParent(i);
       node2 = & heap->nodes[parent];
-      if ((node->cost < node2->cost) ||
-          ((node->cost == node2->cost) && (node->depth > node2->depth))) 
+      if ((node->bound < node2->bound) ||
+          ((node->bound == node2->bound) && (node->depth > node2->depth))) 
       {
          heap->nodes[i].cost = heap->nodes[parent].cost;
+         heap->nodes[i].bound = heap->nodes[parent].bound;
          heap->nodes[i].depth = heap->nodes[parent].depth;
          heap->nodes[i].mapping = heap->nodes[parent].mapping;
          i = parent;
@@ -654,6 +2583,7 @@ void InsertMatchHeapNode(MatchHeapNode *node, MatchHeap *heap)
    }
    // store new node
    heap->nodes[i].cost = node->cost;
+   heap->nodes[i].bound = node->bound;
    heap->nodes[i].depth = node->depth;
    heap->nodes[i].mapping = node->mapping;
 }
@@ -678,12 +2608,14 @@ void ExtractMatchHeapNode(MatchHeap *heap, MatchHeapNode *node)
 
    // copy best node to input storage node
    node->cost = heap->nodes[0].cost;
+   node->bound = heap->nodes[0].bound;
    node->depth = heap->nodes[0].depth;
    node->mapping = heap->nodes[0].mapping;
 
    // copy last node in heap array to first
    i = heap->numNodes - 1;
    heap->nodes[0].cost = heap->nodes[i].cost;
+   heap->nodes[0].bound = heap->nodes[i].bound;
    heap->nodes[0].depth = heap->nodes[i].depth;
    heap->nodes[0].mapping = heap->nodes[i].mapping;
    heap->numNodes--;
@@ -700,8 +2632,8 @@ void ExtractMatchHeapNode(MatchHeap *heap, MatchHeapNode *node)
 // RETURN:  (void)
 //
 // PURPOSE: Restores the heap property of the heap starting at the root
-// node.  The heap property is that parent nodes have less cost than their
-// children, and if the cost is the same, then parents have greater or
+// node.  The heap property is that parent nodes have less bound than their
+// children, and if the bound is the same, then parents have greater or
 // equal depth than their children.
 //---------------------------------------------------------------------------
 
@@ -717,7 +2649,8 @@ void HeapifyMatchHeap(MatchHeap *heap)
    MatchHeapNode *rightNode;
    ULONG tmpDepth;
    double tmpCost;
-   VertexMap *tmpMapping;
+   double tmpBound;
+   ULONG tmpMapping;
 
    parent = 0;
    best = 1;
@@ -732,8 +2665,8 @@ void HeapifyMatchHeap(MatchHeap *heap)
       if (leftChild < heap->numNodes) 
       {
          leftNode = & heap->nodes[leftChild];
-         if ((leftNode->cost < parentNode->cost) ||
-             ((leftNode->cost == parentNode->cost) &&
+         if ((leftNode->bound < parentNode->bound) ||
+             ((leftNode->bound == parentNode->bound) &&
               (leftNode->depth > parentNode->depth))) 
          {
             best = leftChild;
@@ -744,8 +2677,8 @@ void HeapifyMatchHeap(MatchHeap *heap)
       if (rightChild < heap->numNodes) 
       {
          rightNode = & heap->nodes[rightChild];
-         if ((rightNode->cost < bestNode->cost) ||
-             ((rightNode->cost == bestNode->cost) &&
+         if ((rightNode->bound < bestNode->bound) ||
+             ((rightNode->bound == bestNode->bound) &&
               (rightNode->depth > bestNode->depth))) 
          {
             best = rightChild;
@@ -756,12 +2689,15 @@ void HeapifyMatchHeap(MatchHeap *heap)
       if (parent != best) 
       {
          tmpCost = parentNode->cost;
+         tmpBound = parentNode->bound;
          tmpDepth = parentNode->depth;
          tmpMapping = parentNode->mapping;
          parentNode->cost = bestNode->cost;
+         parentNode->bound = bestNode->bound;
          parentNode->depth = bestNode->depth;
          parentNode->mapping = bestNode->mapping;
          bestNode->cost = tmpCost;
+         bestNode->bound = tmpBound;
          bestNode->depth = tmpDepth;
          bestNode->mapping = tmpMapping;
          parent = best;
@@ -780,8 +2716,8 @@ void HeapifyMatchHeap(MatchHeap *heap)
 // RETURN:  (void)
 //
 // PURPOSE: Insert the match nodes of heap1 into heap2 while maintaining
-// the order of heap2.  Ordering is by increasing cost, or if costs are
-// equal, by decreasing depth.  The nodes of heap2 are removed, but the
+// the order of heap2.  Ordering is by increasing bound, or if bounds are
+// equal, by decreasing depth.  The nodes of heap1 are removed, but the
 // memory remains allocated.
 //---------------------------------------------------------------------------
 
@@ -794,7 +2730,6 @@ void MergeMatchHeaps(MatchHeap *heap1, MatchHeap *heap2)
    {
       node = & heap1->nodes[i];
       InsertMatchHeapNode(node, heap2);
-      node->mapping = NULL;
    }
    heap1->numNodes = 0;
 }
@@ -805,31 +2740,33 @@ void MergeMatchHeaps(MatchHeap *heap1, MatchHeap *heap2)
 //
 // INPUTS: (MatchHeap *heap) - match node heap to compress
 //         (ULONG n) - limit used for bounding match node heap
+//         (MatchHeap *tempHeap) - heap used while compressing; left empty
 //
 // RETURN: (void)
 //
 // PURPOSE: Compress match node heap for the beginning of greedy
 // search within the InexactGraphMatch function.  The first n nodes
 // are left on the heap.  If there are more nodes on the heap, then
-// the nodes with unique costs remain on the heap, and the rest are
-// freed.  Note that the heap is assumed to already be in increasing
-// order by cost, and for nodes having the same cost, in decreasing
+// the nodes with unique bounds remain on the heap, and the rest are
+// dropped.  Note that the heap is assumed to already be in increasing
+// order by bound, and for nodes having the same bound, in decreasing
 // order by depth.
 //---------------------------------------------------------------------------
 
-void CompressMatchHeap(MatchHeap *heap, ULONG n)
+void CompressMatchHeap(MatchHeap *heap, ULONG n, MatchHeap *tempHeap)
 {
-   MatchHeap *newHeap;
    MatchHeapNode node1;
    MatchHeapNode node2;
+   MatchHeapNode *nodes;
+   ULONG size;
 
-   newHeap = AllocateMatchHeap(n);
+   ClearMatchHeap(tempHeap);
 
    // keep best n nodes
    while ((n > 0) && (! MatchHeapEmpty(heap))) 
    {
       ExtractMatchHeapNode(heap, & node1);
-      InsertMatchHeapNode(& node1, newHeap);
+      InsertMatchHeapNode(& node1, tempHeap);
       n--;
    }
 
@@ -837,21 +2774,22 @@ void CompressMatchHeap(MatchHeap *heap, ULONG n)
    while (! MatchHeapEmpty(heap)) 
    {
       ExtractMatchHeapNode(heap, & node2);
-      if (node1.cost == node2.cost)
-         free(node2.mapping);
-      else 
+      if (node1.bound != node2.bound)
       {
-         InsertMatchHeapNode(& node2, newHeap);
-         node1.cost = node2.cost;
+         InsertMatchHeapNode(& node2, tempHeap);
+         node1.bound = node2.bound;
       }
    }
 
-   // free old heap and install new one in its place
-   free(heap->nodes);
-   heap->nodes = newHeap->nodes;
-   heap->size = newHeap->size;
-   heap->numNodes = newHeap->numNodes;
-   free(newHeap);
+   // exchange the heaps' nodes, so heap holds the kept nodes
+   nodes = heap->nodes;
+   size = heap->size;
+   heap->nodes = tempHeap->nodes;
+   heap->size = tempHeap->size;
+   heap->numNodes = tempHeap->numNodes;
+   tempHeap->nodes = nodes;
+   tempHeap->size = size;
+   tempHeap->numNodes = 0;
 }
 
 
@@ -859,28 +2797,35 @@ void CompressMatchHeap(MatchHeap *heap, ULONG n)
 // NAME: PrintMatchHeapNode
 //
 // INPUTS: (MatchHeapNode *node) - match node to print
+//         (MatchWorkspace *workspace) - workspace holding node's mapping
 //
 // RETURN: (void)
 //
 // PURPOSE: Print match node.
 //---------------------------------------------------------------------------
 
-void PrintMatchHeapNode(MatchHeapNode *node)
+void PrintMatchHeapNode(MatchHeapNode *node, MatchWorkspace *workspace)
 {
-   ULONG i;
-   printf("MatchHeapNode: depth = %lu, cost = %f, mapping =",
-           node->depth, node->cost);
+   ULONG i, j;
+   MatchMapNode *mapNode;
+
+   printf("MatchHeapNode: depth = %lu, cost = %f, bound = %f, mapping =",
+           node->depth, node->cost, node->bound);
    if (node->depth > 0) 
    {
       printf("\n");
       for (i = 0; i < node->depth; i++) 
       {
-         printf("            %lu -> ", node->mapping[i].v1);
-         if (node->mapping[i].v2 == VERTEX_UNMAPPED)
+         // pair i is (depth - 1 - i) links back from the last pair
+         mapNode = & workspace->mapNodes[node->mapping];
+         for (j = i + 1; j < node->depth; j++)
+            mapNode = & workspace->mapNodes[mapNode->parent];
+         printf("            %lu -> ", mapNode->v1);
+         if (mapNode->v2 == VERTEX_UNMAPPED)
             printf("unmapped\n");
-         else if (node->mapping[i].v2 == VERTEX_DELETED)
+         else if (mapNode->v2 == VERTEX_DELETED)
             printf("deleted\n");
-         else printf("%lu\n", node->mapping[i].v2);
+         else printf("%lu\n", mapNode->v2);
       }
    } 
    else 
@@ -892,13 +2837,14 @@ void PrintMatchHeapNode(MatchHeapNode *node)
 // NAME: PrintMatchHeap
 //
 // INPUTS: (MatchHeap *heap) - match node heap to print
+//         (MatchWorkspace *workspace) - workspace holding nodes' mappings
 //
 // RETURN: (void)
 //
 // PURPOSE: Print match node list.
 //---------------------------------------------------------------------------
 
-void PrintMatchHeap(MatchHeap *heap)
+void PrintMatchHeap(MatchHeap *heap, MatchWorkspace *workspace)
 {
    ULONG i;
    MatchHeapNode *node;
@@ -908,7 +2854,7 @@ void PrintMatchHeap(MatchHeap *heap)
    {
       node = & heap->nodes[i];
       printf("(%lu) ", i);
-      PrintMatchHeapNode(node);
+      PrintMatchHeapNode(node, workspace);
    }
 }
 
@@ -920,16 +2866,12 @@ void PrintMatchHeap(MatchHeap *heap)
 //
 // RETURN: (void)
 //
-// PURPOSE: Free mappings of match nodes still in heap and reset heap to
-// have zero nodes.
+// PURPOSE: Reset heap to have zero nodes.  The nodes' mappings are
+// held in a match workspace and freed with it.
 //---------------------------------------------------------------------------
 
 void ClearMatchHeap(MatchHeap *heap)
 {
-   ULONG i;
-
-   for (i = 0; i < heap->numNodes; i++)
-      free(heap->nodes[i].mapping);
    heap->numNodes = 0;
 }
 
@@ -18,17 +18,19 @@
 //
 // PURPOSE: Reads in the SUBDUE input file, which may consist of
 // positive graphs and/or negative graphs, which are collected into
-// the positive and negative graph fields of the parameters.  Each
+// the positive and negative graph fields of the parameters.  The input
+// file may also be a binary graph file (see graphfile.c).  Each
 // example in the input file is prefaced by the appropriate token defined
 // in subdue.h.  The first graph in the file is assumed positive
 // unless the negative token is present.  Each graph is assumed to
 // begin at vertex #1 and therefore examples are not connected to one
-// another.
+// another.  With more than one thread, a large file is read in parallel
+// (see ReadGraphFileInParallel) if possible.
 //---------------------------------------------------------------------------
 
 void ReadInputFile(Parameters *parameters)
 {
-   FILE *inputFile = NULL;
+   GraphFile *inputFile = NULL;
    Graph *graph = NULL;
    Graph *posGraph= NULL;
    Graph *negGraph = NULL;
@@ -40,25 +42,35 @@ void ReadInputFile(Parameters *parameters)
    BOOLEAN readingPositive = TRUE;
    ULONG vertexOffset = 0;
    BOOLEAN directed = TRUE;
-   ULONG lineNo = 1;
-   char token[TOKEN_LEN];
 
    labelList = parameters->labelList;
    directed = parameters->directed;
 
    // Open input file
-   inputFile = fopen(parameters->inputFileName,"r");
+   inputFile = OpenGraphFile(parameters->inputFileName);
    if (inputFile == NULL) 
    {
       fprintf(stderr, "Unable to open input file %s.\n",
               parameters->inputFileName);
       exit(1);
    }
+   if (IsBinaryGraphFile(inputFile))
+   {
+      ReadBinaryInputFile(inputFile, parameters);
+      CloseGraphFile(inputFile);
+      return;
+   }
+   if ((parameters->numThreads > 1) &&
+       ReadGraphFileInParallel(inputFile, parameters))
+   {
+      CloseGraphFile(inputFile);
+      return;
+   }
 
    // Parse input file
-   while (ReadToken(token, inputFile, &lineNo) != 0) 
+   while (ScanToken(inputFile) != 0) 
    {
-      if (strcmp(token, POS_EG_TOKEN) == 0) 
+      if (TokenEquals(inputFile, POS_EG_TOKEN)) 
       { // reading positive eg
          if (posGraph == NULL)
             posGraph = AllocateGraph(0,0);
@@ -68,7 +80,7 @@ void ReadInputFile(Parameters *parameters)
          graph = posGraph;
          readingPositive = TRUE;
       }
-      else if (strcmp(token, NEG_EG_TOKEN) == 0) 
+      else if (TokenEquals(inputFile, NEG_EG_TOKEN)) 
       { // reading negative eg
          if (negGraph == NULL)
             negGraph = AllocateGraph(0,0);
@@ -79,7 +91,7 @@ void ReadInputFile(Parameters *parameters)
          graph = negGraph;
          readingPositive = FALSE;
       }
-      else if (strcmp(token, "v") == 0) 
+      else if (TokenEquals(inputFile, "v")) 
       {  // read vertex
          if (readingPositive && (posGraph == NULL)) 
          {
@@ -90,26 +102,31 @@ void ReadInputFile(Parameters *parameters)
             posEgsVertexIndices = AddVertexIndex(posEgsVertexIndices, numPosEgs, vertexOffset);
             graph = posGraph;
          }
-         ReadVertex(graph, inputFile, labelList, &lineNo, vertexOffset);
+         ScanVertex(inputFile, graph, labelList, vertexOffset);
       }
-      else if (strcmp(token, "e") == 0)    // read 'e' edge
-         ReadEdge(graph, inputFile, labelList, &lineNo, directed, vertexOffset);
+      else if (TokenEquals(inputFile, "e"))    // read 'e' edge
+         ScanEdge(inputFile, graph, labelList, directed, vertexOffset);
 
-      else if (strcmp(token, "u") == 0)    // read undirected edge
-         ReadEdge(graph, inputFile, labelList, &lineNo, FALSE, vertexOffset);
+      else if (TokenEquals(inputFile, "u"))    // read undirected edge
+         ScanEdge(inputFile, graph, labelList, FALSE, vertexOffset);
 
-      else if (strcmp(token, "d") == 0)    // read directed edge
-         ReadEdge(graph, inputFile, labelList, &lineNo, TRUE, vertexOffset);
+      else if (TokenEquals(inputFile, "d"))    // read directed edge
+         ScanEdge(inputFile, graph, labelList, TRUE, vertexOffset);
 
       else 
       {
-         fclose(inputFile);
          fprintf(stderr, "Unknown token %s in line %lu of input file %s.\n",
-                 token, lineNo, parameters->inputFileName);
+                 TokenString(inputFile), inputFile->lineNo,
+                 parameters->inputFileName);
+         CloseGraphFile(inputFile);
          exit(1);
       }
    }
-   fclose(inputFile);
+   CloseGraphFile(inputFile);
+   if (posGraph != NULL)
+      BuildVertexEdges(posGraph);
+   if (negGraph != NULL)
+      BuildVertexEdges(negGraph);
 
    //***** trim vertex, edge and label lists
 
@@ -202,19 +219,18 @@ Graph **ReadSubGraphsFromFile(char *fileName, char *subToken,
 {
    ULONG numSubs = 0;
    Graph **subGraphs = NULL;
-   FILE *inputFile = NULL;
+   GraphFile *inputFile = NULL;
    Graph *graph = NULL;
    LabelList *labelList = NULL;
    BOOLEAN directed = TRUE;
-   ULONG vertexOffset = 0;   // Dummy argument to ReadVertex and ReadEdge
-   ULONG lineNo = 1;
-   char token[TOKEN_LEN];
+   ULONG vertexOffset = 0;   // Dummy argument to ScanVertex and ScanEdge
+   ULONG i;
 
    labelList = parameters->labelList;
    directed = parameters->directed;
 
    // Open input file
-   inputFile = fopen(fileName,"r");
+   inputFile = OpenGraphFile(fileName);
    if (inputFile == NULL) 
    {
       fprintf(stderr, "Unable to open input file %s.\n", fileName);
@@ -222,9 +238,9 @@ Graph **ReadSubGraphsFromFile(char *fileName, char *subToken,
    }
 
    // Parse input file
-   while (ReadToken(token, inputFile, &lineNo) != 0) 
+   while (ScanToken(inputFile) != 0) 
    {
-      if (strcmp(token, subToken) == 0) 
+      if (TokenEquals(inputFile, subToken)) 
       { // new sub-graph
          numSubs++;
          subGraphs = (Graph **) realloc(subGraphs, (sizeof(Graph *) * numSubs));
@@ -233,7 +249,7 @@ Graph **ReadSubGraphsFromFile(char *fileName, char *subToken,
          subGraphs[numSubs - 1] = AllocateGraph(0, 0);
          graph = subGraphs[numSubs - 1];
        }
-      else if (strcmp(token, "v") == 0) 
+      else if (TokenEquals(inputFile, "v")) 
       {        // read vertex
          if (subGraphs == NULL) 
          {
@@ -246,26 +262,28 @@ Graph **ReadSubGraphsFromFile(char *fileName, char *subToken,
             subGraphs[numSubs - 1] = AllocateGraph(0, 0);
             graph = subGraphs[numSubs - 1];
           }
-         ReadVertex(graph, inputFile, labelList, &lineNo, vertexOffset);
+         ScanVertex(inputFile, graph, labelList, vertexOffset);
       }
-      else if (strcmp(token, "e") == 0)    // read 'e' edge
-         ReadEdge(graph, inputFile, labelList, &lineNo, directed, vertexOffset);
+      else if (TokenEquals(inputFile, "e"))    // read 'e' edge
+         ScanEdge(inputFile, graph, labelList, directed, vertexOffset);
 
-      else if (strcmp(token, "u") == 0)    // read undirected edge
-         ReadEdge(graph, inputFile, labelList, &lineNo, FALSE, vertexOffset);
+      else if (TokenEquals(inputFile, "u"))    // read undirected edge
+         ScanEdge(inputFile, graph, labelList, FALSE, vertexOffset);
 
-      else if (strcmp(token, "d") == 0)    // read directed edge
-         ReadEdge(graph, inputFile, labelList, &lineNo, TRUE, vertexOffset);
+      else if (TokenEquals(inputFile, "d"))    // read directed edge
+         ScanEdge(inputFile, graph, labelList, TRUE, vertexOffset);
 
       else 
       {
-         fclose(inputFile);
          fprintf(stderr, "Unknown token %s in line %lu of input file %s.\n",
-                 token, lineNo, fileName);
+                 TokenString(inputFile), inputFile->lineNo, fileName);
+         CloseGraphFile(inputFile);
          exit(1);
       }
    }
-   fclose(inputFile);
+   CloseGraphFile(inputFile);
+   for (i = 0; i < numSubs; i++)
+      BuildVertexEdges(subGraphs[i]);
 
    //***** trim vertex, edge and label lists
 
@@ -285,54 +303,59 @@ Graph **ReadSubGraphsFromFile(char *fileName, char *subToken,
 //
 // PURPOSE: Parses graph file, checking for formatting errors, and builds
 // all necessary structures for the graph, which is returned.  labelList
-// is destructively changed to hold any new labels.
+// is destructively changed to hold any new labels.  The graph file may
+// also be a binary graph file (see graphfile.c).
 //---------------------------------------------------------------------------
 
 Graph *ReadGraph(char *filename, LabelList *labelList, BOOLEAN directed)
 {
    Graph *graph;
-   FILE *graphFile;
-   ULONG lineNo;             // Line number counter for graph file
-   char token[TOKEN_LEN];
-   ULONG vertexOffset = 0;   // Dummy argument to ReadVertex and ReadEdge
-
-   // Allocate graph
-   graph = AllocateGraph(0,0);
+   GraphFile *graphFile;
+   ULONG vertexOffset = 0;   // Dummy argument to ScanVertex and ScanEdge
 
    // Open graph file
-   graphFile = fopen(filename,"r");
+   graphFile = OpenGraphFile(filename);
    if (graphFile == NULL) 
    {
       fprintf(stderr, "Unable to open graph file %s.\n", filename);
       exit(1);
    }
+   if (IsBinaryGraphFile(graphFile))
+   {
+      graph = ReadBinaryGraph(graphFile, filename, labelList, directed);
+      CloseGraphFile(graphFile);
+      return graph;
+   }
+
+   // Allocate graph
+   graph = AllocateGraph(0,0);
 
    // Parse graph file
-   lineNo = 1;
-   while (ReadToken(token, graphFile, &lineNo) != 0) 
+   while (ScanToken(graphFile) != 0) 
    {
-      if (strcmp(token, "v") == 0)         // read vertex
-         ReadVertex(graph, graphFile, labelList, &lineNo, vertexOffset);
+      if (TokenEquals(graphFile, "v"))         // read vertex
+         ScanVertex(graphFile, graph, labelList, vertexOffset);
 
-      else if (strcmp(token, "e") == 0)    // read 'e' edge
-         ReadEdge(graph, graphFile, labelList, &lineNo, directed, vertexOffset);
+      else if (TokenEquals(graphFile, "e"))    // read 'e' edge
+         ScanEdge(graphFile, graph, labelList, directed, vertexOffset);
 
-      else if (strcmp(token, "u") == 0)    // read undirected edge
-         ReadEdge(graph, graphFile, labelList, &lineNo, FALSE, vertexOffset);
+      else if (TokenEquals(graphFile, "u"))    // read undirected edge
+         ScanEdge(graphFile, graph, labelList, FALSE, vertexOffset);
 
-      else if (strcmp(token, "d") == 0)    // read directed edge
-         ReadEdge(graph, graphFile, labelList, &lineNo, TRUE, vertexOffset);
+      else if (TokenEquals(graphFile, "d"))    // read directed edge
+         ScanEdge(graphFile, graph, labelList, TRUE, vertexOffset);
 
       else 
       {
-         fclose(graphFile);
-         FreeGraph(graph);
          fprintf(stderr, "Unknown token %s in line %lu of graph file %s.\n",
-                 token, lineNo, filename);
+                 TokenString(graphFile), graphFile->lineNo, filename);
+         CloseGraphFile(graphFile);
+         FreeGraph(graph);
          exit(1);
       }
    }
-   fclose(graphFile);
+   CloseGraphFile(graphFile);
+   BuildVertexEdges(graph);
 
    //***** trim vertex, edge and label lists
 
@@ -385,8 +408,8 @@ void ReadVertex(Graph *graph, FILE *fp, LabelList *labelList, ULONG *pLineNo, UL
 // RETURN: (void)
 //
 // PURPOSE: Add vertex information to graph. AddVertex also changes the
-// size of the currently-allocated vertex array, which increases by
-// LIST_SIZE_INC (instead of just 1) when exceeded.
+// size of the currently-allocated vertex array, which starts at
+// LIST_SIZE_INC and doubles when exceeded.
 //---------------------------------------------------------------------------
 
 void AddVertex(Graph *graph, ULONG labelIndex)
@@ -396,9 +419,13 @@ void AddVertex(Graph *graph, ULONG labelIndex)
    ULONG vertexListSize = graph->vertexListSize;
 
    // make sure there is enough room for another vertex
+   CheckIndex(numVertices, "vertex");
    if (vertexListSize == numVertices)
    {
-      vertexListSize += LIST_SIZE_INC;
+      if (vertexListSize < LIST_SIZE_INC)
+         vertexListSize = LIST_SIZE_INC;
+      else
+         vertexListSize *= 2;
       newVertexList = (Vertex *) realloc(graph->vertices, (sizeof(Vertex) * (vertexListSize)));
       if (newVertexList == NULL)
          OutOfMemoryError("vertex list");
@@ -413,6 +440,8 @@ void AddVertex(Graph *graph, ULONG labelIndex)
    graph->vertices[numVertices].map = VERTEX_UNMAPPED;
    graph->vertices[numVertices].used = FALSE;
    graph->numVertices++;
+   FreeGraphRowStats(graph); // no longer valid
+   FreeGraphInvariants(graph);
 }
 
 
@@ -480,24 +509,59 @@ void ReadEdge(Graph *graph, FILE *fp, LabelList *labelList, ULONG *pLineNo, BOOL
 //
 // RETURN: (void)
 //
-// PURPOSE: Add edge information to graph. AddEdge also changes the
-// size of the currently-allocated edge array, which increases by
-// LIST_SIZE_INC (instead of just 1) when exceeded.
+// PURPOSE: Add edge information to graph, and the edge to the edge
+// arrays of its vertices.
 //---------------------------------------------------------------------------
 
 void AddEdge(Graph *graph, ULONG sourceVertexIndex, ULONG targetVertexIndex,
              BOOLEAN directed, ULONG labelIndex, BOOLEAN spansIncrement)
+{
+   AppendEdge(graph, sourceVertexIndex, targetVertexIndex, directed,
+              labelIndex, spansIncrement);
+   AddEdgeToVertices(graph, (graph->numEdges - 1));
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: AppendEdge
+//
+// INPUTS: (Graph *graph) - graph to add edge to
+//         (ULONG sourceVertexIndex) - index of edge's source vertex
+//         (ULONG targetVertexIndex) - index of edge's target vertex
+//         (BOOLEAN directed) - TRUE is edge is directed
+//         (ULONG labelIndex) - index of edge's label in label list
+//         (ULONG spansIncrement)
+//
+// RETURN: (void)
+//
+// PURPOSE: Add edge information to graph's edge array only; the edge
+// is not added to its vertices' edge arrays until BuildVertexEdges is
+// called.  The edge array starts at LIST_SIZE_INC and doubles when
+// exceeded.
+//---------------------------------------------------------------------------
+
+void AppendEdge(Graph *graph, ULONG sourceVertexIndex,
+                ULONG targetVertexIndex, BOOLEAN directed, ULONG labelIndex,
+                BOOLEAN spansIncrement)
 {
    Edge *newEdgeList;
-   ULONG edgeListSize = graph->edgeListSize;
+   ULONG edgeListSize;
+
+   if (graph->fileMemory != NULL)
+      CopyMappedGraphArrays(graph);
+   edgeListSize = graph->edgeListSize;
 
    // make sure there is enough room for another edge in the graph
+   CheckIndex(graph->numEdges, "edge");
    if (edgeListSize == graph->numEdges)
    {
-      edgeListSize += LIST_SIZE_INC;
+      if (edgeListSize < LIST_SIZE_INC)
+         edgeListSize = LIST_SIZE_INC;
+      else
+         edgeListSize *= 2;
       newEdgeList = (Edge *) realloc(graph->edges, (sizeof(Edge) * (edgeListSize)));
       if (newEdgeList == NULL)
-         OutOfMemoryError("AddEdge:newEdgeList");
+         OutOfMemoryError("AppendEdge:newEdgeList");
       graph->edges = newEdgeList;
       graph->edgeListSize = edgeListSize;
    }
@@ -511,13 +575,127 @@ void AddEdge(Graph *graph, ULONG sourceVertexIndex, ULONG targetVertexIndex,
    graph->edges[graph->numEdges].spansIncrement = spansIncrement;
    graph->edges[graph->numEdges].validPath = TRUE;
 
-   // add index to edge in edge index array of both vertices
-   AddEdgeToVertices(graph, graph->numEdges);
-
    graph->numEdges++;
 }
 
 
+//---------------------------------------------------------------------------
+// NAME: BuildVertexEdges
+//
+// INPUTS: (Graph *graph) - graph whose vertex edge arrays are built
+//
+// RETURN: (void)
+//
+// PURPOSE: Build the edge arrays of all of the graph's vertices from
+// its edges, as a single compressed array of every vertex's edges in
+// turn.  Each vertex's edges are counted first, so each vertex's array
+// is filled in place, in edge order (the same order AddEdgeToVertices
+// gives).  Used after a graph is read with AppendEdge.
+//---------------------------------------------------------------------------
+
+void BuildVertexEdges(Graph *graph)
+{
+   INDEX *vertexEdges;
+   Vertex *vertex;
+   Edge *edge;
+   ULONG total;
+   ULONG v, e;
+
+   // discard any existing edge arrays
+   if (graph->fileMemory != NULL)
+      CopyMappedGraphArrays(graph);
+   if (graph->vertexEdges != NULL)
+      free(graph->vertexEdges);
+   else
+      for (v = 0; v < graph->numVertices; v++)
+         free(graph->vertices[v].edges);
+   graph->vertexEdges = NULL;
+   FreeGraphRowStats(graph); // no longer valid
+   FreeGraphInvariants(graph);
+
+   // count edges of each vertex
+   for (v = 0; v < graph->numVertices; v++)
+      graph->vertices[v].numEdges = 0;
+   for (e = 0; e < graph->numEdges; e++)
+   {
+      edge = & graph->edges[e];
+      graph->vertices[edge->vertex1].numEdges++;
+      if (edge->vertex1 != edge->vertex2) // don't add a self edge twice
+         graph->vertices[edge->vertex2].numEdges++;
+   }
+
+   // point vertices into single array
+   vertexEdges = NULL;
+   total = 0;
+   for (v = 0; v < graph->numVertices; v++)
+      total += graph->vertices[v].numEdges;
+   if (total > 0)
+   {
+      vertexEdges = (INDEX *) malloc(sizeof(INDEX) * total);
+      if (vertexEdges == NULL)
+         OutOfMemoryError("BuildVertexEdges:vertexEdges");
+   }
+   total = 0;
+   for (v = 0; v < graph->numVertices; v++)
+   {
+      vertex = & graph->vertices[v];
+      vertex->edges = (vertex->numEdges > 0) ? (vertexEdges + total) : NULL;
+      total += vertex->numEdges;
+      vertex->numEdges = 0;
+   }
+
+   // fill in edges
+   for (e = 0; e < graph->numEdges; e++)
+   {
+      edge = & graph->edges[e];
+      vertex = & graph->vertices[edge->vertex1];
+      vertex->edges[vertex->numEdges++] = e;
+      if (edge->vertex1 != edge->vertex2)
+      {
+         vertex = & graph->vertices[edge->vertex2];
+         vertex->edges[vertex->numEdges++] = e;
+      }
+   }
+   graph->vertexEdges = vertexEdges;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: SeparateVertexEdges
+//
+// INPUTS: (Graph *graph)
+//
+// RETURN: (void)
+//
+// PURPOSE: Give each vertex its own edge array, copied from the single
+// array built by BuildVertexEdges, so the arrays can be grown one at a
+// time.
+//---------------------------------------------------------------------------
+
+void SeparateVertexEdges(Graph *graph)
+{
+   Vertex *vertex;
+   INDEX *edgeIndices;
+   ULONG v;
+
+   for (v = 0; v < graph->numVertices; v++)
+   {
+      vertex = & graph->vertices[v];
+      edgeIndices = NULL;
+      if (vertex->numEdges > 0)
+      {
+         edgeIndices = (INDEX *) malloc(sizeof(INDEX) * vertex->numEdges);
+         if (edgeIndices == NULL)
+            OutOfMemoryError("SeparateVertexEdges:edgeIndices");
+         memcpy(edgeIndices, vertex->edges, sizeof(INDEX) * vertex->numEdges);
+      }
+      vertex->edges = edgeIndices;
+   }
+   free(graph->vertexEdges);
+   graph->vertexEdges = NULL;
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: StoreEdge
 //
@@ -547,6 +725,59 @@ void StoreEdge(Edge *overlapEdges, ULONG edgeIndex,
 }
 
 
+//---------------------------------------------------------------------------
+// NAME: CopyMappedGraphArrays
+//
+// INPUTS: (Graph *graph) - graph read from a binary graph file
+//
+// RETURN: (void)
+//
+// PURPOSE: Copy the graph's edge array and vertex edge arrays out of the
+// binary graph file's memory, so they can be grown and freed, and
+// release the graph's use of that memory.
+//---------------------------------------------------------------------------
+
+void CopyMappedGraphArrays(Graph *graph)
+{
+   Edge *edges = NULL;
+   INDEX *vertexEdges = NULL;
+   ULONG total = 0;
+   ULONG v;
+
+   if (graph->numEdges > 0)
+   {
+      edges = (Edge *) malloc(sizeof(Edge) * graph->numEdges);
+      if (edges == NULL)
+         OutOfMemoryError("CopyMappedGraphArrays:edges");
+      memcpy(edges, graph->edges, sizeof(Edge) * graph->numEdges);
+   }
+   for (v = 0; v < graph->numVertices; v++)
+      total += graph->vertices[v].numEdges;
+   if (total > 0)
+   {
+      vertexEdges = (INDEX *) malloc(sizeof(INDEX) * total);
+      if (vertexEdges == NULL)
+         OutOfMemoryError("CopyMappedGraphArrays:vertexEdges");
+   }
+   total = 0;
+   for (v = 0; v < graph->numVertices; v++)
+   {
+      if (graph->vertices[v].numEdges > 0)
+      {
+         memcpy((vertexEdges + total), graph->vertices[v].edges,
+                sizeof(INDEX) * graph->vertices[v].numEdges);
+         graph->vertices[v].edges = vertexEdges + total;
+      }
+      total += graph->vertices[v].numEdges;
+   }
+   graph->edges = edges;
+   graph->edgeListSize = graph->numEdges;
+   graph->vertexEdges = vertexEdges;
+   ReleaseGraphFileMemory(graph->fileMemory);
+   graph->fileMemory = NULL;
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: AddEdgeToVertices
 //
@@ -563,13 +794,19 @@ void AddEdgeToVertices(Graph *graph, ULONG edgeIndex)
 {
    ULONG v1, v2;
    Vertex *vertex;
-   ULONG *edgeIndices;
-
+   INDEX *edgeIndices;
+
+   FreeGraphRowStats(graph); // no longer valid
+   FreeGraphInvariants(graph);
+   if (graph->fileMemory != NULL)
+      CopyMappedGraphArrays(graph);
+   if (graph->vertexEdges != NULL)
+      SeparateVertexEdges(graph);
    v1 = graph->edges[edgeIndex].vertex1;
    v2 = graph->edges[edgeIndex].vertex2;
    vertex = & graph->vertices[v1];
-   edgeIndices = (ULONG *) realloc(vertex->edges,
-                                   sizeof(ULONG) * (vertex->numEdges + 1));
+   edgeIndices = (INDEX *) realloc(vertex->edges,
+                                   sizeof(INDEX) * (vertex->numEdges + 1));
    if (edgeIndices == NULL)
       OutOfMemoryError("AddEdgeToVertices:edgeIndices1");
    edgeIndices[vertex->numEdges] = edgeIndex;
@@ -579,8 +816,8 @@ void AddEdgeToVertices(Graph *graph, ULONG edgeIndex)
    if (v1 != v2) 
    { // don't add a self edge twice
       vertex = & graph->vertices[v2];
-      edgeIndices = (ULONG *) realloc(vertex->edges,
-                                      sizeof(ULONG) * (vertex->numEdges + 1));
+      edgeIndices = (INDEX *) realloc(vertex->edges,
+                                      sizeof(INDEX) * (vertex->numEdges + 1));
       if (edgeIndices == NULL)
          OutOfMemoryError("AddEdgeToVertices:edgeIndices2");
       edgeIndices[vertex->numEdges] = edgeIndex;
@@ -744,6 +981,10 @@ Graph *AllocateGraph(ULONG v, ULONG e)
 {
    Graph *graph;
 
+   if (v > 0)
+      CheckIndex(v - 1, "vertex");
+   if (e > 0)
+      CheckIndex(e - 1, "edge");
    graph = (Graph *) malloc(sizeof(Graph));
    if (graph == NULL)
       OutOfMemoryError("AllocateGraph:graph");
@@ -766,6 +1007,10 @@ Graph *AllocateGraph(ULONG v, ULONG e)
          OutOfMemoryError("AllocateGraph:graph->edges");
     }
    graph->edgeListSize = e;
+   graph->rowStats = NULL;
+   graph->invariants = NULL;
+   graph->vertexEdges = NULL;
+   graph->fileMemory = NULL;
 
    return graph;
 }
@@ -806,7 +1051,7 @@ Graph *CopyGraph(Graph *g)
       gCopy->vertices[v].edges = NULL;
       if (numEdges > 0) 
       {
-          gCopy->vertices[v].edges = (ULONG *) malloc(numEdges * sizeof(ULONG));
+          gCopy->vertices[v].edges = (INDEX *) malloc(numEdges * sizeof(INDEX));
           if (gCopy->vertices[v].edges == NULL)
              OutOfMemoryError("CopyGraph:edges");
           for (e = 0; e < numEdges; e++)
@@ -822,6 +1067,8 @@ Graph *CopyGraph(Graph *g)
       gCopy->edges[e].label = g->edges[e].label;
       gCopy->edges[e].directed = g->edges[e].directed;
       gCopy->edges[e].used = g->edges[e].used;
+      gCopy->edges[e].spansIncrement = g->edges[e].spansIncrement;
+      gCopy->edges[e].validPath = g->edges[e].validPath;
    }
 
    return gCopy;
@@ -836,7 +1083,8 @@ Graph *CopyGraph(Graph *g)
 // RETURN:  void
 //
 // PURPOSE: Free memory used by given graph, including the vertices array
-// and the edges array for each vertex.
+// and the edges array for each vertex (or the single array they point
+// into).
 //---------------------------------------------------------------------------
 
 void FreeGraph(Graph *graph)
@@ -845,15 +1093,222 @@ void FreeGraph(Graph *graph)
 
    if (graph != NULL) 
    {
-      for (v = 0; v < graph->numVertices; v++)
-         free(graph->vertices[v].edges);
-      free(graph->edges);
+      // edge arrays of a graph read from a binary graph file are in the
+      // file's memory
+      if (graph->fileMemory != NULL)
+         ReleaseGraphFileMemory(graph->fileMemory);
+      else
+      {
+         if (graph->vertexEdges != NULL)
+            free(graph->vertexEdges);
+         else
+            for (v = 0; v < graph->numVertices; v++)
+               free(graph->vertices[v].edges);
+         free(graph->edges);
+      }
       free(graph->vertices);
+      FreeGraphRowStats(graph);
+      FreeGraphInvariants(graph);
       free(graph);
    }
 }
 
 
+//---------------------------------------------------------------------------
+// NAME:    AllocateGraphMarks
+//
+// INPUTS:  (void)
+//
+// RETURN:  (GraphMarks *) - empty set of marks
+//
+// PURPOSE: Allocate a set of marks not yet belonging to any graph.  The
+// mark arrays are allocated by ResetGraphMarks.
+//---------------------------------------------------------------------------
+
+GraphMarks *AllocateGraphMarks(void)
+{
+   GraphMarks *marks;
+
+   marks = (GraphMarks *) malloc(sizeof(GraphMarks));
+   if (marks == NULL)
+      OutOfMemoryError("AllocateGraphMarks:marks");
+   marks->graph = NULL;
+   marks->generation = 1;
+   marks->vertexListSize = 0;
+   marks->edgeListSize = 0;
+   marks->vertexStamps = NULL;
+   marks->edgeStamps = NULL;
+   marks->touchedStamps = NULL;
+   marks->vertexMap = NULL;
+   return marks;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    GetGraphMarks
+//
+// INPUTS:  (Graph *graph) - graph to be marked
+//          (Parameters *parameters)
+//
+// RETURN:  (GraphMarks *) - marks for graph
+//
+// PURPOSE: Return the marks to use on the given graph.  The positive
+// and negative graphs have their own marks, which persist between
+// calls so that marks can be passed from one procedure to the next
+// (e.g., from RecursifySub to CompressGraph); users must unmark what
+// they mark.  Their vertex maps start out VERTEX_UNMAPPED, as do
+// those of a newly read graph.  Any other graph gets the scratch
+// marks, which are cleared here.
+//---------------------------------------------------------------------------
+
+GraphMarks *GetGraphMarks(Graph *graph, Parameters *parameters)
+{
+   GraphMarks *marks;
+   ULONG v;
+
+   if (graph == parameters->posGraph)
+      marks = parameters->posGraphMarks;
+   else if (graph == parameters->negGraph)
+      marks = parameters->negGraphMarks;
+   else
+   {
+      ResetGraphMarks(parameters->graphMarks, graph);
+      return parameters->graphMarks;
+   }
+   if ((marks->graph != graph) ||
+       (graph->numVertices > marks->vertexListSize) ||
+       (graph->numEdges > marks->edgeListSize))
+   {
+      ResetGraphMarks(marks, graph);
+      for (v = 0; v < graph->numVertices; v++)
+         marks->vertexMap[v] = VERTEX_UNMAPPED;
+   }
+   return marks;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    ResetGraphMarks
+//
+// INPUTS:  (GraphMarks *marks) - marks to reset
+//          (Graph *graph) - graph the marks are to be used on
+//
+// RETURN:  void
+//
+// PURPOSE: Unmark all vertices and edges of the given graph by
+// advancing the generation, growing the mark arrays first if the
+// graph is larger than any graph marked before.
+//---------------------------------------------------------------------------
+
+void ResetGraphMarks(GraphMarks *marks, Graph *graph)
+{
+   ULONG v, e;
+
+   if (graph->numVertices > marks->vertexListSize)
+   {
+      marks->vertexStamps = (ULONG *) realloc(marks->vertexStamps,
+                               sizeof(ULONG) * graph->numVertices);
+      marks->touchedStamps = (ULONG *) realloc(marks->touchedStamps,
+                                sizeof(ULONG) * graph->numVertices);
+      marks->vertexMap = (ULONG *) realloc(marks->vertexMap,
+                            sizeof(ULONG) * graph->numVertices);
+      if ((marks->vertexStamps == NULL) || (marks->touchedStamps == NULL) ||
+          (marks->vertexMap == NULL))
+         OutOfMemoryError("ResetGraphMarks:vertexStamps");
+      for (v = marks->vertexListSize; v < graph->numVertices; v++)
+      {
+         marks->vertexStamps[v] = 0;
+         marks->touchedStamps[v] = 0;
+      }
+      marks->vertexListSize = graph->numVertices;
+   }
+   if (graph->numEdges > marks->edgeListSize)
+   {
+      marks->edgeStamps = (ULONG *) realloc(marks->edgeStamps,
+                             sizeof(ULONG) * graph->numEdges);
+      if (marks->edgeStamps == NULL)
+         OutOfMemoryError("ResetGraphMarks:edgeStamps");
+      for (e = marks->edgeListSize; e < graph->numEdges; e++)
+         marks->edgeStamps[e] = 0;
+      marks->edgeListSize = graph->numEdges;
+   }
+   marks->graph = graph;
+   marks->generation++;
+   if (marks->generation == 0)
+   {
+      // generation wrapped around, so old stamps must really be cleared
+      for (v = 0; v < marks->vertexListSize; v++)
+      {
+         marks->vertexStamps[v] = 0;
+         marks->touchedStamps[v] = 0;
+      }
+      for (e = 0; e < marks->edgeListSize; e++)
+         marks->edgeStamps[e] = 0;
+      marks->generation = 1;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    FreeGraphMarks
+//
+// INPUTS:  (GraphMarks *marks)
+//
+// RETURN:  void
+//
+// PURPOSE: Free memory used by marks.
+//---------------------------------------------------------------------------
+
+void FreeGraphMarks(GraphMarks *marks)
+{
+   if (marks != NULL)
+   {
+      free(marks->vertexStamps);
+      free(marks->edgeStamps);
+      free(marks->touchedStamps);
+      free(marks->vertexMap);
+      free(marks);
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    AllocateParameterMarks
+//
+// INPUTS:  (Parameters *parameters)
+//
+// RETURN:  void
+//
+// PURPOSE: Allocate the positive, negative and scratch graph marks of
+// the parameters.
+//---------------------------------------------------------------------------
+
+void AllocateParameterMarks(Parameters *parameters)
+{
+   parameters->posGraphMarks = AllocateGraphMarks();
+   parameters->negGraphMarks = AllocateGraphMarks();
+   parameters->graphMarks = AllocateGraphMarks();
+}
+
+
+//---------------------------------------------------------------------------
+// NAME:    FreeParameterMarks
+//
+// INPUTS:  (Parameters *parameters)
+//
+// RETURN:  void
+//
+// PURPOSE: Free the graph marks allocated by AllocateParameterMarks.
+//---------------------------------------------------------------------------
+
+void FreeParameterMarks(Parameters *parameters)
+{
+   FreeGraphMarks(parameters->posGraphMarks);
+   FreeGraphMarks(parameters->negGraphMarks);
+   FreeGraphMarks(parameters->graphMarks);
+}
+
+
 //---------------------------------------------------------------------------
 // NAME:    PrintGraph
 //
@@ -193,8 +193,7 @@ void ProcessInstancesForSub(Substructure *bestSub,
             }
 
             // Check to see if the instance is an exact match to the bestSub
-            if (GraphMatch(newSub->definition, bestSub->definition,
-	        parameters->labelList, 0.0, NULL, NULL))
+            if (SubDefinitionsMatch(newSub, bestSub, parameters->labelList))
             {
                // Update the increment data structure to reflect new instance.
 	       // The instance will not be added if there are vertices that
@@ -826,8 +825,8 @@ BOOLEAN AddInstanceToIncrement(Substructure *newSub, Instance *instance,
    subListNode = subList->head;
    while ((subListNode != NULL) && (!found))
    {
-      if (GraphMatch(newSub->definition, subListNode->sub->definition,
-                     parameters->labelList, 0.0, NULL, NULL))
+      if (SubDefinitionsMatch(newSub, subListNode->sub,
+                              parameters->labelList))
       {
          found = TRUE;
          // check for overlap in previous increments
@@ -897,7 +896,8 @@ BOOLEAN CheckInstanceForOverlap(Instance *instance, Substructure *newSub,
                                 Parameters *parameters)
 {
    struct avl_table *avlTable;
-   ULONG *vertices;
+   INDEX *vertices;
+   ULONG vertex;
    ULONG *result;
    ULONG i;
 
@@ -908,8 +908,9 @@ BOOLEAN CheckInstanceForOverlap(Instance *instance, Substructure *newSub,
 
    for(i=0; i<instance->numVertices; i++)
    {
-      result = avl_find(avlTable, &vertices[i]);
-      if((result != NULL) && (*result == vertices[i]))
+      vertex = vertices[i]; // tree holds ULONGs
+      result = avl_find(avlTable, &vertex);
+      if((result != NULL) && (*result == vertex))
          return TRUE;
    }
    return FALSE;
@@ -1072,7 +1073,7 @@ BOOLEAN CheckForMatch(Graph *subGraph, InstanceList *instanceList, Graph *graph,
             instance = instanceListNode->instance;
             instanceGraph = InstanceToGraph (instance, graph);
             if (GraphMatch (subGraph, instanceGraph, parameters->labelList,
-                            0.0, &matchCost, NULL))
+                            0.0, MATCH_SEARCH, &matchCost, NULL))
                foundMatch = TRUE;
             FreeGraph (instanceGraph);
             if(foundMatch)
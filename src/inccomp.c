@@ -110,9 +110,8 @@ SubList *ComputeBestSubstructures(Parameters *parameters, int listSize)
 	 // Add sub to global list if not already there
          while (subIndex != NULL) 
          {
-            if (GraphMatch(subIndex->sub->definition,
-                           incrementSubListNode->sub->definition,
-        		   parameters->labelList, 0.0, NULL, NULL))
+            if (SubDefinitionsMatch(subIndex->sub, incrementSubListNode->sub,
+                                    parameters->labelList))
             {
                found = TRUE;
                break;
@@ -249,8 +248,7 @@ double ComputeValue(IncrementListNode *incNodePtr, Substructure *sub,
       while (subListNode != NULL)
       {
          incrementSub = subListNode->sub;
-         if (GraphMatch(incrementSub->definition, sub->definition, labelList,
-                        0.0, NULL, NULL)) 
+         if (SubDefinitionsMatch(incrementSub, sub, labelList))
          {
             // Found it, now update the values
             if (parameters->evalMethod == EVAL_SETCOVER)
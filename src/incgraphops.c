@@ -510,7 +510,7 @@ Instance *CreateGraphRefInstance(Instance *instance1, ReferenceGraph *refGraph)
 //------------------------------------------------------------------------------
 // NAME: SortIndices
 //
-// INPUT: (ULONG *A) - array being sorted
+// INPUT: (INDEX *A) - array being sorted
 //        (long p) - start index
 //        (long r) - end index
 //
@@ -519,7 +519,7 @@ Instance *CreateGraphRefInstance(Instance *instance1, ReferenceGraph *refGraph)
 // PURPOSE:  Implementation of the QuickSort algorithm.
 //------------------------------------------------------------------------------
 
-void SortIndices(ULONG *A, long p, long r) 
+void SortIndices(INDEX *A, long p, long r) 
 {
    long q;
 
@@ -535,7 +535,7 @@ void SortIndices(ULONG *A, long p, long r)
 //------------------------------------------------------------------------------
 // NAME: Partition
 //
-// INPUT: (ULONG *A) - input array
+// INPUT: (INDEX *A) - input array
 //        (long p) - start index
 //        (ulong r) - end index
 //
@@ -544,11 +544,11 @@ void SortIndices(ULONG *A, long p, long r)
 // PURPOSE:  Partition algorithm for QuickSort.
 //------------------------------------------------------------------------------
 
-long Partition(ULONG *A, long p, long r) 
+long Partition(INDEX *A, long p, long r) 
 {
-   ULONG x;
+   INDEX x;
    long i,j;
-   ULONG temp;
+   INDEX temp;
 
    x = A[r];
    i = p-1;
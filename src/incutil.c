@@ -141,6 +141,7 @@ Substructure *CopySub(Substructure *sub)
    newSub = (Substructure *) malloc(sizeof(Substructure));
 
    newSub->definition = CopyGraph(sub->definition);
+   newSub->definitionCode = sub->definitionCode;
    newSub->posIncrementValue = sub->posIncrementValue;
    newSub->negIncrementValue = sub->negIncrementValue;
    newSub->value = sub->value;
@@ -247,7 +248,7 @@ void AddVertexTrees(SubList *subList, Parameters *parameters)
 
 void AddInstanceToTree(struct avl_table *avlTable, Instance *instance)
 {
-   ULONG *vertices;
+   INDEX *vertices;
    ULONG *j;
    ULONG i;
 
@@ -283,8 +284,7 @@ struct avl_table *GetSubTree(Substructure *sub, Parameters *parameters)
 
    while ((avlTableNode != NULL) && !found)
    {
-      if (GraphMatch(sub->definition, avlTableNode->sub->definition,
-                     parameters->labelList, 0.0, NULL, NULL))
+      if (SubDefinitionsMatch(sub, avlTableNode->sub, parameters->labelList))
          found = TRUE;
       else 
          avlTableNode = avlTableNode->next;
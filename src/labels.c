@@ -28,6 +28,8 @@ LabelList *AllocateLabelList(void)
    labelList->size = 0;
    labelList->numLabels = 0;
    labelList->labels = NULL;
+   labelList->hashSize = 0;
+   labelList->hashTable = NULL;
    return labelList;
 }
 
@@ -42,7 +44,8 @@ LabelList *AllocateLabelList(void)
 //
 // PURPOSE: Stores the given label, if not already present, in the
 // given label list and returns the label's index.  The given label's
-// memory can be freed after executing StoreLabel.
+// memory can be freed after executing StoreLabel.  A new label is added
+// to the list's hash table, and its substructure number is computed.
 //---------------------------------------------------------------------------
 
 ULONG StoreLabel(Label *label, LabelList *labelList)
@@ -54,6 +57,7 @@ ULONG StoreLabel(Label *label, LabelList *labelList)
    labelIndex = GetLabelIndex(label, labelList);
    if (labelIndex == labelList->numLabels) 
    { // i.e., label not found
+      CheckIndex(labelIndex, "label");
       // make sure there is room for a new label
       if (labelList->size == labelList->numLabels) 
       {
@@ -77,16 +81,24 @@ ULONG StoreLabel(Label *label, LabelList *labelList)
             strcpy(stringLabel, label->labelValue.stringLabel);
             labelList->labels[labelList->numLabels].labelValue.stringLabel =
                stringLabel;
+            labelList->labels[labelList->numLabels].subNumber =
+               ParseSubLabelNumber(stringLabel);
             break;
          case NUMERIC_LABEL:
             labelList->labels[labelList->numLabels].labelValue.numericLabel =
                label->labelValue.numericLabel;
+            labelList->labels[labelList->numLabels].subNumber = 0;
             break;
          default:
             break;  // error
       }
       labelList->labels[labelList->numLabels].used = FALSE;
       labelList->numLabels++;
+      // keep hash table at most half full
+      if ((2 * labelList->numLabels) > labelList->hashSize)
+         ResizeLabelHashTable(labelList);
+      else
+         InsertLabelHashTable(labelIndex, labelList);
    }
    return labelIndex;
 }
@@ -103,43 +115,144 @@ ULONG StoreLabel(Label *label, LabelList *labelList)
 //
 // PURPOSE: Returns the index of the given label in the given label
 // list.  If not found, then the index just past the end (i.e., number
-// of stored labels) is returned.
+// of stored labels) is returned.  The label is looked up in the list's
+// hash table, which is probed linearly from the label's hash.
 //---------------------------------------------------------------------------
 
 ULONG GetLabelIndex(Label *label, LabelList *labelList)
 {
-   ULONG i = 0;
-   ULONG labelIndex = labelList->numLabels;
-   BOOLEAN found = FALSE;
+   ULONG mask;
+   ULONG slot;
+   ULONG entry;
+
+   if (labelList->hashSize == 0)
+      return labelList->numLabels;
+   mask = labelList->hashSize - 1;
+   slot = LabelHash(label) & mask;
+   while ((entry = labelList->hashTable[slot]) != 0)
+   {
+      if (LabelsEqual(& labelList->labels[entry - 1], label))
+         return (entry - 1);
+      slot = (slot + 1) & mask;
+   }
+   return labelList->numLabels;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: LabelHash
+//
+// INPUTS: (Label *label)
+//
+// RETURN: (ULONG) - hash of label
+//
+// PURPOSE: Compute a hash of the label, so that labels satisfying
+// LabelsEqual have equal hashes.  Numeric labels hash the bits of their
+// value, with -0.0 hashed as 0.0 since the two compare equal.
+//---------------------------------------------------------------------------
 
-   while ((i < labelList->numLabels) && (! found)) 
+ULONG LabelHash(Label *label)
+{
+   ULONG hash = 2166136261UL;
+   unsigned long long bits;
+   double value;
+   char *s;
+
+   if (label->labelType == STRING_LABEL)
    {
-      if (labelList->labels[i].labelType == label->labelType) 
-      {
-         switch(label->labelType) 
-         {
-            case STRING_LABEL:
-               if (strcmp(labelList->labels[i].labelValue.stringLabel,
-                   label->labelValue.stringLabel) == 0) 
-               {
-                  labelIndex = i;
-                  found = TRUE;
-               }
-               break;
-            case NUMERIC_LABEL:
-               if (labelList->labels[i].labelValue.numericLabel ==
-                   label->labelValue.numericLabel) 
-               {
-                  labelIndex = i;
-                  found = TRUE;
-               }
-            default:
-               break;  // error
-         }
-      }
-      i++;
+      for (s = label->labelValue.stringLabel; *s != '\0'; s++)
+         hash = (hash ^ (UCHAR) *s) * 16777619UL;
+   }
+   else
+   {
+      value = label->labelValue.numericLabel;
+      if (value == 0.0)
+         value = 0.0;
+      memcpy(& bits, & value, sizeof(bits));
+      hash = MixCode((ULONG) (bits ^ (bits >> 32)));
+   }
+   return MixCode(hash + label->labelType);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: LabelsEqual
+//
+// INPUTS: (Label *label1)
+//         (Label *label2)
+//
+// RETURN: (BOOLEAN) - TRUE if labels are the same
+//
+// PURPOSE: Two labels are the same if they have the same type and equal
+// strings or values.
+//---------------------------------------------------------------------------
+
+BOOLEAN LabelsEqual(Label *label1, Label *label2)
+{
+   if (label1->labelType != label2->labelType)
+      return FALSE;
+   switch(label1->labelType)
+   {
+      case STRING_LABEL:
+         return (strcmp(label1->labelValue.stringLabel,
+                        label2->labelValue.stringLabel) == 0);
+      case NUMERIC_LABEL:
+         return (label1->labelValue.numericLabel ==
+                 label2->labelValue.numericLabel);
+      default:
+         return FALSE;  // error
    }
-   return labelIndex;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: InsertLabelHashTable
+//
+// INPUTS: (ULONG labelIndex) - index of label in label list
+//         (LabelList *labelList)
+//
+// RETURN: (void)
+//
+// PURPOSE: Add the label to the first free slot of the hash table from
+// its hash.  The label must not already be in the table.
+//---------------------------------------------------------------------------
+
+void InsertLabelHashTable(ULONG labelIndex, LabelList *labelList)
+{
+   ULONG mask = labelList->hashSize - 1;
+   ULONG slot;
+
+   slot = LabelHash(& labelList->labels[labelIndex]) & mask;
+   while (labelList->hashTable[slot] != 0)
+      slot = (slot + 1) & mask;
+   labelList->hashTable[slot] = labelIndex + 1;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ResizeLabelHashTable
+//
+// INPUTS: (LabelList *labelList)
+//
+// RETURN: (void)
+//
+// PURPOSE: Double the size of the label list's hash table, starting at
+// 128 slots, and insert all of the list's labels.
+//---------------------------------------------------------------------------
+
+void ResizeLabelHashTable(LabelList *labelList)
+{
+   ULONG hashSize;
+   ULONG i;
+
+   hashSize = (labelList->hashSize == 0) ? 128 : (2 * labelList->hashSize);
+   free(labelList->hashTable);
+   labelList->hashTable = (ULONG *) calloc(hashSize, sizeof(ULONG));
+   if (labelList->hashTable == NULL)
+      OutOfMemoryError("ResizeLabelHashTable:hashTable");
+   labelList->hashSize = hashSize;
+   for (i = 0; i < labelList->numLabels; i++)
+      InsertLabelHashTable(i, labelList);
 }
 
 
@@ -152,16 +265,34 @@ ULONG GetLabelIndex(Label *label, LabelList *labelList)
 // RETURN: (ULONG) - number from substructure label, or zero if 
 //                   label is not a valid substructure label
 //
+// PURPOSE: Returns the number of a substructure label of the form
+// <SUB_LABEL_STRING>_<#>, computed by ParseSubLabelNumber when the label
+// was stored.
+//---------------------------------------------------------------------------
+
+ULONG SubLabelNumber(ULONG index, LabelList *labelList)
+{
+   return labelList->labels[index].subNumber;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ParseSubLabelNumber
+//
+// INPUTS: (char *stringLabel) - string label
+//
+// RETURN: (ULONG) - number from substructure label, or zero if 
+//                   label is not a valid substructure label
+//
 // PURPOSE: Checks if label is a valid substructure label of the form
 // <SUB_LABEL_STRING>_<#>, where <#> is greater than zero.  If valid,
 // then <#> is returned; otherwise, returns zero.
 //---------------------------------------------------------------------------
 
-ULONG SubLabelNumber(ULONG index, LabelList *labelList)
+ULONG ParseSubLabelNumber(char *stringLabel)
 {
-   char *stringLabel;
    char prefix[TOKEN_LEN];
-   char rest[TOKEN_LEN];
+   char rest;
    BOOLEAN match;
    int i = 0;
    int labelLength;
@@ -170,23 +301,19 @@ ULONG SubLabelNumber(ULONG index, LabelList *labelList)
 
    match = TRUE;
    subNumber = 0;
-   if (labelList->labels[index].labelType == STRING_LABEL) 
-   { // string label?
-      stringLabel = labelList->labels[index].labelValue.stringLabel;
-      labelLength = strlen(stringLabel);
-      strcpy(prefix, SUB_LABEL_STRING);
-      prefixLength = strlen(prefix);
-      // check that first part of label matches SUB_LABEL_STRING
-      if (labelLength > (prefixLength + 1))
-         for (i = 0; ((i < prefixLength) && match); i++)
-            if (stringLabel[i] != prefix[i])
-               match = FALSE;
-      if (match && (stringLabel[i] != '_')) // underscore present?
-         match = FALSE;
-      if (match &&                          // rest is a number?
-          (sscanf((& stringLabel[i + 1]), "%lu%s", &subNumber, rest) != 1))
-         subNumber = 0;
-   }
+   labelLength = strlen(stringLabel);
+   strcpy(prefix, SUB_LABEL_STRING);
+   prefixLength = strlen(prefix);
+   // check that first part of label matches SUB_LABEL_STRING
+   if (labelLength > (prefixLength + 1))
+      for (i = 0; ((i < prefixLength) && match); i++)
+         if (stringLabel[i] != prefix[i])
+            match = FALSE;
+   if (match && (stringLabel[i] != '_')) // underscore present?
+      match = FALSE;
+   if (match &&                          // rest is a number?
+       (sscanf((& stringLabel[i + 1]), "%lu %c", &subNumber, &rest) != 1))
+      subNumber = 0;
    return subNumber;
 }
 
@@ -287,6 +414,7 @@ void PrintLabelList(LabelList *labelList)
 
 void FreeLabelList(LabelList *labelList)
 {
+   free(labelList->hashTable);
    free(labelList->labels);
    free(labelList);
 }
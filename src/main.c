@@ -42,6 +42,7 @@ int main (int argc, char **argv)
    FILE *outputFile;
    ULONG iteration;
    BOOLEAN done;
+   ULONG cacheHits, cacheMisses;
 
    clktck = sysconf(_SC_CLK_TCK);
    startTime = times(&tmsstart);
@@ -183,6 +184,12 @@ int main (int argc, char **argv)
       }
    }
 
+   if (parameters->outputLevel > 2)
+   {
+      MatchCacheCounts(& cacheHits, & cacheMisses);
+      printf("Graph match cache: %lu hits, %lu misses\n",
+             cacheHits, cacheMisses);
+   }
    FreeParameters(parameters);
    endTime = times(&tmsend);
    printf("\nSUBDUE done (elapsed CPU time = %7.2f seconds).\n",
@@ -416,6 +423,8 @@ Parameters *GetParameters(int argc, char *argv[])
    parameters->relations = FALSE;
    parameters->incremental = FALSE;
    parameters->compress = FALSE;
+   parameters->numThreads = 1;
+   parameters->matchMethod = MATCH_SEARCH;
 
    if (argc < 2)
    {
@@ -475,6 +484,17 @@ Parameters *GetParameters(int argc, char *argv[])
          parameters->limit = ulongArg;
          limitSet = TRUE;
       }
+      else if (strcmp(argv[i], "-match") == 0)
+      {
+         i++;
+         sscanf(argv[i], "%lu", &ulongArg);
+         if ((ulongArg < 1) || (ulongArg > 2))
+         {
+            fprintf(stderr, "%s: match must be 1-2\n", argv[0]);
+            exit(1);
+         }
+         parameters->matchMethod = ulongArg;
+      }
       else if (strcmp(argv[i], "-maxsize") == 0)
       {
          i++;
@@ -548,6 +568,18 @@ Parameters *GetParameters(int argc, char *argv[])
          parameters->relations = TRUE;
          parameters->variables = TRUE; // relations must involve variables
       }
+      else if (strcmp(argv[i], "-threads") == 0)
+      {
+         i++;
+         sscanf(argv[i], "%lu", &ulongArg);
+         if (ulongArg == 0)
+         {
+            fprintf(stderr, "%s: threads must be greater than zero\n",
+                    argv[0]);
+            exit(1);
+         }
+         parameters->numThreads = ulongArg;
+      }
       else if (strcmp(argv[i], "-threshold") == 0)
       {
          i++;
@@ -593,6 +625,7 @@ Parameters *GetParameters(int argc, char *argv[])
    // read graphs from input file
    strcpy(parameters->inputFileName, argv[argc - 1]);
    parameters->labelList = AllocateLabelList();
+   AllocateParameterMarks(parameters);
    parameters->posGraph = NULL;
    parameters->negGraph = NULL;
    parameters->numPosEgs = 0;
@@ -764,6 +797,7 @@ void PrintParameters(Parameters *parameters)
    else
       printf("%lu\n", parameters->iterations);
    printf("  Limit.......................... %lu\n", parameters->limit);
+   printf("  Number of threads.............. %lu\n", parameters->numThreads);
    printf("  Minimum size of substructures.. %lu\n", parameters->minVertices);
    printf("  Maximum size of substructures.. %lu\n", parameters->maxVertices);
    printf("  Number of best substructures... %lu\n", parameters->numBestSubs);
@@ -773,6 +807,12 @@ void PrintParameters(Parameters *parameters)
    printf("  Prune.......................... ");
    PrintBoolean(parameters->prune);
    printf("  Threshold...................... %lf\n", parameters->threshold);
+   printf("  Match method................... ");
+   switch(parameters->matchMethod)
+   {
+      case MATCH_SEARCH: printf("search\n"); break;
+      case MATCH_BIPARTITE: printf("bipartite\n"); break;
+   }
    printf("  Value-based queue.............. ");
    PrintBoolean(parameters->valueBased);
    printf("  Recursion...................... ");
@@ -808,5 +848,6 @@ void FreeParameters(Parameters *parameters)
    free(parameters->posEgsVertexIndices);
    free(parameters->negEgsVertexIndices);
    free(parameters->log2Factorial);
+   FreeParameterMarks(parameters);
    free(parameters);
 }
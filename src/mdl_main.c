@@ -3,7 +3,7 @@
 //
 // Main functions for standalone MDL computation.
 //
-// Usage: mdl [-dot <filename>] [-overlap] [-threshold #] g1 g2
+// Usage: mdl [-dot <filename>] [-match #] [-overlap] [-threshold #] g1 g2
 //
 // Computes the description length of g1, g2 and g2 compressed with g1
 // along with the final MDL compression measure:
@@ -12,7 +12,10 @@
 // overlap in g2.  If -threshold is given, then instances in g2 may
 // not be an exact match to g1, but the cost of transforming g1 to the
 // instance is less than the threshold fraction of the size of the
-// larger graph.  Default threshold is 0.0, i.e., exact match.
+// larger graph.  Default threshold is 0.0, i.e., exact match.  The
+// -match option selects how inexact instances are matched: 1 (default)
+// searches for the least-cost match, 2 uses the faster approximate
+// bipartite matcher.
 //
 // If a filename is given with the -dot option, then the compressed
 // graph is written to the file in dot format, which is defined in
@@ -87,7 +90,7 @@ int main(int argc, char **argv)
    subLabelIndex = numLabels; // index of "SUB" label
    numLabels++; // add one for new "SUB" vertex label
    if ((parameters->allowInstanceOverlap) &&
-       (InstancesOverlap(instanceList)))
+       (InstancesOverlap(instanceList, g2, parameters->graphMarks)))
       numLabels++; // add one for new "OVERLAP" edge label
    compressedDL = MDL(g2compressed, numLabels, parameters);
    // add extra bits to describe where external edges connect to instances
@@ -139,6 +142,7 @@ Parameters *GetParameters(int argc, char *argv[])
    Parameters *parameters;
    int i;
    double doubleArg;
+   ULONG ulongArg;
 
    if (argc < 3)
    {
@@ -154,6 +158,7 @@ Parameters *GetParameters(int argc, char *argv[])
    parameters->directed = TRUE;
    parameters->allowInstanceOverlap = FALSE;
    parameters->threshold = 0.0;
+   parameters->matchMethod = MATCH_SEARCH;
    parameters->outputToFile = FALSE;
    parameters->posGraph = NULL;
    parameters->negGraph = NULL;
@@ -169,6 +174,17 @@ Parameters *GetParameters(int argc, char *argv[])
          strcpy(parameters->outFileName, argv[i]);
          parameters->outputToFile = TRUE;
       } 
+      else if (strcmp(argv[i], "-match") == 0) 
+      {
+         i++;
+         sscanf(argv[i], "%lu", &ulongArg);
+         if ((ulongArg < 1) || (ulongArg > 2)) 
+         {
+            fprintf(stderr, "%s: match must be 1-2\n", argv[0]);
+            exit(1);
+         }
+         parameters->matchMethod = ulongArg;
+      } 
       else if (strcmp(argv[i], "-overlap") == 0) 
       {
          parameters->allowInstanceOverlap = TRUE;
@@ -201,6 +217,7 @@ Parameters *GetParameters(int argc, char *argv[])
    parameters->log2Factorial[1] = 0; // lg(1!)
 
    parameters->labelList = AllocateLabelList();
+   AllocateParameterMarks(parameters);
 
    return parameters;
 }
@@ -220,5 +237,6 @@ void FreeParameters(Parameters *parameters)
 {
    FreeLabelList(parameters->labelList);
    free(parameters->log2Factorial);
+   FreeParameterMarks(parameters);
    free(parameters);
 }
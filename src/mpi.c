@@ -63,8 +63,7 @@ BOOLEAN UniqueChildSub(Substructure *sub, Substructure **subs,
    for (i = 1; i <= parameters->numPartitions; i++) 
    {
       if (subs[i] != NULL)
-         if (GraphMatch(sub->definition, subs[i]->definition,
-                        parameters->labelList, 0.0, NULL, NULL))
+         if (SubDefinitionsMatch(sub, subs[i], parameters->labelList))
             return FALSE;
    }
    return TRUE;
@@ -292,8 +291,8 @@ Substructure *FindEvalSub(Substructure *sub, SubList *evalSubs,
       subListNode = evalSubs->head;
       while (subListNode != NULL) 
       {
-         if (GraphMatch(sub->definition, subListNode->sub->definition,
-                        parameters->labelList, 0.0, NULL, NULL))
+         if (SubDefinitionsMatch(sub, subListNode->sub,
+                                 parameters->labelList))
             return subListNode->sub;
          subListNode = subListNode->next;
       }
@@ -371,6 +370,7 @@ void PackGraph(Graph *graph, Parameters *parameters, char *buffer,
 {
    ULONG numVertices;
    ULONG numEdges;
+   ULONG vertex1, vertex2;
    ULONG v, e;
    Edge *edge;
 
@@ -397,9 +397,11 @@ void PackGraph(Graph *graph, Parameters *parameters, char *buffer,
       edge = & graph->edges[e];
       MPI_Pack(&(edge->directed), 1, MPI_UNSIGNED_CHAR, buffer,
                MPI_BUFFER_SIZE, position, MPI_COMM_WORLD);
-      MPI_Pack(&(edge->vertex1), 1, MPI_UNSIGNED_LONG, buffer,
+      vertex1 = edge->vertex1; // packed as ULONG, whatever INDEX is
+      vertex2 = edge->vertex2;
+      MPI_Pack(&vertex1, 1, MPI_UNSIGNED_LONG, buffer,
                MPI_BUFFER_SIZE, position, MPI_COMM_WORLD);
-      MPI_Pack(&(edge->vertex2), 1, MPI_UNSIGNED_LONG, buffer,
+      MPI_Pack(&vertex2, 1, MPI_UNSIGNED_LONG, buffer,
                MPI_BUFFER_SIZE, position, MPI_COMM_WORLD);
       PackLabel(edge->label, parameters->labelList, buffer, position);
    }
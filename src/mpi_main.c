@@ -410,6 +410,8 @@ Parameters *GetParameters(int argc, char *argv[], int processRank)
    parameters->relations = FALSE;
    parameters->incremental = FALSE;
    parameters->compress = FALSE;
+   parameters->numThreads = 1;
+   parameters->matchMethod = MATCH_SEARCH;
 
    if (argc < 2)
    {
@@ -587,6 +589,7 @@ Parameters *GetParameters(int argc, char *argv[], int processRank)
    parameters->incrementList->head = NULL;
 
    parameters->labelList = AllocateLabelList();
+   AllocateParameterMarks(parameters);
 
    // initialize log2Factorial[0..1]
    parameters->log2Factorial = (double *) malloc(2 * sizeof(double));
@@ -739,5 +742,6 @@ void FreeParameters(Parameters *parameters)
    free(parameters->posEgsVertexIndices);
    free(parameters->negEgsVertexIndices);
    free(parameters->log2Factorial);
+   FreeParameterMarks(parameters);
    free(parameters);
 }
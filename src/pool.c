@@ -0,0 +1,196 @@
+//---------------------------------------------------------------------------
+// pool.c
+//
+// Pooled allocation of the small, fixed-size structures that are
+// created and freed in large numbers during discovery (instances and
+// instance and substructure list nodes).  Objects are carved from large
+// slabs and recycled through free lists instead of being returned to
+// malloc.  Each thread keeps a private cache of free objects and only
+// takes the pool's lock to exchange a batch of objects with the shared
+// free list.  Compiling with -DNO_MEMORY_POOL reverts to plain
+// malloc/free, e.g., for use with memory checkers.
+//
+// Subdue 5
+//---------------------------------------------------------------------------
+
+#include "subdue.h"
+
+// Shared pools, indexed by POOL_* constants
+static MemoryPool pools[NUM_POOLS] =
+{
+   { sizeof(Instance), NULL, 0, PTHREAD_MUTEX_INITIALIZER },
+   { sizeof(InstanceListNode), NULL, 0, PTHREAD_MUTEX_INITIALIZER },
+   { sizeof(SubListNode), NULL, 0, PTHREAD_MUTEX_INITIALIZER }
+};
+
+// Calling thread's caches of free objects
+static __thread PoolCache poolCaches[NUM_POOLS];
+
+
+//---------------------------------------------------------------------------
+// NAME: PoolAllocate
+//
+// INPUTS: (ULONG pool) - POOL_* constant of pool to allocate from
+//
+// RETURN: (void *) - newly allocated, uninitialized object
+//
+// PURPOSE: Allocate an object of the pool's type.  The object must be
+// freed with PoolFree, but may be freed by a different thread.
+//---------------------------------------------------------------------------
+
+void *PoolAllocate(ULONG pool)
+{
+#ifdef NO_MEMORY_POOL
+   void *object = malloc(pools[pool].objectSize);
+   if (object == NULL)
+      OutOfMemoryError("PoolAllocate:object");
+   return object;
+#else
+   PoolCache *cache = & poolCaches[pool];
+   PoolObject *object;
+
+   if (cache->freeList == NULL)
+      RefillPoolCache(pool);
+   object = cache->freeList;
+   cache->freeList = object->next;
+   cache->numFree--;
+   return (void *) object;
+#endif
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: PoolFree
+//
+// INPUTS: (ULONG pool) - POOL_* constant of pool object allocated from
+//         (void *object) - object to free
+//
+// RETURN: (void)
+//
+// PURPOSE: Return the object to the calling thread's cache.  If the
+// cache grows too large, a batch of objects is returned to the pool.
+//---------------------------------------------------------------------------
+
+void PoolFree(ULONG pool, void *object)
+{
+#ifdef NO_MEMORY_POOL
+   free(object);
+#else
+   PoolCache *cache = & poolCaches[pool];
+   PoolObject *poolObject = (PoolObject *) object;
+
+   poolObject->next = cache->freeList;
+   cache->freeList = poolObject;
+   cache->numFree++;
+   if (cache->numFree > (2 * POOL_BATCH_SIZE))
+      FlushPoolCache(pool, POOL_BATCH_SIZE);
+#endif
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: RefillPoolCache
+//
+// INPUTS: (ULONG pool) - POOL_* constant of pool
+//
+// RETURN: (void)
+//
+// PURPOSE: Move a batch of free objects from the pool to the calling
+// thread's empty cache, first carving a new slab of objects if the
+// pool has none free.
+//---------------------------------------------------------------------------
+
+void RefillPoolCache(ULONG pool)
+{
+   MemoryPool *memoryPool = & pools[pool];
+   PoolCache *cache = & poolCaches[pool];
+   PoolObject *object;
+   char *slab;
+   ULONG objectSize;
+   ULONG i;
+
+   pthread_mutex_lock(& memoryPool->lock);
+   if (memoryPool->freeList == NULL)
+   {
+      // round object size up so every object in slab is aligned
+      objectSize = ((memoryPool->objectSize + sizeof(double) - 1) /
+                    sizeof(double)) * sizeof(double);
+      slab = (char *) malloc(objectSize * POOL_SLAB_SIZE);
+      if (slab == NULL)
+         OutOfMemoryError("RefillPoolCache:slab");
+      for (i = 0; i < POOL_SLAB_SIZE; i++)
+      {
+         object = (PoolObject *) (slab + (i * objectSize));
+         object->next = memoryPool->freeList;
+         memoryPool->freeList = object;
+      }
+      memoryPool->numFree += POOL_SLAB_SIZE;
+   }
+   // take up to a batch of objects
+   for (i = 0; ((i < POOL_BATCH_SIZE) && (memoryPool->freeList != NULL)); i++)
+   {
+      object = memoryPool->freeList;
+      memoryPool->freeList = object->next;
+      object->next = cache->freeList;
+      cache->freeList = object;
+   }
+   memoryPool->numFree -= i;
+   cache->numFree += i;
+   pthread_mutex_unlock(& memoryPool->lock);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FlushPoolCache
+//
+// INPUTS: (ULONG pool) - POOL_* constant of pool
+//         (ULONG numObjects) - maximum number of objects to return
+//
+// RETURN: (void)
+//
+// PURPOSE: Move up to numObjects free objects from the calling
+// thread's cache back to the pool.
+//---------------------------------------------------------------------------
+
+void FlushPoolCache(ULONG pool, ULONG numObjects)
+{
+   MemoryPool *memoryPool = & pools[pool];
+   PoolCache *cache = & poolCaches[pool];
+   PoolObject *object;
+   ULONG i;
+
+   pthread_mutex_lock(& memoryPool->lock);
+   for (i = 0; ((i < numObjects) && (cache->freeList != NULL)); i++)
+   {
+      object = cache->freeList;
+      cache->freeList = object->next;
+      object->next = memoryPool->freeList;
+      memoryPool->freeList = object;
+   }
+   memoryPool->numFree += i;
+   cache->numFree -= i;
+   pthread_mutex_unlock(& memoryPool->lock);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: ReleasePoolCaches
+//
+// INPUTS: (void)
+//
+// RETURN: (void)
+//
+// PURPOSE: Return all of the calling thread's cached objects to their
+// pools.  Must be called by a thread before it exits, so that its free
+// objects remain available to other threads.
+//---------------------------------------------------------------------------
+
+void ReleasePoolCaches(void)
+{
+#ifndef NO_MEMORY_POOL
+   ULONG pool;
+
+   for (pool = 0; pool < NUM_POOLS; pool++)
+      FlushPoolCache(pool, poolCaches[pool].numFree);
+#endif
+}
@@ -169,14 +169,20 @@ InstanceList *ExtendInstancesByEdge(InstanceList *instanceList,
    ULONG e2;
    Edge *edge2;
    Vertex *vertex2;
+   InstanceSet *instanceSet;
+
+   // parameters used
+   GraphMarks *marks = parameters->graphMarks;
 
    newInstanceList = AllocateInstanceList();
+   instanceSet = AllocateInstanceSet(LIST_SIZE_INC);
    // extend each instance
    instanceListNode = instanceList->head;
    while (instanceListNode != NULL) 
    {
       instance = instanceListNode->instance;
-      MarkInstanceEdges(instance, g2, TRUE);
+      ResetGraphMarks(marks, g2);
+      MarkInstanceEdges(instance, marks, TRUE);
       // consider extending from each vertex in instance
       for (v2 = 0; v2 < instance->numVertices; v2++) 
       {
@@ -184,20 +190,23 @@ InstanceList *ExtendInstancesByEdge(InstanceList *instanceList,
          for (e2 = 0; e2 < vertex2->numEdges; e2++) 
          {
             edge2 = & g2->edges[vertex2->edges[e2]];
-            if ((! edge2->used) &&
+            if ((! EDGE_MARKED(marks, vertex2->edges[e2])) &&
                 (EdgesMatch(g1, edge1, g2, edge2, parameters))) 
             {
                // add new instance to list
                newInstance =
                   CreateExtendedInstance(instance, instance->vertices[v2],
                                          vertex2->edges[e2], g2);
-               InstanceListInsert(newInstance, newInstanceList, TRUE);
+               if (InstanceSetInsert(newInstance, instanceSet))
+                  InstanceListInsert(newInstance, newInstanceList, FALSE);
+               else
+                  FreeInstance(newInstance);
             }
          }
       }
-      MarkInstanceEdges(instance, g2, FALSE);
       instanceListNode = instanceListNode->next;
    }
+   FreeInstanceSet(instanceSet);
    FreeInstanceList(instanceList);
    return newInstanceList;
 }
@@ -262,7 +271,9 @@ BOOLEAN EdgesMatch(Graph *g1, Edge *edge1, Graph *g2, Edge *edge2,
 // PURPOSE: Creates and returns a new instance list containing only
 // those instances matching subGraph.  If
 // parameters->allowInstanceOverlap=FALSE, then remaining instances
-// will not overlap.  The given instance list is de-allocated.
+// will not overlap; the vertices of kept instances are marked in the
+// scratch graph marks to test this.  The given instance list is
+// de-allocated.
 //---------------------------------------------------------------------------
 
 InstanceList *FilterInstances(Graph *subGraph, InstanceList *instanceList,
@@ -274,10 +285,13 @@ InstanceList *FilterInstances(Graph *subGraph, InstanceList *instanceList,
    Graph *instanceGraph;
    double thresholdLimit;
    double matchCost;
+   GraphMarks *marks = parameters->graphMarks;
 
    newInstanceList = AllocateInstanceList();
    if (instanceList != NULL) 
    {
+      if (! parameters->allowInstanceOverlap)
+         ResetGraphMarks(marks, graph);
       instanceListNode = instanceList->head;
       while (instanceListNode != NULL) 
       {
@@ -285,17 +299,20 @@ InstanceList *FilterInstances(Graph *subGraph, InstanceList *instanceList,
          {
             instance = instanceListNode->instance;
             if (parameters->allowInstanceOverlap ||
-                (! InstanceListOverlap(instance, newInstanceList))) 
+                (! MarkedInstanceOverlap(instance, marks))) 
             {
                thresholdLimit = parameters->threshold *
                                 (instance->numVertices + instance->numEdges);
                instanceGraph = InstanceToGraph(instance, graph);
                if (GraphMatch(subGraph, instanceGraph, parameters->labelList,
-                              thresholdLimit, & matchCost, NULL)) 
+                              thresholdLimit, parameters->matchMethod,
+                              & matchCost, NULL)) 
                {
                   if (matchCost < instance->minMatchCost)
                      instance->minMatchCost = matchCost;
                   InstanceListInsert(instance, newInstanceList, FALSE);
+                  if (! parameters->allowInstanceOverlap)
+                     MarkInstanceVertices(instance, marks, TRUE);
                }
                FreeGraph(instanceGraph);
             }
@@ -3,14 +3,16 @@
 //
 // Main functions for standalone subgraph isomorphism algorithm.
 //
-// Usage: sgiso [-dot <filename>] [-overlap] [-threshold #] g1 g2
+// Usage: sgiso [-dot <filename>] [-match #] [-overlap] [-threshold #] g1 g2
 //
 // Finds and prints all instances of g1 in g2.  If -overlap is given,
 // then instances may overlap in g2.  If -threshold is given, then
 // instances may not be an exact match to g1, but the cost of
 // transforming g1 to the instance is less than the threshold fraction
 // of the size of the larger graph.  Default threshold is 0.0, i.e.,
-// exact match.
+// exact match.  The -match option selects how inexact instances are
+// matched: 1 (default) searches for the least-cost match, 2 uses the
+// faster approximate bipartite matcher.
 //
 // If a filename is given with the -dot option, then g2 is written to
 // the file in dot format, with instances highlighted in red, which is
@@ -93,6 +95,7 @@ Parameters *GetParameters(int argc, char *argv[])
    Parameters *parameters;
    int i;
    double doubleArg;
+   ULONG ulongArg;
 
    if (argc < 3) 
    {
@@ -108,6 +111,7 @@ Parameters *GetParameters(int argc, char *argv[])
    parameters->directed = TRUE;
    parameters->allowInstanceOverlap = FALSE;
    parameters->threshold = 0.0;
+   parameters->matchMethod = MATCH_SEARCH;
    parameters->outputToFile = FALSE;
  
    // process command-line options
@@ -120,6 +124,17 @@ Parameters *GetParameters(int argc, char *argv[])
          strcpy(parameters->outFileName, argv[i]);
          parameters->outputToFile = TRUE;
       } 
+      else if (strcmp(argv[i], "-match") == 0) 
+      {
+         i++;
+         sscanf(argv[i], "%lu", &ulongArg);
+         if ((ulongArg < 1) || (ulongArg > 2)) 
+         {
+            fprintf(stderr, "%s: match must be 1-2\n", argv[0]);
+            exit(1);
+         }
+         parameters->matchMethod = ulongArg;
+      } 
       else if (strcmp(argv[i], "-overlap") == 0) 
       {
          parameters->allowInstanceOverlap = TRUE;
@@ -144,6 +159,7 @@ Parameters *GetParameters(int argc, char *argv[])
    }
 
    parameters->labelList = AllocateLabelList();
+   AllocateParameterMarks(parameters);
 
    return parameters;
 }
@@ -162,5 +178,6 @@ Parameters *GetParameters(int argc, char *argv[])
 void FreeParameters(Parameters *parameters)
 {
    FreeLabelList(parameters->labelList);
+   FreeParameterMarks(parameters);
    free(parameters);
 }
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "avl.h"
 
@@ -25,10 +26,17 @@
 #define EVAL_SIZE     2
 #define EVAL_SETCOVER 3
 
+// Graph match methods
+#define MATCH_SEARCH    1 // best-first search for least-cost mapping
+#define MATCH_BIPARTITE 2 // mapping from vertex assignment, O(V^3)
+
 // Graph match search space limited to V^MATCH_SEARCH_THRESHOLD_EXPONENT
 // If set to zero, then no limit
 #define MATCH_SEARCH_THRESHOLD_EXPONENT 4.0
 
+// Number of neighborhood refinements used to compute a graph's code
+#define GRAPH_CODE_ROUNDS 3
+
 // Starting strings for input files
 #define SUB_TOKEN        "S"  // new substructure
 #define PREDEF_SUB_TOKEN "PS" // new predefined substructure
@@ -55,6 +63,11 @@
 #define SUBSTITUTE_EDGE_DIRECTION_COST 1.0 // change directedness of edge
 #define REVERSE_EDGE_DIRECTION_COST    1.0 // change direction of directed edge
 
+// Lower bounds on the costs above, used to bound the cost of a match
+// from graph invariants; must not exceed any vertex or edge cost above
+#define MIN_VERTEX_EDIT_COST 1.0
+#define MIN_EDGE_EDIT_COST   1.0
+
 // MPI message tags
 #define MPI_MSG_EVAL     1
 #define MPI_MSG_EVAL_SUB 2
@@ -64,13 +77,22 @@
 // including instances)
 #define MPI_BUFFER_SIZE 16384
 
+// Largest vertex, edge or label index (see INDEX below); compiling with
+// -DINDEX32 makes indices 32 bits
+#ifdef INDEX32
+#define MAX_INDEX UINT_MAX  // UINT_MAX defined in limits.h
+#else
+#define MAX_INDEX ULONG_MAX
+#endif
+
 // Constants for graph matcher.  Special vertex mappings use the upper few
-// unsigned long integers.  This assumes graphs will never have this many
-// vertices, which is a pretty safe assumption.  The maximum double is used
-// for initial costs.
+// indices.  Graphs are checked not to have this many vertices when they
+// are built (see CheckIndex).  The maximum double is used for initial
+// costs.
 #define MAX_UNSIGNED_LONG ULONG_MAX  // ULONG_MAX defined in limits.h
-#define VERTEX_UNMAPPED   MAX_UNSIGNED_LONG
-#define VERTEX_DELETED    MAX_UNSIGNED_LONG - 1
+#define VERTEX_UNMAPPED   MAX_INDEX
+#define VERTEX_DELETED    MAX_INDEX - 1
+#define MATCH_NO_NODE     MAX_UNSIGNED_LONG  // end of partial mapping chain
 #define MAX_DOUBLE        DBL_MAX    // DBL_MAX from float.h
 
 // Label types
@@ -85,6 +107,42 @@
 #define NUMERIC_OUTPUT_PRECISION 6
 #define LOG_2 0.6931471805599452862 // log_e(2) pre-computed
 
+// Memory pools (see pool.c)
+#define POOL_INSTANCE           0
+#define POOL_INSTANCE_LIST_NODE 1
+#define POOL_SUB_LIST_NODE      2
+#define NUM_POOLS               3
+#define POOL_SLAB_SIZE  1024  // number of objects allocated at a time
+#define POOL_BATCH_SIZE  256  // objects moved between pool and thread cache
+
+// Graphs with at most VERTEX_MASK_BITS vertices keep their vertices'
+// neighbors as VertexMasks
+#define VERTEX_MASK_BITS 64
+#define VertexBit(v) (((VertexMask) 1) << (v))
+
+// Binary graph files (see graphfile.c)
+#define BINARY_GRAPH_MAGIC      "SUBDUEBG" // first 8 bytes of file
+#define BINARY_GRAPH_VERSION    2
+#define BINARY_GRAPH_BYTE_ORDER 0x01020304UL // as written on this platform
+#define BINARY_GRAPH_ALIGN      8  // alignment of sections within file
+
+// Compressed graph files, decompressed as they are read (see graphfile.c)
+#define GZIP_MAGIC "\x1f\x8b"         // first bytes of gzip file
+#define ZSTD_MAGIC "\x28\xb5\x2f\xfd" // first bytes of zstd file
+#define ZSTD_COMMAND "zstd"           // command run to decompress zstd file
+#define DECOMPRESS_BUFFER_SIZE 262144 // bytes decompressed at a time
+#define STREAM_WINDOW_SIZE 1048576    // initial buffer for a graph file
+                                      //   read as a stream
+
+// Graph files read by several threads (see graphfile.c)
+#define PARALLEL_READ_SIZE 1048576 // least bytes of file read by a thread
+
+// Graph match result cache of each thread (see graphmatch.c)
+#define MATCH_CACHE_SETS 1024 // number of sets of entries; a power of two
+#define MATCH_CACHE_WAYS    4 // entries per set
+#define MATCH_CACHE_GRAPH_SIZE 256 // most ULONGs in a cached pair's
+                                   //   encoding
+
 #define SPACE ' '
 #define TAB   '\t'
 #define NEWLINE '\n'
@@ -102,6 +160,17 @@ typedef unsigned char UCHAR;
 typedef unsigned char BOOLEAN;
 typedef unsigned long ULONG;
 
+// INDEX: index of a vertex, edge or label in a graph, instance or vertex
+// mapping.  Compiling with -DINDEX32 makes it 32 bits, which about halves
+// the memory of graphs and instances, but limits graphs to fewer than
+// MAX_INDEX - 1 vertices, edges and labels.
+#ifdef INDEX32
+typedef unsigned int INDEX;
+#else
+typedef ULONG INDEX;
+#endif
+typedef unsigned long long VertexMask; // set of vertices of a small graph
+
 // Label
 typedef struct 
 {
@@ -112,6 +181,7 @@ typedef struct
       double numericLabel;
    } labelValue;
    BOOLEAN used;          // flag used to mark labels at various times
+   ULONG subNumber;       // SubLabelNumber of label; set by StoreLabel
 } Label;
 
 // Label list
@@ -120,14 +190,16 @@ typedef struct
    ULONG size;      // Number of label slots currently allocated in array
    ULONG numLabels; // Number of actual labels stored in list
    Label *labels;   // Array of labels
+   ULONG hashSize;  // Number of slots in hash table; a power of two
+   ULONG *hashTable; // Label index + 1 of labels, by hash; 0 if empty slot
 } LabelList;
 
 // Edge
 typedef struct 
 {
-   ULONG   vertex1;  // source vertex index into vertices array
-   ULONG   vertex2;  // target vertex index into vertices array
-   ULONG   label;    // index into label list of edge's label
+   INDEX   vertex1;  // source vertex index into vertices array
+   INDEX   vertex2;  // target vertex index into vertices array
+   INDEX   label;    // index into label list of edge's label
    BOOLEAN directed; // TRUE if edge is directed
    BOOLEAN used;     // flag for marking edge used at various times
                      //   used flag assumed FALSE, so always reset when done
@@ -138,15 +210,63 @@ typedef struct
 // Vertex
 typedef struct 
 {
-   ULONG label;    // index into label list of vertex's label
-   ULONG numEdges; // number of edges defined using this vertex
-   ULONG *edges;   // indices into edge array of edges using this vertex
-   ULONG map;      // used to store mapping of this vertex to corresponding
+   INDEX label;    // index into label list of vertex's label
+   INDEX numEdges; // number of edges defined using this vertex
+   INDEX *edges;   // indices into edge array of edges using this vertex
+   INDEX map;      // used to store mapping of this vertex to corresponding
                    //   vertex in another graph
    BOOLEAN used;   // flag for marking vertex used at various times
                    //   used flag assumed FALSE, so always reset when done
 } Vertex;
 
+// GraphRowStats: per-vertex rows of the graph's MDL encoding, cached so
+// the description length of the graph compressed by a substructure can
+// be computed without building the compressed graph
+typedef struct
+{
+   ULONG *uniqueEdges;       // number of unique edges of each vertex
+   ULONG *maxEdges;          // maximum edges to a single vertex, per vertex
+   ULONG maxUniqueEdges;     // largest uniqueEdges
+   ULONG *uniqueEdgesCounts; // number of vertices with each uniqueEdges
+   ULONG maxMaxEdges;        // largest maxEdges
+   ULONG *maxEdgesCounts;    // number of vertices with each maxEdges
+} GraphRowStats;
+
+// RowEdge: edge of a row of a graph's adjacency matrix, sorted by the
+// vertex it goes to when computing the row's MDL statistics
+typedef struct
+{
+   ULONG vertex;       // other vertex, in compressed vertex order
+   ULONG position;     // position of edge in row
+   BOOLEAN outgoing;   // TRUE if directed out of row's vertex
+   BOOLEAN undirected; // TRUE if edge is undirected
+} RowEdge;
+
+// GraphInvariants: properties of a graph that do not depend on the
+// order of its vertices or edges, cached so that graph matches can be
+// rejected without searching for a mapping
+typedef struct
+{
+   ULONG *vertexLabels;    // labels of vertices, sorted
+   ULONG *edgeKeys;        // (label * 2) + directed of edges, sorted
+   ULONG *degrees;         // degrees of vertices, sorted
+   ULONG numDirectedEdges; // number of directed edges
+   ULONG code;             // GraphCode of graph, or 0 if not computed
+   VertexMask *neighbors;  // adjacent vertices of each vertex, including
+                           //   itself if it has a self edge; NULL if
+                           //   more than VERTEX_MASK_BITS vertices
+} GraphInvariants;
+
+// GraphFileMemory: contents of a binary graph file, used in place by the
+// graphs read from it and released when the last of them is freed
+typedef struct
+{
+   char *data;          // contents of file
+   size_t size;         // size of contents in data
+   BOOLEAN mapped;      // TRUE if data is memory-mapped, else allocated
+   ULONG refCount;      // number of graphs using data
+} GraphFileMemory;
+
 // Graph
 typedef struct 
 {
@@ -156,13 +276,139 @@ typedef struct
    Edge   *edges;      // array of graph edges
    ULONG  vertexListSize; // allocated size of vertices array
    ULONG  edgeListSize;   // allocated size of edges array
+   GraphRowStats *rowStats; // cached MDL rows, or NULL if not computed
+   GraphInvariants *invariants; // cached match invariants, or NULL if not
+                                //   computed
+   INDEX  *vertexEdges; // single array the vertices' edges arrays point
+                        //   into, or NULL if each is allocated separately
+   GraphFileMemory *fileMemory; // binary graph file memory holding edges
+                                //   and vertexEdges, or NULL if they are
+                                //   allocated
 } Graph;
 
+// Decompressor: thread feeding the decompressed contents of a graph file
+// into a pipe
+typedef struct
+{
+   pthread_t thread;
+   int inputFd;                  // compressed file
+   int outputFd;                 // write end of pipe
+   char fileName[FILE_NAME_LEN]; // name of compressed file, for errors
+   char error[TOKEN_LEN];        // why file cannot be decompressed, or ""
+} Decompressor;
+
+// GraphFile: graph file being scanned by the functions of graphfile.c;
+// its contents are memory-mapped, or read into a buffer as they are
+// scanned if the file is a pipe or compressed
+typedef struct
+{
+   char *data;          // contents of file, or part being scanned
+   size_t size;         // size of contents in data
+   size_t pos;          // position of next character to scan
+   ULONG lineNo;        // line number of position, from 1
+   BOOLEAN mapped;      // TRUE if data is memory-mapped, else allocated
+   size_t bufferSize;   // allocated size of data, if not mapped
+   int fd;              // file still being read into data, or -1 if all
+                        //   of its contents are in data
+   Decompressor *decompressor; // thread filling fd, or NULL
+   char *token;         // last token scanned, in data; not NUL-terminated
+   ULONG tokenLength;   // length of last token scanned
+   char *tokenBuffer;   // NUL-terminated copy of a token
+   ULONG tokenBufferSize; // allocated size of tokenBuffer
+   BOOLEAN exitOnError; // if FALSE, errors set failed instead of exiting
+   BOOLEAN failed;      // TRUE if scanning failed when not exitOnError
+} GraphFile;
+
+// ExampleGraph: positive or negative examples read from a graph file
+typedef struct
+{
+   Graph *graph;            // graph of examples, or NULL if none read
+   ULONG numEgs;            // number of examples in graph
+   ULONG *egsVertexIndices; // index of first vertex of each example
+} ExampleGraph;
+
+// GraphFileChunk: part of a graph file starting at an example token,
+// read by its own thread into its own graphs and label list
+typedef struct
+{
+   pthread_t thread;
+   GraphFile graphFile;      // view of chunk's part of file's contents
+   BOOLEAN directed;         // TRUE if 'e' edges are directed
+   LabelList *labelList;     // labels of chunk, in order of appearance
+   ULONG *labelMap;          // index in merged label list of each label
+   ExampleGraph examples[2]; // examples of chunk, indexed by NEG and POS
+} GraphFileChunk;
+
+// BinaryGraphSection: location within a binary graph file of the
+// positive or negative graph's arrays; offsets are from the start of the
+// file
+typedef struct
+{
+   ULONG numVertices;
+   ULONG numEdges;
+   ULONG numEgs;             // number of examples; no graph if zero
+   ULONG egsOffset;          // ULONG[numEgs]: first vertex of each example
+   ULONG vertexLabelsOffset; // INDEX[numVertices]: label of each vertex
+   ULONG edgeStartOffset;    // ULONG[numVertices + 1]: start of each
+                             //   vertex's edges in vertexEdges
+   ULONG vertexEdgesOffset;  // INDEX[]: edges of each vertex in turn
+   ULONG edgesOffset;        // Edge[numEdges]
+} BinaryGraphSection;
+
+// BinaryGraphHeader: start of a binary graph file, which holds the
+// graphs, examples and labels of a graph file in the form they are used
+// in memory
+typedef struct
+{
+   char magic[8];        // BINARY_GRAPH_MAGIC
+   ULONG version;        // BINARY_GRAPH_VERSION
+   ULONG byteOrder;      // BINARY_GRAPH_BYTE_ORDER
+   ULONG ulongSize;      // sizeof(ULONG)
+   ULONG indexSize;      // sizeof(INDEX)
+   ULONG edgeSize;       // sizeof(Edge)
+   ULONG directed;       // TRUE if 'e' edges were read as directed
+   ULONG numLabels;      // number of labels in label table
+   ULONG labelsOffset;   // label table: for each label, its type, then
+                         //   its value, or its length and string
+   ULONG labelsSize;     // size of label table
+   BinaryGraphSection graphs[2]; // positive and negative graphs
+} BinaryGraphHeader;
+
+// GraphMarks: scratch marks on the vertices and edges of a graph, kept
+// outside the graph so that the input graphs are only read during
+// discovery.  A vertex or edge is marked if its stamp equals the current
+// generation, so advancing the generation clears all marks at once.
+typedef struct
+{
+   Graph *graph;          // graph the marks currently belong to
+   ULONG generation;      // stamp of currently marked vertices and edges
+   ULONG vertexListSize;  // allocated size of vertex arrays
+   ULONG edgeListSize;    // allocated size of edge array
+   ULONG *vertexStamps;   // marks on vertices
+   ULONG *edgeStamps;     // marks on edges
+   ULONG *touchedStamps;  // second, independent set of marks on vertices
+   ULONG *vertexMap;      // mapping of each vertex to a vertex in another
+                          //   graph; only valid where set
+} GraphMarks;
+
+#define VERTEX_MARKED(marks, v) \
+   ((marks)->vertexStamps[v] == (marks)->generation)
+#define EDGE_MARKED(marks, e) \
+   ((marks)->edgeStamps[e] == (marks)->generation)
+#define VERTEX_TOUCHED(marks, v) \
+   ((marks)->touchedStamps[v] == (marks)->generation)
+#define MARK_VERTEX(marks, v, value) \
+   ((marks)->vertexStamps[v] = ((value) ? (marks)->generation : 0))
+#define MARK_EDGE(marks, e, value) \
+   ((marks)->edgeStamps[e] = ((value) ? (marks)->generation : 0))
+#define TOUCH_VERTEX(marks, v) \
+   ((marks)->touchedStamps[v] = (marks)->generation)
+
 // VertexMap: vertex to vertex mapping for graph match search
 typedef struct 
 {
-   ULONG v1;
-   ULONG v2;
+   INDEX v1;
+   INDEX v2;
 } VertexMap;
 
 // Instance
@@ -170,8 +416,8 @@ typedef struct _instance
 {
    ULONG numVertices;   // number of vertices in instance
    ULONG numEdges;      // number of edges in instance
-   ULONG *vertices;     // ordered indices of instance's vertices in graph
-   ULONG *edges;        // ordered indices of instance's edges in graph
+   INDEX *vertices;     // ordered indices of instance's vertices in graph
+   INDEX *edges;        // ordered indices of instance's edges in graph
    double minMatchCost; // lowest cost so far of matching this instance to
                         // a substructure
    ULONG newVertex;     // index into vertices array of newly added vertex
@@ -200,6 +446,39 @@ typedef struct
    InstanceListNode *head;
 } InstanceList;
 
+// InstanceSet: hash set of instances, keyed on their vertices and edges,
+// used to quickly reject duplicate instances
+typedef struct
+{
+   ULONG size;                // number of chains in table
+   ULONG numInstances;        // number of instances in set
+   InstanceListNode **table;  // chains of instances with same hash
+} InstanceSet;
+
+// InstanceBucket: positions in an instance list of the instances
+// sharing a key, as one entry of a hash table chain
+typedef struct _instance_bucket
+{
+   ULONG key;
+   ULONG numInstances;
+   ULONG size;        // allocated size of positions array
+   ULONG *positions;  // increasing positions of instances in list
+   struct _instance_bucket *next;
+} InstanceBucket;
+
+// InstanceBuckets: extended instances grouped by the properties any
+// instance matching them at threshold 0.0 must share
+typedef struct
+{
+   ULONG numInstances;
+   Instance **instances;  // instances in list order
+   ULONG *signatures;     // ExtensionSignature of each instance
+   ULONG *codes;          // GraphCode of each instance's graph
+   ULONG tableSize;
+   InstanceBucket **signatureTable; // hash table of buckets by signature
+   InstanceBucket **codeTable;      // hash table of buckets by code
+} InstanceBuckets;
+
 // Substructure
 typedef struct 
 {
@@ -215,6 +494,7 @@ typedef struct
    ULONG recursiveEdgeLabel;   // index into label list of recursive edge label
    double posIncrementValue;   // DL/#Egs value of sub for positive increment
    double negIncrementValue;   // DL/#Egs value of sub for negative increment
+   ULONG definitionCode;       // GraphCode of definition (0 = not computed)
 } Substructure;
 
 // SubListNode: node in singly-linked list of substructures
@@ -222,20 +502,65 @@ typedef struct _sub_list_node
 {
    Substructure *sub;
    struct _sub_list_node *next;
+   struct _sub_list_node *nextInIndex; // next node in SubIndex chain
 } SubListNode;
 
+// SubIndex: hash table of the nodes of a substructure list, keyed on
+// their definitions' codes, so that looking for a sub on the list only
+// visits subs whose definitions can match
+typedef struct
+{
+   ULONG size;          // number of chains in table
+   ULONG numSubs;       // number of nodes in index
+   SubListNode **table; // chains of nodes, linked by nextInIndex
+} SubIndex;
+
 // SubList: singly-linked list of substructures
 typedef struct 
 {
    SubListNode *head;
+   SubIndex *index;     // index of list's nodes, or NULL if not indexed
 } SubList;
 
+// PoolObject: free object in a memory pool's free list
+typedef struct _pool_object
+{
+   struct _pool_object *next;
+} PoolObject;
+
+// MemoryPool: shared free list of objects of one size
+typedef struct
+{
+   size_t objectSize;     // size of objects in pool
+   PoolObject *freeList;  // free objects
+   ULONG numFree;         // number of objects in freeList
+   pthread_mutex_t lock;  // guards freeList and numFree
+} MemoryPool;
+
+// PoolCache: a thread's private free list for one memory pool
+typedef struct
+{
+   PoolObject *freeList;
+   ULONG numFree;
+} PoolCache;
+
+// MatchMapNode: one vertex pair of a partial mapping in the graph match
+// search.  A partial mapping is the chain of pairs from its last pair
+// back through the parent links, so mappings share their prefixes.
+typedef struct
+{
+   ULONG v1;     // vertex in first graph
+   ULONG v2;     // vertex in second graph, or VERTEX_DELETED
+   ULONG parent; // index of previous pair in arena, or MATCH_NO_NODE
+} MatchMapNode;
+
 // MatchHeapNode: node in heap for graph match search queue
 typedef struct 
 {
    ULONG  depth; // depth of node in search space (number of vertices mapped)
    double cost;  // cost of mapping
-   VertexMap *mapping;
+   double bound; // cost plus lower bound on cost of mapping the rest
+   ULONG mapping; // index of mapping's last pair in arena, or MATCH_NO_NODE
 } MatchHeapNode;
 
 // MatchHeap: heap of match nodes
@@ -246,6 +571,70 @@ typedef struct
    MatchHeapNode *nodes;
 } MatchHeap;
 
+// MatchCacheEntry: result of a graph match, keyed by the graphs and the
+// settings of the match
+typedef struct
+{
+   ULONG code1;        // GraphCode of first graph, or 0 if entry unused
+   ULONG code2;        // GraphCode of second graph
+   ULONG numVertices1;
+   ULONG numEdges1;
+   ULONG numVertices2;
+   ULONG numEdges2;
+   double threshold;
+   ULONG matchMethod;
+   ULONG graphsLength; // length of graphs
+   ULONG *graphs;      // EncodeMatchGraphs encoding of both graphs
+   double cost;        // cost returned by matcher
+   ULONG lastUse;      // cache clock at last use, for eviction
+} MatchCacheEntry;
+
+// MatchWorkspace: buffers used by the graph matchers, kept by each thread
+// and reused from match to match so matching does not allocate memory
+typedef struct
+{
+   ULONG vertexListSize;    // allocated size of vertex buffers
+   ULONG *orderedVertices;  // order in which vertices of g1 are mapped
+   ULONG *mapped1;          // mapping of vertices in g1 to vertices in g2
+   ULONG *mapped2;          // mapping of vertices in g2 to vertices in g1
+   ULONG *parent;           // ExactGraphMatch: mapped neighbor of vertex
+   ULONG *nextChoice;       // ExactGraphMatch: next candidate at each depth
+   ULONG edgeListSize;      // allocated size of edgeUsed
+   BOOLEAN *edgeUsed;       // edges of g2 matched, by index
+   ULONG *vertexScratch;    // per-vertex values used while ordering
+   ULONG *vertexAssignment; // BipartiteGraphMatch: vertex of g2 assigned
+   ULONG numMatchLabels;    // number of distinct vertex labels in graphs
+   ULONG *labelValues;      // distinct vertex labels in graphs, sorted
+   ULONG *labelIds1;        // index in labelValues of g1 vertices' labels
+   ULONG *labelIds2;        // index in labelValues of g2 vertices' labels
+   ULONG *labelCounts1;     // labels of g1 vertices not yet mapped
+   ULONG *labelCounts2;     // labels of g2 vertices not yet mapped
+   ULONG *vertexPositions;  // position of g1 vertices in orderedVertices
+   ULONG assignmentSize;    // allocated size of assignment buffers
+   double *assignmentCosts; // BipartiteGraphMatch: cost matrix, by row
+   double *rowPotentials;   // dual values of assignment rows and columns
+   double *columnPotentials;
+   double *columnMinima;    // least reduced cost of reaching each column
+   ULONG *columnRows;       // row assigned to each column, or 0
+   ULONG *columnWays;       // previous column on augmenting path
+   BOOLEAN *columnUsed;     // columns on augmenting path tree
+   ULONG *edgeKeyStarts1;   // start of each g1 vertex's keys in edgeKeys
+   ULONG *edgeKeyStarts2;   // start of each g2 vertex's keys in edgeKeys
+   ULONG edgeKeyListSize;   // allocated size of edgeKeys
+   ULONG *edgeKeys;         // label and direction of edges, by vertex
+   MatchHeap *globalQueue;  // InexactGraphMatch search queues
+   MatchHeap *localQueue;
+   ULONG mapNodeListSize;   // allocated size of mapNodes arena
+   ULONG numMapNodes;       // number of pairs in arena
+   MatchMapNode *mapNodes;  // arena of partial mapping pairs
+   MatchCacheEntry *matchCache; // GraphMatch results, in sets of entries
+   ULONG matchCacheClock;   // number of cache lookups, for eviction
+   ULONG matchCacheHits;    // lookups answered by cache
+   ULONG matchCacheMisses;  // lookups needing a match
+   ULONG matchGraphsSize;   // allocated size of matchGraphs
+   ULONG *matchGraphs;      // encoding of graphs being looked up in cache
+} MatchWorkspace;
+
 // ReferenceEdge
 typedef struct
 {
@@ -400,8 +789,42 @@ typedef struct
                                    // instance vertices
    ULONG posGraphSize;
    ULONG negGraphSize;
+   ULONG numThreads;     // Number of threads used to extend and evaluate
+                         //   the substructures in the beam (default 1)
+   GraphMarks *posGraphMarks; // Marks on posGraph, kept across calls
+   GraphMarks *negGraphMarks; // Marks on negGraph, kept across calls
+   GraphMarks *graphMarks;    // Scratch marks, cleared by each user
+   ULONG matchMethod;    // One of MATCH_SEARCH (default) or MATCH_BIPARTITE,
+                         //   used by inexact graph matches
 } Parameters;
 
+// ExtendWorkItem: parent substructure to be extended by a discovery thread
+typedef struct
+{
+   Substructure *parentSub;  // substructure to be extended
+   SubList *extendedSubList; // evaluated extensions of parentSub
+} ExtendWorkItem;
+
+// ExtendWorkQueue: parent substructures shared by the discovery threads
+typedef struct
+{
+   ExtendWorkItem *items; // one item per parent to be extended, in beam order
+   ULONG size;            // allocated size of items
+   ULONG numItems;        // number of items in queue
+   ULONG nextItem;        // index of next item to be claimed by a thread
+   pthread_mutex_t lock;  // protects nextItem
+} ExtendWorkQueue;
+
+// ExtendWorker: state private to one discovery thread
+typedef struct
+{
+   pthread_t thread;
+   ExtendWorkQueue *queue;
+   Parameters parameters; // copy of parameters with private copies of the
+                          //   positive and negative graphs, whose used
+                          //   flags are set during extension and evaluation
+} ExtendWorker;
+
 
 //---------------------------------------------------------------------------
 // Function Prototypes
@@ -410,16 +833,17 @@ typedef struct
 // compress.c
 
 Graph *CompressGraph(Graph *, InstanceList *, Parameters *);
-void AddOverlapEdges(Graph *, Graph *, InstanceList *, ULONG, ULONG, ULONG);
+void AddOverlapEdges(Graph *, Graph *, GraphMarks *, InstanceList *, ULONG,
+                     ULONG, ULONG);
 Edge *AddOverlapEdge(Edge *, ULONG *, ULONG, ULONG, ULONG);
-Edge *AddDuplicateEdges(Edge *, ULONG *, Edge *, Graph *, ULONG, ULONG);
+Edge *AddDuplicateEdges(Edge *, ULONG *, Edge *, GraphMarks *, ULONG, ULONG);
 void CompressFinalGraphs(Substructure *, Parameters *, ULONG, BOOLEAN);
 void CompressLabelListWithGraph(LabelList *, Graph *, Parameters *);
 ULONG SizeOfCompressedGraph(Graph *, InstanceList *, Parameters *, ULONG);
-ULONG NumOverlapEdges(Graph *, InstanceList *);
+ULONG NumOverlapEdges(Graph *, GraphMarks *, InstanceList *);
 void RemovePosEgsCovered(Substructure *, Parameters *);
-void MarkExample(ULONG, ULONG, Graph *, BOOLEAN);
-void CopyUnmarkedGraph(Graph *, Graph *, ULONG, Parameters *);
+void MarkExample(ULONG, ULONG, Graph *, GraphMarks *, BOOLEAN);
+void CopyUnmarkedGraph(Graph *, GraphMarks *, Graph *, ULONG, Parameters *);
 void CompressWithPredefinedSubs(Parameters *);
 void WriteCompressedGraphToFile(Substructure *sub, Parameters *parameters,
                                 ULONG iteration);
@@ -430,6 +854,13 @@ void MarkPosEgsCovered(Substructure *, Parameters *);
 // discover.c
 
 SubList *DiscoverSubs(Parameters *);
+BOOLEAN ShouldExtendSub(Substructure *, ULONG);
+void AddExtendWorkItem(ExtendWorkQueue *, Substructure *);
+SubList *ExtendAndEvaluateSub(Substructure *, Parameters *);
+ExtendWorker *AllocateExtendWorkers(Parameters *);
+void FreeExtendWorkers(ExtendWorker *, Parameters *);
+void ExtendSubsInParallel(ExtendWorkQueue *, ExtendWorker *, ULONG);
+void *ExtendWorkerThread(void *);
 SubList *GetInitialSubs(Parameters *);
 BOOLEAN SinglePreviousSub(Substructure *, Parameters *);
 
@@ -448,55 +879,163 @@ void WriteEdgeToDotFile(FILE *, ULONG, ULONG, Graph *, LabelList *, char *);
 void EvaluateSub(Substructure *, Parameters *);
 ULONG GraphSize(Graph *);
 double MDL(Graph *, ULONG, Parameters *);
-ULONG NumUniqueEdges(Graph *, ULONG);
-ULONG MaxEdgesToSingleVertex(Graph *, ULONG);
+BOOLEAN CompressedGraphDL(Graph *, InstanceList *, Graph *, ULONG, ULONG,
+                          Parameters *, double *);
+void CountRow(ULONG **, ULONG *, ULONG);
+double RowCountsBits(ULONG, ULONG *, ULONG, Parameters *, ULONG *);
+void CompressedRowStats(Graph *, GraphMarks *, ULONG, INDEX *, ULONG, ULONG,
+                        RowEdge **, ULONG *, ULONG *, ULONG *);
+int CompareRowEdges(const void *, const void *);
+ULONG CompressedVertexOrder(GraphMarks *, ULONG, ULONG);
+void ComputeGraphRowStats(Graph *);
+void FreeGraphRowStats(Graph *);
 double ExternalEdgeBits(Graph *, Graph *, ULONG);
 double Log2Factorial(ULONG, Parameters *);
 double Log2(ULONG);
 ULONG PosExamplesCovered(Substructure *, Parameters *);
 ULONG NegExamplesCovered(Substructure *, Parameters *);
 ULONG ExamplesCovered(InstanceList *, Graph *, ULONG, ULONG *, ULONG);
+ULONG ExampleContainingVertex(ULONG, ULONG, ULONG *);
 
 // extend.c
 
 SubList *ExtendSub(Substructure *, Parameters *);
-InstanceList *ExtendInstances(InstanceList *, Graph *);
+InstanceList *ExtendInstances(InstanceList *, Graph *, Parameters *);
 Instance *CreateExtendedInstance(Instance *, ULONG, ULONG, Graph *);
 Substructure *CreateSubFromInstance(Instance *, Graph *);
 void AddPosInstancesToSub(Substructure *, Instance *, InstanceList *, 
                           Parameters *, ULONG);
 void AddNegInstancesToSub(Substructure *, Instance *, InstanceList *, 
                           Parameters *);
+ULONG ExtensionSignature(Instance *, Graph *);
+InstanceBuckets *BucketInstances(InstanceList *, Graph *);
+void AddToInstanceBucket(InstanceBucket **, ULONG, ULONG, ULONG);
+InstanceBucket *GetInstanceBucket(InstanceBucket **, ULONG, ULONG);
+InstanceList *CandidateInstances(InstanceBuckets *, ULONG, ULONG, ULONG);
+void FreeInstanceBuckets(InstanceBuckets *);
 Substructure *RecursifySub(Substructure *, Parameters *);
 Substructure *MakeRecursiveSub(Substructure *, ULONG, Parameters *);
-InstanceList *GetRecursiveInstances(Graph *, InstanceList *, ULONG, ULONG);
+InstanceList *GetRecursiveInstances(Graph *, GraphMarks *, InstanceList *,
+                                    ULONG, ULONG);
 void AddRecursiveInstancePair(ULONG, ULONG, Instance *, Instance *,
                               ULONG, Edge *, ULONG, Instance **);
 InstanceList *CollectRecursiveInstances(Instance **, ULONG);
 
 // graphmatch.c
 
-BOOLEAN GraphMatch(Graph *, Graph *, LabelList *, double, double *,
+BOOLEAN GraphMatch(Graph *, Graph *, LabelList *, double, ULONG, double *,
                    VertexMap *);
-double InexactGraphMatch(Graph *, Graph *, LabelList *, double, VertexMap *);
-void OrderVerticesByDegree(Graph *, ULONG *);
+ULONG GraphCode(Graph *);
+ULONG MixCode(ULONG);
+BOOLEAN ExactGraphMatch(Graph *, Graph *, VertexMap *, MatchWorkspace *);
+void ExactMatchOrder(Graph *, ULONG *, ULONG *, ULONG *);
+BOOLEAN ExactMatchFeasible(Graph *, Graph *, ULONG, ULONG, ULONG *, ULONG *,
+                           BOOLEAN *);
+GraphInvariants *GetGraphInvariants(Graph *);
+int CompareULONG(const void *, const void *);
+BOOLEAN InvariantsDiffer(Graph *, Graph *);
+double MatchCostLowerBound(Graph *, Graph *);
+ULONG NumCommonValues(ULONG *, ULONG, ULONG *, ULONG);
+ULONG CachedGraphCode(Graph *);
+void FreeGraphInvariants(Graph *);
+double InexactGraphMatch(Graph *, Graph *, LabelList *, double, VertexMap *,
+                         MatchWorkspace *);
+void OrderVerticesByDegree(Graph *, ULONG *, ULONG *);
+void PrepareMatchBounds(Graph *, Graph *, MatchWorkspace *);
+void RemainingMatchCounts(Graph *, Graph *, ULONG, ULONG *, ULONG *,
+                          MatchWorkspace *, ULONG *, ULONG *, ULONG *,
+                          ULONG *);
+ULONG NumEdgesToLater(Graph *, ULONG, ULONG, ULONG *);
+ULONG NumEdgesToMapped(Graph *, ULONG, ULONG *);
+double RemainingCostLowerBound(ULONG, ULONG, ULONG, ULONG, ULONG);
+double BipartiteGraphMatch(Graph *, Graph *, LabelList *, VertexMap *,
+                           MatchWorkspace *);
+void StoreEdgeKeys(Graph *, ULONG *, ULONG *);
+double LocalEdgesCost(ULONG *, ULONG, ULONG *, ULONG);
+void SolveAssignment(ULONG, MatchWorkspace *);
+double MappingCost(Graph *, Graph *, LabelList *, ULONG *, ULONG *, ULONG *,
+                   BOOLEAN *);
 ULONG MaximumNodes(ULONG);
-double DeletedEdgesCost(Graph *, Graph *, ULONG, ULONG, ULONG *, LabelList *);
-double InsertedEdgesCost(Graph *, ULONG, ULONG *);
+double DeletedEdgesCost(Graph *, Graph *, ULONG, ULONG, ULONG *, LabelList *,
+                        VertexMask *, BOOLEAN *);
+double InsertedEdgesCost(Graph *, ULONG, ULONG *, BOOLEAN *);
 double InsertedVerticesCost(Graph *, ULONG *);
+MatchWorkspace *GetMatchWorkspace(void);
+void PrepareMatchWorkspace(MatchWorkspace *, ULONG);
+void PrepareEdgeMarks(MatchWorkspace *, ULONG);
+void PrepareAssignmentWorkspace(MatchWorkspace *, ULONG, ULONG);
+ULONG NewMatchMapNode(MatchWorkspace *, ULONG, ULONG, ULONG);
+void ReleaseMatchWorkspace(void);
+ULONG EncodeMatchGraphs(MatchWorkspace *, Graph *, Graph *);
+BOOLEAN FindMatchCacheEntry(MatchWorkspace *, MatchCacheEntry *,
+                            MatchCacheEntry **);
+void StoreMatchCacheEntry(MatchWorkspace *, MatchCacheEntry *,
+                          MatchCacheEntry *, double);
+void MatchCacheCounts(ULONG *, ULONG *);
 MatchHeap *AllocateMatchHeap(ULONG);
-VertexMap *AllocateNewMapping(ULONG, VertexMap *, ULONG, ULONG);
 void InsertMatchHeapNode(MatchHeapNode *, MatchHeap *);
 void ExtractMatchHeapNode(MatchHeap *, MatchHeapNode *);
 void HeapifyMatchHeap(MatchHeap *);
 BOOLEAN MatchHeapEmpty(MatchHeap *);
 void MergeMatchHeaps(MatchHeap *, MatchHeap *);
-void CompressMatchHeap(MatchHeap *, ULONG);
-void PrintMatchHeapNode(MatchHeapNode *);
-void PrintMatchHeap(MatchHeap *);
+void CompressMatchHeap(MatchHeap *, ULONG, MatchHeap *);
+void PrintMatchHeapNode(MatchHeapNode *, MatchWorkspace *);
+void PrintMatchHeap(MatchHeap *, MatchWorkspace *);
 void ClearMatchHeap(MatchHeap *);
 void FreeMatchHeap(MatchHeap *);
 
+// graphfile.c
+
+GraphFile *OpenGraphFile(char *);
+void ReadGraphFileData(GraphFile *);
+BOOLEAN RefillGraphFile(GraphFile *);
+void CloseGraphFile(GraphFile *);
+void ReleaseGraphFileMemory(GraphFileMemory *);
+int OpenInputFile(char *, Decompressor **);
+FILE *OpenInputStream(char *, Decompressor **);
+void CloseInputStream(FILE *, Decompressor *);
+int StartDecompressor(int, char *, void *(*)(void *), Decompressor **);
+void FinishDecompressor(Decompressor *);
+void *GzipDecompressorThread(void *);
+void *ZstdDecompressorThread(void *);
+BOOLEAN WriteDecompressedData(int, char *, ULONG);
+void DecompressionError(Decompressor *, char *);
+void SkipToNewline(GraphFile *);
+ULONG ScanToken(GraphFile *);
+BOOLEAN ScanBufferedToken(GraphFile *);
+BOOLEAN TokenEquals(GraphFile *, char *);
+char *TokenString(GraphFile *);
+BOOLEAN TokenDigits(GraphFile *, ULONG, ULONG *);
+ULONG ScanInteger(GraphFile *);
+ULONG ScanLabel(GraphFile *, LabelList *);
+void ScanVertex(GraphFile *, Graph *, LabelList *, ULONG);
+void ScanEdge(GraphFile *, Graph *, LabelList *, BOOLEAN, ULONG);
+void GraphFileError(GraphFile *, char *);
+BOOLEAN ReadGraphFileInParallel(GraphFile *, Parameters *);
+size_t FindExampleBoundary(GraphFile *, size_t);
+void InitGraphFileChunk(GraphFileChunk *, GraphFile *, size_t, size_t,
+                        BOOLEAN);
+void *ReadGraphFileChunk(void *);
+ULONG AddExample(ExampleGraph *);
+void MergeExampleGraphs(GraphFileChunk *, ULONG, ULONG, Graph **, ULONG *,
+                        ULONG **);
+void FreeGraphFileChunk(GraphFileChunk *);
+BOOLEAN IsBinaryGraphFile(GraphFile *);
+void ReadBinaryInputFile(GraphFile *, Parameters *);
+Graph *ReadBinaryGraph(GraphFile *, char *, LabelList *, BOOLEAN);
+void ReadBinaryGraphFile(GraphFile *, char *, LabelList *, BOOLEAN,
+                         Graph **, ULONG *, ULONG **);
+void CheckBinaryGraphSection(BinaryGraphSection *, ULONG *, INDEX *, ULONG *,
+                             INDEX *, Edge *, ULONG, char *);
+void *BinaryGraphSectionData(GraphFile *, ULONG, ULONG, char *);
+void BinaryGraphCorrupt(char *);
+ULONG BinaryGraphAlign(ULONG);
+void WriteBinaryGraphFile(char *, Parameters *);
+ULONG BinaryGraphLabelsSize(LabelList *);
+void WriteBinaryGraphSection(FILE *, Graph *, ULONG, ULONG *,
+                             BinaryGraphSection *, ULONG *);
+void WriteBinaryGraphData(FILE *, void *, ULONG);
+
 // graphops.c
 
 void ReadInputFile(Parameters *);
@@ -508,6 +1047,10 @@ void ReadVertex(Graph *, FILE *, LabelList *, ULONG *, ULONG);
 void AddVertex(Graph *, ULONG);
 void ReadEdge(Graph *, FILE *, LabelList *, ULONG *, BOOLEAN, ULONG);
 void AddEdge(Graph *, ULONG, ULONG, BOOLEAN, ULONG, BOOLEAN);
+void AppendEdge(Graph *, ULONG, ULONG, BOOLEAN, ULONG, BOOLEAN);
+void BuildVertexEdges(Graph *);
+void SeparateVertexEdges(Graph *);
+void CopyMappedGraphArrays(Graph *);
 void StoreEdge(Edge *, ULONG, ULONG, ULONG, ULONG, BOOLEAN, BOOLEAN);
 void AddEdgeToVertices(Graph *, ULONG);
 int ReadToken(char *, FILE *, ULONG *);
@@ -516,6 +1059,12 @@ ULONG ReadInteger(FILE *, ULONG *);
 Graph *AllocateGraph(ULONG, ULONG);
 Graph *CopyGraph(Graph *);
 void FreeGraph(Graph *);
+GraphMarks *AllocateGraphMarks(void);
+GraphMarks *GetGraphMarks(Graph *, Parameters *);
+void ResetGraphMarks(GraphMarks *, Graph *);
+void FreeGraphMarks(GraphMarks *);
+void AllocateParameterMarks(Parameters *);
+void FreeParameterMarks(Parameters *);
 void PrintGraph(Graph *, LabelList *);
 void PrintVertex(Graph *, ULONG, ULONG, LabelList *);
 void PrintEdge(Graph *, ULONG, ULONG, LabelList *);
@@ -526,7 +1075,12 @@ void WriteGraphToFile(FILE *, Graph *, LabelList *, ULONG, ULONG, ULONG, BOOLEAN
 LabelList *AllocateLabelList(void);
 ULONG StoreLabel(Label *, LabelList *);
 ULONG GetLabelIndex(Label *, LabelList *);
+ULONG LabelHash(Label *);
+BOOLEAN LabelsEqual(Label *, Label *);
+void InsertLabelHashTable(ULONG, LabelList *);
+void ResizeLabelHashTable(LabelList *);
 ULONG SubLabelNumber(ULONG, LabelList *);
+ULONG ParseSubLabelNumber(char *);
 double LabelMatchFactor(ULONG, ULONG, LabelList *);
 void PrintLabel(ULONG, LabelList *);
 void PrintLabelList(LabelList *);
@@ -551,6 +1105,14 @@ Substructure *UnpackSubstructure(char *, int *, Parameters *);
 Graph *UnpackGraph(char *, int *, Parameters *);
 ULONG UnpackLabel(char *, int *, LabelList *);
 
+// pool.c
+
+void *PoolAllocate(ULONG);
+void PoolFree(ULONG, void *);
+void RefillPoolCache(ULONG);
+void FlushPoolCache(ULONG, ULONG);
+void ReleasePoolCaches(void);
+
 // sgiso.c
 
 InstanceList *FindInstances(Graph *, Graph *, Parameters *);
@@ -571,6 +1133,13 @@ void FreeSubListNode(SubListNode *);
 SubList *AllocateSubList(void);
 void SubListInsert(Substructure *, SubList *, ULONG, BOOLEAN, LabelList *);
 BOOLEAN MemberOfSubList(Substructure *, SubList *, LabelList *);
+ULONG SubDefinitionCode(Substructure *);
+BOOLEAN SubDefinitionsMatch(Substructure *, Substructure *, LabelList *);
+void IndexSubList(SubList *);
+void UnindexSubList(SubList *);
+void AddSubToIndex(SubListNode *, SubList *);
+void RemoveSubFromIndex(SubListNode *, SubList *);
+SubListNode *FindIndexedSub(Substructure *, SubList *, BOOLEAN, LabelList *);
 void FreeSubList(SubList *);
 void PrintSubList(SubList *, Parameters *);
 void PrintNewBestSub(Substructure *, SubList *, Parameters *);
@@ -578,8 +1147,8 @@ ULONG CountSubs(SubList *);
 Instance *AllocateInstance(ULONG, ULONG);
 void FreeInstance(Instance *);
 void PrintInstance(Instance *, ULONG, Graph *, LabelList *);
-void MarkInstanceVertices(Instance *, Graph *, BOOLEAN);
-void MarkInstanceEdges(Instance *, Graph *, BOOLEAN);
+void MarkInstanceVertices(Instance *, GraphMarks *, BOOLEAN);
+void MarkInstanceEdges(Instance *, GraphMarks *, BOOLEAN);
 InstanceListNode *AllocateInstanceListNode(Instance *);
 void FreeInstanceListNode(InstanceListNode *);
 InstanceList *AllocateInstanceList(void);
@@ -591,10 +1160,15 @@ ULONG InstanceExampleNumber(Instance *, ULONG *, ULONG);
 ULONG CountInstances(InstanceList *);
 void InstanceListInsert(Instance *, InstanceList *, BOOLEAN);
 BOOLEAN MemberOfInstanceList(Instance *, InstanceList *);
+InstanceSet *AllocateInstanceSet(ULONG);
+void FreeInstanceSet(InstanceSet *);
+ULONG InstanceHash(Instance *);
+BOOLEAN InstanceSetInsert(Instance *, InstanceSet *);
 BOOLEAN InstanceMatch(Instance *, Instance *);
 BOOLEAN InstanceOverlap(Instance *, Instance *);
 BOOLEAN InstanceListOverlap(Instance *, InstanceList *);
-BOOLEAN InstancesOverlap(InstanceList *);
+BOOLEAN MarkedInstanceOverlap(Instance *, GraphMarks *);
+BOOLEAN InstancesOverlap(InstanceList *, Graph *, GraphMarks *);
 Graph *InstanceToGraph(Instance *, Graph *);
 BOOLEAN InstanceContainsVertex(Instance *, ULONG);
 void AddInstanceToInstance(Instance *, Instance *);
@@ -611,6 +1185,7 @@ BOOLEAN PositiveExample(Graph *, Graph **, ULONG, Parameters *);
 // utility.c
 
 void OutOfMemoryError(char *);
+void CheckIndex(ULONG, char *);
 void PrintBoolean(BOOLEAN);
 
 // inccomp.c
@@ -719,8 +1294,8 @@ void AddRefEdgeToRefVertices(ReferenceGraph *graph, ULONG edgeIndex);
 ReferenceGraph *InstanceToRefGraph(Instance *instance, Graph *graph, 
                                    Parameters *parameters);
 Instance *CreateGraphRefInstance(Instance *instance1, ReferenceGraph *refGraph);
-void SortIndices(ULONG *A, long p, long r);
-long Partition(ULONG *A, long p, long r);
+void SortIndices(INDEX *A, long p, long r);
+long Partition(INDEX *A, long p, long r);
 RefInstanceListNode *AllocateRefInstanceListNode();
 RefInstanceList *AllocateRefInstanceList();
 void FreeRefInstanceListNode(RefInstanceListNode *refInstanceListNode);
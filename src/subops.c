@@ -23,11 +23,10 @@ SubListNode *AllocateSubListNode(Substructure *sub)
 {
    SubListNode *subListNode;
 
-   subListNode = (SubListNode *) malloc(sizeof(SubListNode));
-   if (subListNode == NULL)
-      OutOfMemoryError("SubListNode");
+   subListNode = (SubListNode *) PoolAllocate(POOL_SUB_LIST_NODE);
    subListNode->sub = sub;
    subListNode->next = NULL;
+   subListNode->nextInIndex = NULL;
    return subListNode;
 }
 
@@ -48,7 +47,7 @@ void FreeSubListNode(SubListNode *subListNode)
    if (subListNode != NULL) 
    {
       FreeSub(subListNode->sub);
-      free(subListNode);
+      PoolFree(POOL_SUB_LIST_NODE, subListNode);
    }
 }
 
@@ -71,6 +70,7 @@ SubList *AllocateSubList(void)
    if (subList == NULL)
       OutOfMemoryError("AllocateSubList:subList");
    subList->head = NULL;
+   subList->index = NULL;
    return subList;
 }
 
@@ -96,7 +96,8 @@ SubList *AllocateSubList(void)
 // substructures on the list; otherwise, max represents the maximum
 // number of substructures on the list.  If sub is not inserted, then
 // it is destroyed.  SubListInsert assumes given subList already
-// conforms to maximums.
+// conforms to maximums.  If the list is indexed, the index is used to
+// look for sub on the list, and is kept up to date.
 //---------------------------------------------------------------------------
 
 void SubListInsert(Substructure *sub, SubList *subList, ULONG max,
@@ -115,23 +116,35 @@ void SubListInsert(Substructure *sub, SubList *subList, ULONG max,
    if (subList->head == NULL) 
    {
       subList->head = newSubListNode;
+      if (subList->index != NULL)
+         AddSubToIndex(newSubListNode, subList);
       return;
    }
 
    // if sub already on subList, destroy and exit
-   subIndex = subList->head;
-   while ((subIndex != NULL) && (subIndex->sub->value >= sub->value))
+   if (subList->index != NULL)
    {
-      if (subIndex->sub->value == sub->value)
+      if (FindIndexedSub(sub, subList, TRUE, labelList) != NULL)
       {
-         if (GraphMatch(subIndex->sub->definition, sub->definition,
-             labelList, 0.0, NULL, NULL))
+         FreeSubListNode(newSubListNode);
+         return;
+      }
+   }
+   else
+   {
+      subIndex = subList->head;
+      while ((subIndex != NULL) && (subIndex->sub->value >= sub->value))
+      {
+         if (subIndex->sub->value == sub->value)
          {
-            FreeSubListNode(newSubListNode);
-            return;
+            if (SubDefinitionsMatch(subIndex->sub, sub, labelList))
+            {
+               FreeSubListNode(newSubListNode);
+               return;
+            }
          }
+         subIndex = subIndex->next;
       }
-      subIndex = subIndex->next;
    }
 
    // sub is unique, so insert in appropriate place and check maximums
@@ -158,6 +171,8 @@ void SubListInsert(Substructure *sub, SubList *subList, ULONG max,
             subIndex->next = newSubListNode;
             inserted = TRUE;
          }
+         if ((inserted) && (subList->index != NULL))
+            AddSubToIndex(newSubListNode, subList);
       }
     
       // update counters on number of substructures and different values
@@ -179,6 +194,8 @@ void SubListInsert(Substructure *sub, SubList *subList, ULONG max,
          {
             subIndexPrevious = subIndex;
             subIndex = subIndex->next;
+            if (subList->index != NULL)
+               RemoveSubFromIndex(subIndexPrevious, subList);
             FreeSubListNode(subIndexPrevious);
          }
       } 
@@ -204,7 +221,8 @@ void SubListInsert(Substructure *sub, SubList *subList, ULONG max,
 // RETURN: (BOOLEAN)
 //
 // PURPOSE: Check if the given substructure's definition graph exactly
-// matches a definition of a substructure on the subList.
+// matches a definition of a substructure on the subList.  An indexed
+// list is searched through its index.
 //---------------------------------------------------------------------------
 
 BOOLEAN MemberOfSubList(Substructure *sub, SubList *subList,
@@ -213,13 +231,14 @@ BOOLEAN MemberOfSubList(Substructure *sub, SubList *subList,
    SubListNode *subListNode;
    BOOLEAN found = FALSE;
 
-   if (subList != NULL) 
+   if ((subList != NULL) && (subList->index != NULL))
+      found = (FindIndexedSub(sub, subList, FALSE, labelList) != NULL);
+   else if (subList != NULL) 
    {
       subListNode = subList->head;
       while ((subListNode != NULL) && (! found)) 
       {
-         if (GraphMatch(sub->definition, subListNode->sub->definition,
-                        labelList, 0.0, NULL, NULL))
+         if (SubDefinitionsMatch(sub, subListNode->sub, labelList))
             found = TRUE;
          subListNode = subListNode->next;
       }
@@ -228,6 +247,231 @@ BOOLEAN MemberOfSubList(Substructure *sub, SubList *subList,
 }
 
 
+//---------------------------------------------------------------------------
+// NAME: SubDefinitionCode
+//
+// INPUTS: (Substructure *sub)
+//
+// RETURN: (ULONG) - code of sub's definition
+//
+// PURPOSE: Return the GraphCode of the substructure's definition.  The
+// code is computed the first time it is needed and kept with the
+// substructure.
+//---------------------------------------------------------------------------
+
+ULONG SubDefinitionCode(Substructure *sub)
+{
+   if (sub->definitionCode == 0)
+      sub->definitionCode = GraphCode(sub->definition);
+   return sub->definitionCode;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: SubDefinitionsMatch
+//
+// INPUTS: (Substructure *sub1)
+//         (Substructure *sub2)
+//         (LabelList *labelList)
+//
+// RETURN: (BOOLEAN) - TRUE if the substructures' definitions match exactly
+//
+// PURPOSE: Check if the definitions of the two substructures match
+// exactly.  Definitions with different codes cannot match, so the graph
+// match is only needed when the codes are equal.
+//---------------------------------------------------------------------------
+
+BOOLEAN SubDefinitionsMatch(Substructure *sub1, Substructure *sub2,
+                            LabelList *labelList)
+{
+   if (SubDefinitionCode(sub1) != SubDefinitionCode(sub2))
+      return FALSE;
+   return GraphMatch(sub1->definition, sub2->definition, labelList, 0.0,
+                     MATCH_SEARCH, NULL, NULL);
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: IndexSubList
+//
+// INPUTS: (SubList *subList) - list to be indexed
+//
+// RETURN: (void)
+//
+// PURPOSE: Give the list an index of its nodes by definition code.
+// Nodes added to or removed from an indexed list must be added to or
+// removed from its index; SubListInsert does so itself.
+//---------------------------------------------------------------------------
+
+void IndexSubList(SubList *subList)
+{
+   SubIndex *index;
+   SubListNode *subListNode;
+   ULONG i;
+
+   index = (SubIndex *) malloc(sizeof(SubIndex));
+   if (index == NULL)
+      OutOfMemoryError("IndexSubList:index");
+   index->size = LIST_SIZE_INC;
+   index->numSubs = 0;
+   index->table = (SubListNode **) malloc(sizeof(SubListNode *) * index->size);
+   if (index->table == NULL)
+      OutOfMemoryError("IndexSubList:table");
+   for (i = 0; i < index->size; i++)
+      index->table[i] = NULL;
+   subList->index = index;
+   subListNode = subList->head;
+   while (subListNode != NULL)
+   {
+      AddSubToIndex(subListNode, subList);
+      subListNode = subListNode->next;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: UnindexSubList
+//
+// INPUTS: (SubList *subList)
+//
+// RETURN: (void)
+//
+// PURPOSE: Free the list's index, if any, leaving the list itself as
+// it is.
+//---------------------------------------------------------------------------
+
+void UnindexSubList(SubList *subList)
+{
+   if (subList->index != NULL)
+   {
+      free(subList->index->table);
+      free(subList->index);
+      subList->index = NULL;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: AddSubToIndex
+//
+// INPUTS: (SubListNode *subListNode) - node on the list
+//         (SubList *subList) - indexed list
+//
+// RETURN: (void)
+//
+// PURPOSE: Add the node to the list's index, growing the index if its
+// average chain is too long.
+//---------------------------------------------------------------------------
+
+void AddSubToIndex(SubListNode *subListNode, SubList *subList)
+{
+   SubIndex *index = subList->index;
+   SubListNode **newTable;
+   SubListNode *chainNode;
+   SubListNode *nextNode;
+   ULONG newSize;
+   ULONG i, h;
+
+   if (index->numSubs >= (2 * index->size))
+   {
+      newSize = 2 * index->size + 1;
+      newTable = (SubListNode **) malloc(sizeof(SubListNode *) * newSize);
+      if (newTable == NULL)
+         OutOfMemoryError("AddSubToIndex:newTable");
+      for (i = 0; i < newSize; i++)
+         newTable[i] = NULL;
+      for (i = 0; i < index->size; i++)
+      {
+         chainNode = index->table[i];
+         while (chainNode != NULL)
+         {
+            nextNode = chainNode->nextInIndex;
+            h = SubDefinitionCode(chainNode->sub) % newSize;
+            chainNode->nextInIndex = newTable[h];
+            newTable[h] = chainNode;
+            chainNode = nextNode;
+         }
+      }
+      free(index->table);
+      index->table = newTable;
+      index->size = newSize;
+   }
+
+   h = SubDefinitionCode(subListNode->sub) % index->size;
+   subListNode->nextInIndex = index->table[h];
+   index->table[h] = subListNode;
+   index->numSubs++;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: RemoveSubFromIndex
+//
+// INPUTS: (SubListNode *subListNode) - node in the list's index
+//         (SubList *subList) - indexed list
+//
+// RETURN: (void)
+//
+// PURPOSE: Remove the node from the list's index.
+//---------------------------------------------------------------------------
+
+void RemoveSubFromIndex(SubListNode *subListNode, SubList *subList)
+{
+   SubIndex *index = subList->index;
+   SubListNode **chainLink;
+
+   chainLink =
+      & index->table[SubDefinitionCode(subListNode->sub) % index->size];
+   while (*chainLink != NULL)
+   {
+      if (*chainLink == subListNode)
+      {
+         *chainLink = subListNode->nextInIndex;
+         subListNode->nextInIndex = NULL;
+         index->numSubs--;
+         return;
+      }
+      chainLink = & (*chainLink)->nextInIndex;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FindIndexedSub
+//
+// INPUTS: (Substructure *sub) - substructure to look for
+//         (SubList *subList) - indexed list
+//         (BOOLEAN sameValue) - TRUE if the sub found must also have the
+//                               same value as sub
+//         (LabelList *labelList)
+//
+// RETURN: (SubListNode *) - node of a sub on the list whose definition
+//                           matches sub's, or NULL if none
+//
+// PURPOSE: Look for sub on the list through the list's index, so only
+// subs whose definitions have the same code are matched against sub's.
+//---------------------------------------------------------------------------
+
+SubListNode *FindIndexedSub(Substructure *sub, SubList *subList,
+                            BOOLEAN sameValue, LabelList *labelList)
+{
+   SubListNode *chainNode;
+   ULONG code;
+
+   code = SubDefinitionCode(sub);
+   chainNode = subList->index->table[code % subList->index->size];
+   while (chainNode != NULL)
+   {
+      if ((SubDefinitionCode(chainNode->sub) == code) &&
+          ((! sameValue) || (chainNode->sub->value == sub->value)) &&
+          (SubDefinitionsMatch(chainNode->sub, sub, labelList)))
+         return chainNode;
+      chainNode = chainNode->nextInIndex;
+   }
+   return NULL;
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: FreeSubList
 //
@@ -245,13 +489,14 @@ void FreeSubList(SubList *subList)
 
    if (subList != NULL) 
    {
+      UnindexSubList(subList);
       subListNode1 = subList->head;
       while (subListNode1 != NULL) 
       {
          subListNode2 = subListNode1;
          subListNode1 = subListNode1->next;
          FreeSub(subListNode2->sub);
-         free(subListNode2);
+         PoolFree(POOL_SUB_LIST_NODE, subListNode2);
       }
       free(subList);
    }
@@ -317,6 +562,7 @@ Substructure *AllocateSub()
    sub->value = -1.0;
    sub->recursive = FALSE;
    sub->recursiveEdgeLabel = 0;
+   sub->definitionCode = 0;
 
    return sub;
 }
@@ -489,9 +735,7 @@ Instance *AllocateInstance(ULONG v, ULONG e)
 {
    Instance *instance;
 
-   instance = (Instance *) malloc(sizeof(Instance));
-   if (instance == NULL)
-      OutOfMemoryError("AllocateInstance:instance");
+   instance = (Instance *) PoolAllocate(POOL_INSTANCE);
    instance->numVertices = v;
    instance->numEdges = e;
    instance->vertices = NULL;
@@ -504,7 +748,7 @@ Instance *AllocateInstance(ULONG v, ULONG e)
    instance->used = FALSE;
    if (v > 0) 
    {
-      instance->vertices = (ULONG *) malloc(sizeof(ULONG) * v);
+      instance->vertices = (INDEX *) malloc(sizeof(INDEX) * v);
       if (instance->vertices == NULL)
          OutOfMemoryError("AllocateInstance: instance->vertices");
       instance->mapping = (VertexMap *) malloc(sizeof(VertexMap) * v);
@@ -513,7 +757,7 @@ Instance *AllocateInstance(ULONG v, ULONG e)
    }
    if (e > 0) 
    {
-      instance->edges = (ULONG *) malloc(sizeof(ULONG) * e);
+      instance->edges = (INDEX *) malloc(sizeof(INDEX) * e);
       if (instance->edges == NULL)
          OutOfMemoryError("AllocateInstance: instance->edges");
    }
@@ -543,7 +787,7 @@ void FreeInstance(Instance *instance)
       free(instance->vertices);
       free(instance->mapping);
       free(instance->edges);
-      free(instance);
+      PoolFree(POOL_INSTANCE, instance);
    }
 }
 
@@ -562,9 +806,8 @@ InstanceListNode *AllocateInstanceListNode(Instance *instance)
 {
    InstanceListNode *instanceListNode;
 
-   instanceListNode = (InstanceListNode *) malloc(sizeof(InstanceListNode));
-   if (instanceListNode == NULL)
-      OutOfMemoryError("AllocateInstanceListNode:InstanceListNode");
+   instanceListNode =
+      (InstanceListNode *) PoolAllocate(POOL_INSTANCE_LIST_NODE);
    instanceListNode->instance = instance;
    instance->refCount++;
    instanceListNode->next = NULL;
@@ -589,7 +832,7 @@ void FreeInstanceListNode(InstanceListNode *instanceListNode)
       if (instanceListNode->instance != NULL)
          instanceListNode->instance->refCount--;
       FreeInstance(instanceListNode->instance);
-      free(instanceListNode);
+      PoolFree(POOL_INSTANCE_LIST_NODE, instanceListNode);
    }
 }
 
@@ -649,21 +892,21 @@ void FreeInstanceList(InstanceList *instanceList)
 // NAME: MarkInstanceVertices
 //
 // INPUTS: (Instance *instance) - instance whose vertices to set
-//         (Graph *graph) - graph containing instance
-//         (BOOLEAN value) - value to set edge's used flag
+//         (GraphMarks *marks) - marks on graph containing instance
+//         (BOOLEAN value) - TRUE to mark vertices, FALSE to unmark
 //
 // RETURN: (void)
 //
-// PURPOSE: Set the used flag to the given value for each vertex in
-// instance.
+// PURPOSE: Mark or unmark each vertex in instance.
 //---------------------------------------------------------------------------
 
-void MarkInstanceVertices(Instance *instance, Graph *graph, BOOLEAN value)
+void MarkInstanceVertices(Instance *instance, GraphMarks *marks,
+                          BOOLEAN value)
 {
    ULONG v;
 
    for (v = 0; v < instance->numVertices; v++)
-      graph->vertices[instance->vertices[v]].used = value;
+      MARK_VERTEX(marks, instance->vertices[v], value);
 }
 
 
@@ -671,21 +914,20 @@ void MarkInstanceVertices(Instance *instance, Graph *graph, BOOLEAN value)
 // NAME: MarkInstanceEdges
 //
 // INPUTS: (Instance *instance) - instance whose edges to set
-//         (Graph *graph) - graph containing instance
-//         (BOOLEAN value) - value to set edge's used flag
+//         (GraphMarks *marks) - marks on graph containing instance
+//         (BOOLEAN value) - TRUE to mark edges, FALSE to unmark
 //
 // RETURN: (void)
 //
-// PURPOSE: Set the used flag to the given value for each edge in
-// instance.
+// PURPOSE: Mark or unmark each edge in instance.
 //---------------------------------------------------------------------------
 
-void MarkInstanceEdges(Instance *instance, Graph *graph, BOOLEAN value)
+void MarkInstanceEdges(Instance *instance, GraphMarks *marks, BOOLEAN value)
 {
    ULONG e;
 
    for (e = 0; e < instance->numEdges; e++)
-      graph->edges[instance->edges[e]].used = value;
+      MARK_EDGE(marks, instance->edges[e], value);
 }
 
 
@@ -968,6 +1210,165 @@ BOOLEAN MemberOfInstanceList(Instance *instance, InstanceList *instanceList)
    return found;
 }
 
+//---------------------------------------------------------------------------
+// NAME: AllocateInstanceSet
+//
+// INPUTS: (ULONG size) - initial number of hash chains
+//
+// RETURN: (InstanceSet *) - newly-allocated empty instance set
+//
+// PURPOSE: Allocate and return an empty instance set.
+//---------------------------------------------------------------------------
+
+InstanceSet *AllocateInstanceSet(ULONG size)
+{
+   InstanceSet *instanceSet;
+   ULONG i;
+
+   if (size == 0)
+      size = 1;
+   instanceSet = (InstanceSet *) malloc(sizeof(InstanceSet));
+   if (instanceSet == NULL)
+      OutOfMemoryError("AllocateInstanceSet:instanceSet");
+   instanceSet->table =
+      (InstanceListNode **) malloc(sizeof(InstanceListNode *) * size);
+   if (instanceSet->table == NULL)
+      OutOfMemoryError("AllocateInstanceSet:table");
+   for (i = 0; i < size; i++)
+      instanceSet->table[i] = NULL;
+   instanceSet->size = size;
+   instanceSet->numInstances = 0;
+   return instanceSet;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: FreeInstanceSet
+//
+// INPUTS: (InstanceSet *instanceSet)
+//
+// RETURN: (void)
+//
+// PURPOSE: Deallocate memory of instance set.  As with instance lists,
+// instances are only freed if no longer referenced.
+//---------------------------------------------------------------------------
+
+void FreeInstanceSet(InstanceSet *instanceSet)
+{
+   InstanceListNode *instanceListNode;
+   InstanceListNode *instanceListNode2;
+   ULONG i;
+
+   if (instanceSet != NULL)
+   {
+      for (i = 0; i < instanceSet->size; i++)
+      {
+         instanceListNode = instanceSet->table[i];
+         while (instanceListNode != NULL)
+         {
+            instanceListNode2 = instanceListNode;
+            instanceListNode = instanceListNode->next;
+            FreeInstanceListNode(instanceListNode2);
+         }
+      }
+      free(instanceSet->table);
+      free(instanceSet);
+   }
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: InstanceHash
+//
+// INPUTS: (Instance *instance)
+//
+// RETURN: (ULONG) - hash of instance
+//
+// PURPOSE: Compute a hash of the instance's vertices and edges arrays,
+// so that instances satisfying InstanceMatch have equal hashes.
+//---------------------------------------------------------------------------
+
+ULONG InstanceHash(Instance *instance)
+{
+   ULONG hash;
+   ULONG i;
+
+   hash = MixCode(instance->numVertices * 31 + instance->numEdges);
+   for (i = 0; i < instance->numVertices; i++)
+      hash = MixCode(hash + instance->vertices[i]);
+   for (i = 0; i < instance->numEdges; i++)
+      hash = MixCode(hash + instance->edges[i]);
+   return hash;
+}
+
+
+//---------------------------------------------------------------------------
+// NAME: InstanceSetInsert
+//
+// INPUTS: (Instance *instance) - instance to insert
+//         (InstanceSet *instanceSet) - set to insert into
+//
+// RETURN: (BOOLEAN) - TRUE if inserted, FALSE if already in set
+//
+// PURPOSE: Insert the instance into the set, unless an instance
+// matching it (according to InstanceMatch) is already there.  This
+// gives the same answer as MemberOfInstanceList on a list of the same
+// instances, but in expected constant time.
+//---------------------------------------------------------------------------
+
+BOOLEAN InstanceSetInsert(Instance *instance, InstanceSet *instanceSet)
+{
+   InstanceListNode *instanceListNode;
+   InstanceListNode *nextNode;
+   InstanceListNode **newTable;
+   ULONG newSize;
+   ULONG i, h;
+
+   h = InstanceHash(instance) % instanceSet->size;
+   instanceListNode = instanceSet->table[h];
+   while (instanceListNode != NULL)
+   {
+      if (InstanceMatch(instance, instanceListNode->instance))
+         return FALSE;
+      instanceListNode = instanceListNode->next;
+   }
+
+   // grow table if average chain too long
+   if (instanceSet->numInstances >= (2 * instanceSet->size))
+   {
+      newSize = 2 * instanceSet->size + 1;
+      newTable =
+         (InstanceListNode **) malloc(sizeof(InstanceListNode *) * newSize);
+      if (newTable == NULL)
+         OutOfMemoryError("InstanceSetInsert:newTable");
+      for (i = 0; i < newSize; i++)
+         newTable[i] = NULL;
+      for (i = 0; i < instanceSet->size; i++)
+      {
+         instanceListNode = instanceSet->table[i];
+         while (instanceListNode != NULL)
+         {
+            nextNode = instanceListNode->next;
+            h = InstanceHash(instanceListNode->instance) % newSize;
+            instanceListNode->next = newTable[h];
+            newTable[h] = instanceListNode;
+            instanceListNode = nextNode;
+         }
+      }
+      free(instanceSet->table);
+      instanceSet->table = newTable;
+      instanceSet->size = newSize;
+      h = InstanceHash(instance) % newSize;
+   }
+
+   instanceListNode = AllocateInstanceListNode(instance);
+   instanceListNode->next = instanceSet->table[h];
+   instanceSet->table[h] = instanceListNode;
+   instanceSet->numInstances++;
+   return TRUE;
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: InstanceMatch
 //
@@ -1073,42 +1474,70 @@ BOOLEAN InstanceListOverlap(Instance *instance, InstanceList *instanceList)
 }
 
 
+//---------------------------------------------------------------------------
+// NAME: MarkedInstanceOverlap
+//
+// INPUTS: (Instance *instance) - instance to check for overlap
+//         (GraphMarks *marks) - marks on graph containing instance
+//
+// RETURN: (BOOLEAN)
+//
+// PURPOSE: Check if any vertex of the given instance is marked.  When
+// the vertices of a set of instances have been marked, this is the
+// same test as InstanceListOverlap, but costs only the instance's size.
+//---------------------------------------------------------------------------
+
+BOOLEAN MarkedInstanceOverlap(Instance *instance, GraphMarks *marks)
+{
+   ULONG v;
+
+   for (v = 0; v < instance->numVertices; v++)
+      if (VERTEX_MARKED(marks, instance->vertices[v]))
+         return TRUE;
+   return FALSE;
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: InstancesOverlap
 //
 // INPUTS: (InstanceList *instanceList)
+//         (Graph *graph) - graph containing instances
+//         (GraphMarks *marks) - scratch marks, reset here
 //
 // RETURN: (BOOLEAN) - TRUE if any pair of instances overlap
 //
 // PURPOSE: Check if any two instances in the given list overlap.  If
-// so, return TRUE, else return FALSE.
+// so, return TRUE, else return FALSE.  Each instance's vertices are
+// marked in turn, so an overlap is found as soon as an instance
+// contains an already marked vertex.
 //---------------------------------------------------------------------------
 
-BOOLEAN InstancesOverlap(InstanceList *instanceList)
+BOOLEAN InstancesOverlap(InstanceList *instanceList, Graph *graph,
+                         GraphMarks *marks)
 {
-   InstanceListNode *instanceListNode1;
-   InstanceListNode *instanceListNode2;
-   BOOLEAN overlap = FALSE;
+   InstanceListNode *instanceListNode;
+   Instance *instance;
+   ULONG v;
 
    if (instanceList != NULL) 
    {
-      instanceListNode1 = instanceList->head;
-      while ((instanceListNode1 != NULL) && (! overlap)) 
+      ResetGraphMarks(marks, graph);
+      instanceListNode = instanceList->head;
+      while (instanceListNode != NULL) 
       {
-         instanceListNode2 = instanceListNode1->next;
-         while ((instanceListNode2 != NULL) && (! overlap)) 
-         {
-            if ((instanceListNode1->instance != NULL) &&
-                (instanceListNode2->instance != NULL) &&
-                (InstanceOverlap(instanceListNode1->instance,
-               instanceListNode2->instance)))
-            overlap = TRUE;
-            instanceListNode2 = instanceListNode2->next;
-         }
-         instanceListNode1 = instanceListNode1->next;
+         instance = instanceListNode->instance;
+         if (instance != NULL)
+            for (v = 0; v < instance->numVertices; v++)
+            {
+               if (VERTEX_MARKED(marks, instance->vertices[v]))
+                  return TRUE;
+               MARK_VERTEX(marks, instance->vertices[v], TRUE);
+            }
+         instanceListNode = instanceListNode->next;
       }
    }
-   return overlap;
+   return FALSE;
 }
 
 
@@ -1179,7 +1608,7 @@ Graph *InstanceToGraph(Instance *instance, Graph *graph)
       vertex = & newGraph->vertices[v1];
       vertex->numEdges++;
       vertex->edges =
-         (ULONG *) realloc(vertex->edges, sizeof(ULONG) * vertex->numEdges);
+         (INDEX *) realloc(vertex->edges, sizeof(INDEX) * vertex->numEdges);
       if (vertex->edges == NULL)
          OutOfMemoryError("InstanceToGraph:vertex1->edges");
       vertex->edges[vertex->numEdges - 1] = i;
@@ -1188,7 +1617,7 @@ Graph *InstanceToGraph(Instance *instance, Graph *graph)
          vertex = & newGraph->vertices[v2];
          vertex->numEdges++;
          vertex->edges =
-            (ULONG *) realloc(vertex->edges, sizeof(ULONG) * vertex->numEdges);
+            (INDEX *) realloc(vertex->edges, sizeof(INDEX) * vertex->numEdges);
          if (vertex->edges == NULL)
             OutOfMemoryError("InstanceToGraph:vertex2->edges");
          vertex->edges[vertex->numEdges - 1] = i;
@@ -1253,7 +1682,7 @@ void AddInstanceToInstance(Instance *instance1, Instance *instance2)
       {
          // vertex not in instance2, so make room
          instance2->vertices =
-            (ULONG *) realloc(instance2->vertices, (sizeof(ULONG) * (nv2 + 1)));
+            (INDEX *) realloc(instance2->vertices, (sizeof(INDEX) * (nv2 + 1)));
          if (instance2->vertices == NULL)
             OutOfMemoryError("AddInstanceToInstance:instance2->vertices");
          for (i = nv2; i > v2; i--)
@@ -1273,7 +1702,7 @@ void AddInstanceToInstance(Instance *instance1, Instance *instance2)
       {
          // edge not in instance2, so make room
          instance2->edges =
-            (ULONG *) realloc(instance2->edges, (sizeof(ULONG) * (ne2 + 1)));
+            (INDEX *) realloc(instance2->edges, (sizeof(INDEX) * (ne2 + 1)));
          if (instance2->edges == NULL)
             OutOfMemoryError("AddInstanceToInstance:instance2->edges");
          for (i = ne2; i > e2; i--)
@@ -1433,7 +1862,8 @@ BOOLEAN NewEdgeMatch(Graph *g1, Instance *inst1, Graph *g2,
    if (subMapping == NULL)
       OutOfMemoryError("NewEdgeMatch: subMapping");
    
-   if (GraphMatch(g1, g2, labelList, threshold, NULL, subMapping))
+   if (GraphMatch(g1, g2, labelList, threshold, parameters->matchMethod,
+                  NULL, subMapping))
    {
       // Declare some variables that were not needed until now
       ULONG value;
@@ -31,7 +31,7 @@
 void Test(char *subsFileName, char *graphFileName, Parameters *parameters,
           ULONG *TPp, ULONG *TNp, ULONG *FPp, ULONG *FNp)
 {
-   FILE *graphFile;
+   GraphFile *graphFile;
    LabelList *labelList;
    BOOLEAN directed;
    Graph **subGraphs;
@@ -40,8 +40,6 @@ void Test(char *subsFileName, char *graphFileName, Parameters *parameters,
    BOOLEAN positive1;
    BOOLEAN positive2;
    ULONG vertexOffset = 0;
-   ULONG lineNo = 1;
-   char token[TOKEN_LEN];
    ULONG FP = 0;
    ULONG FN = 0;
    ULONG TP = 0;
@@ -58,7 +56,7 @@ void Test(char *subsFileName, char *graphFileName, Parameters *parameters,
            numSubGraphs, subsFileName);
 
    // open example graphs file and compute stats
-   graphFile = fopen(graphFileName, "r");
+   graphFile = OpenGraphFile(graphFileName);
    if (graphFile == NULL) 
    {
       fprintf(stderr, "Unable to open graph file %s.\n", graphFileName);
@@ -67,13 +65,14 @@ void Test(char *subsFileName, char *graphFileName, Parameters *parameters,
 
    graph = NULL;
    positive1 = TRUE;
-   while (ReadToken(token, graphFile, &lineNo) != 0) 
+   while (ScanToken(graphFile) != 0) 
    {
-      if (strcmp(token, POS_EG_TOKEN) == 0) 
+      if (TokenEquals(graphFile, POS_EG_TOKEN)) 
       { // reading positive eg
          if (graph != NULL) 
          {
             // test last graph
+            BuildVertexEdges(graph);
             positive2 = PositiveExample(graph, subGraphs, numSubGraphs,
                                         parameters);
             // increment appropriate counter
@@ -86,11 +85,12 @@ void Test(char *subsFileName, char *graphFileName, Parameters *parameters,
          graph = AllocateGraph(0,0);
          positive1 = TRUE;
       }
-      else if (strcmp(token, NEG_EG_TOKEN) == 0) 
+      else if (TokenEquals(graphFile, NEG_EG_TOKEN)) 
       { // reading negative eg
          if (graph != NULL) 
          {
             // test last graph
+            BuildVertexEdges(graph);
             positive2 = PositiveExample(graph, subGraphs, numSubGraphs,
                                         parameters);
             // increment appropriate counter
@@ -103,35 +103,36 @@ void Test(char *subsFileName, char *graphFileName, Parameters *parameters,
          graph = AllocateGraph(0,0);
          positive1 = FALSE;
       }
-      else if (strcmp(token, "v") == 0) 
+      else if (TokenEquals(graphFile, "v")) 
       {  // read vertex
          if (positive1 && (graph == NULL)) 
          {
             // first graph starts without positive token, so assumed positive
             graph = AllocateGraph(0,0);
          }
-         ReadVertex(graph, graphFile, labelList, &lineNo, vertexOffset);
+         ScanVertex(graphFile, graph, labelList, vertexOffset);
       }
-      else if (strcmp(token, "e") == 0)    // read 'e' edge
-         ReadEdge(graph, graphFile, labelList, &lineNo, directed, vertexOffset);
+      else if (TokenEquals(graphFile, "e"))    // read 'e' edge
+         ScanEdge(graphFile, graph, labelList, directed, vertexOffset);
 
-      else if (strcmp(token, "u") == 0)    // read undirected edge
-         ReadEdge(graph, graphFile, labelList, &lineNo, FALSE, vertexOffset);
+      else if (TokenEquals(graphFile, "u"))    // read undirected edge
+         ScanEdge(graphFile, graph, labelList, FALSE, vertexOffset);
 
-      else if (strcmp(token, "d") == 0)    // read directed edge
-         ReadEdge(graph, graphFile, labelList, &lineNo, TRUE, vertexOffset);
+      else if (TokenEquals(graphFile, "d"))    // read directed edge
+         ScanEdge(graphFile, graph, labelList, TRUE, vertexOffset);
 
       else 
       {
-         fclose(graphFile);
          fprintf(stderr, "Unknown token %s in line %lu of input file %s.\n",
-                 token, lineNo, graphFileName);
+                 TokenString(graphFile), graphFile->lineNo, graphFileName);
+         CloseGraphFile(graphFile);
          exit(1);
       }
    }
    // test last graph
    if (graph != NULL) 
    {
+      BuildVertexEdges(graph);
       positive2 = PositiveExample(graph, subGraphs, numSubGraphs,
                                   parameters);
       // increment appropriate counter
@@ -142,7 +143,7 @@ void Test(char *subsFileName, char *graphFileName, Parameters *parameters,
       FreeGraph(graph);
    }
 
-   fclose(graphFile);
+   CloseGraphFile(graphFile);
 
    // free substructure graphs
    for (i = 0; i < numSubGraphs; i++)
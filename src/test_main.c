@@ -106,6 +106,8 @@ Parameters *GetParameters(int argc, char *argv[])
    // initialize default parameter settings
    parameters->directed = TRUE;
    parameters->labelList = AllocateLabelList();
+   AllocateParameterMarks(parameters);
+   parameters->matchMethod = MATCH_SEARCH;
 
    return parameters;
 }
@@ -124,5 +126,6 @@ Parameters *GetParameters(int argc, char *argv[])
 void FreeParameters(Parameters *parameters)
 {
    FreeLabelList(parameters->labelList);
+   FreeParameterMarks(parameters);
    free(parameters);
 }
@@ -26,6 +26,32 @@ void OutOfMemoryError(char *context)
 }
 
 
+//---------------------------------------------------------------------------
+// NAME: CheckIndex
+//
+// INPUTS: (ULONG index) - index about to be stored
+//         (char *context) - kind of index, e.g. "vertex"
+//
+// RETURN: (void)
+//
+// PURPOSE: Exit with an error if the given vertex, edge or label index
+// cannot be stored in an INDEX.  The top two values are reserved for
+// VERTEX_UNMAPPED and VERTEX_DELETED.  This can only happen when
+// compiled with -DINDEX32.
+//---------------------------------------------------------------------------
+
+void CheckIndex(ULONG index, char *context)
+{
+   if (index >= VERTEX_DELETED)
+   {
+      fprintf(stderr, "ERROR: too many %ss for %lu-bit indices; ", context,
+              (ULONG) (sizeof(INDEX) * 8));
+      fprintf(stderr, "rebuild without -DINDEX32.\n");
+      exit(1);
+   }
+}
+
+
 //---------------------------------------------------------------------------
 // NAME: PrintBoolean
 //